@@ -4,6 +4,15 @@ in vec2 TexCoord;
 
 uniform sampler2D ourTexture;
 
+// Indexed frames hold the palette index of each pixel in the red channel
+uniform sampler2D palette;
+uniform bool indexed;
+
 void main() {
-   FragColor = texture(ourTexture, TexCoord);
+   if (indexed) {
+      int index = int(texture(ourTexture, TexCoord).r * 255.0 + 0.5);
+      FragColor = texelFetch(palette, ivec2(index, 0), 0);
+   } else {
+      FragColor = texture(ourTexture, TexCoord);
+   }
 }
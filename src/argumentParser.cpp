@@ -31,6 +31,49 @@ AppOptions parseArguments(int argc, char *argv[]) {
         .default_value(false)
         .help("show the top and bottom 8 pixels of the NES screen");
 
+    argParser.add_argument("--dynarec-diff")
+        .implicit_value(true)
+        .default_value(false)
+        .help("run the interpreter in lockstep with the dynarec and report the first divergence");
+
+    argParser.add_argument("--audio-latency")
+        .default_value(40)
+        .action([](const std::string& value) { return std::stoi(value); })
+        .help("audio latency in milliseconds");
+
+    argParser.add_argument("--audio-buffer")
+        .default_value(512)
+        .action([](const std::string& value) { return std::stoi(value); })
+        .help("audio device buffer size in samples");
+
+    argParser.add_argument("--audio-sync")
+        .implicit_value(true)
+        .default_value(false)
+        .help("pace the emulation with the audio device instead of the frame limiter");
+
+    argParser.add_argument("--rewind-memory")
+        .default_value(4)
+        .action([](const std::string& value) { return std::stoi(value); })
+        .help("memory used by the rewind buffer in megabytes, 0 disable rewind");
+
+    argParser.add_argument("--run-ahead")
+        .default_value(0)
+        .action([](const std::string& value) { return std::stoi(value); })
+        .help("number of frames emulated ahead of the shown one to reduce the input lag, 0 disable run-ahead");
+
+    argParser.add_argument("--run-ahead-instance")
+        .implicit_value(true)
+        .default_value(false)
+        .help("run the frames ahead on a second emulator instance to keep the audio continuous");
+
+    argParser.add_argument("--record")
+        .default_value(std::string(""))
+        .help("record the inputs from power on in a FM2 movie file");
+
+    argParser.add_argument("--play")
+        .default_value(std::string(""))
+        .help("play the inputs of a FM2 movie file and report the desyncs");
+
     // Attempt to parse the arguments
     int parseStatus;
     try {
@@ -52,6 +95,15 @@ AppOptions parseArguments(int argc, char *argv[]) {
     outputOptions.windowed = argParser.get<bool>("windowed");
     outputOptions.hideDangerZone = !argParser.get<bool>("show-overscan");
     outputOptions.useVsync = !argParser.get<bool>("no-vsync");
+    outputOptions.dynarecDiff = argParser.get<bool>("dynarec-diff");
+    outputOptions.audioLatency = argParser.get<int>("audio-latency");
+    outputOptions.audioBufferSamples = argParser.get<int>("audio-buffer");
+    outputOptions.audioSync = argParser.get<bool>("audio-sync");
+    outputOptions.rewindMemory = argParser.get<int>("rewind-memory");
+    outputOptions.runAhead = argParser.get<int>("run-ahead");
+    outputOptions.runAheadInstance = argParser.get<bool>("run-ahead-instance");
+    outputOptions.recordPath = argParser.get("record");
+    outputOptions.playPath = argParser.get("play");
 
     return outputOptions;
 }
@@ -18,6 +18,28 @@ struct AppOptions {
     bool hideDangerZone;
     // Use vsync
     bool useVsync;
+    // Run the interpreter in lockstep with the dynarec
+    bool dynarecDiff;
+
+    // Audio latency targeted by the ring buffer in milliseconds
+    // and size of the audio device buffer in samples
+    int audioLatency;
+    int audioBufferSamples;
+    // Pace the emulation with the audio device clock
+    bool audioSync;
+
+    // Memory used by the rewind buffer in megabytes, 0 disable rewind
+    int rewindMemory;
+
+    // Frames emulated ahead of the shown one, 0 disable run-ahead
+    int runAhead;
+    // Run the frames ahead on a second emulator instance
+    bool runAheadInstance;
+
+    // Input movie recorded from the gamepad or played instead of it,
+    // empty when not used
+    std::string recordPath;
+    std::string playPath;
 };
 
 AppOptions parseArguments(int argc, char *argv[]);
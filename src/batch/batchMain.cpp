@@ -0,0 +1,299 @@
+#include "nesPch.h"
+
+#include <argparse/argparse.hpp>
+
+#include <map>
+#include <thread>
+#include <vector>
+
+#include "nesCore/nesEmulator.h"
+#include "nesCore/inputOutput/scriptedIO.h"
+#include "nesCore/utility/utilityFunctions.h"
+
+#include "workStealingPool.h"
+
+// Batch runner
+//
+// Run many ROM and input script combinations on a pool of threads, one
+// emulator instance per task, and write the results in a JSON report.
+// Each line of the jobs file hold the number of frames, the ROM path and
+// an optional input script path, lines starting with '#' are ignored
+
+struct Job {
+    uint64_t frames;
+    std::string romPath;
+    std::string scriptPath;
+};
+
+struct JobResult {
+    // Empty on success
+    std::string error;
+
+    uint64_t frames;
+    uint64_t cpuCycles;
+    uint64_t frameHash;
+    uint8_t ram[2048];
+
+    double seconds;
+    size_t worker;
+};
+
+// Read the jobs file, return false on a malformed line
+static bool readJobs(const std::string& filename, std::vector<Job>& jobs) {
+    std::ifstream file(filename);
+    if (!file.good())
+        return false;
+
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#')
+            continue;
+
+        std::stringstream s(line);
+        Job job;
+        if (!(s >> job.frames >> job.romPath))
+            return false;
+        s >> job.scriptPath;
+
+        jobs.push_back(job);
+    }
+
+    return true;
+}
+
+// Escape a string for a JSON document
+static std::string jsonString(const std::string& value) {
+    std::stringstream s;
+    s << '"';
+
+    for (char c : value) {
+        if (c == '"' || c == '\\')
+            s << '\\' << c;
+        else if (static_cast<uint8_t>(c) < 0x20)
+            s << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(c) << std::dec;
+        else
+            s << c;
+    }
+
+    s << '"';
+    return s.str();
+}
+
+// Run a job on a new emulator instance
+static void runJob(
+    const Job& job,
+    const std::vector<uint8_t>& rom,
+    const nesCore::ScriptedIO* p_script,
+    const std::vector<uint8_t>& palette,
+    size_t worker,
+    JobResult& result
+) {
+    auto startTime = std::chrono::steady_clock::now();
+
+    result.frames = 0;
+    result.cpuCycles = 0;
+    result.frameHash = 0;
+    result.worker = worker;
+    std::fill(result.ram, result.ram + sizeof(result.ram), 0x00);
+
+    // The instance is created by the worker and never leaves it
+    nesCore::NesEmulator* p_emulator = new nesCore::NesEmulator();
+    nesCore::ScriptedIO io = p_script != nullptr ? *p_script : nesCore::ScriptedIO();
+
+    p_emulator->getFrameBuffer()->setPalette(palette.data(), palette.size());
+    p_emulator->attachIO(&io);
+
+    if (p_emulator->loadCartridgeFromMemory(rom.data(), rom.size()) != 0) {
+        result.error = "failed to load the cartridge";
+    } else {
+        io.setFrame(0);
+
+        while (result.frames < job.frames && result.error.empty()) {
+            if (nesCore::utility::runFrameOrHalt(*p_emulator))
+                io.setFrame(++result.frames);
+            else
+                result.error = "the CPU halted";
+        }
+
+        result.frameHash = nesCore::utility::hashBytes(
+            p_emulator->getFrameBuffer()->data(),
+            nesCore::SCREEN_WIDTH * nesCore::SCREEN_HEIGHT * 3
+        );
+        result.cpuCycles = p_emulator->cpuDebugInfo().cpuCycle;
+        std::copy(p_emulator->getRam(), p_emulator->getRam() + sizeof(result.ram), result.ram);
+    }
+
+    delete p_emulator;
+
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+// Write the results of the jobs and the totals
+static void writeReport(
+    std::ostream& out,
+    const std::vector<Job>& jobs,
+    const std::vector<JobResult>& results,
+    size_t threads,
+    double seconds
+) {
+    uint64_t totalFrames = 0;
+    size_t failed = 0;
+    for (const JobResult& result : results) {
+        totalFrames += result.frames;
+        failed += result.error.empty() ? 0 : 1;
+    }
+
+    out << std::fixed << std::setprecision(6);
+    out << "{\n";
+    out << "  \"threads\": " << threads << ",\n";
+    out << "  \"jobs\": " << jobs.size() << ",\n";
+    out << "  \"failed\": " << failed << ",\n";
+    out << "  \"seconds\": " << seconds << ",\n";
+    out << "  \"frames\": " << totalFrames << ",\n";
+    out << "  \"fps\": " << (seconds > 0.0 ? totalFrames / seconds : 0.0) << ",\n";
+    out << "  \"results\": [\n";
+
+    for (size_t i = 0; i < jobs.size(); i++) {
+        const Job& job = jobs[i];
+        const JobResult& result = results[i];
+
+        out << "    {\n";
+        out << "      \"rom\": " << jsonString(job.romPath) << ",\n";
+        out << "      \"input\": " << jsonString(job.scriptPath) << ",\n";
+        out << "      \"error\": " << jsonString(result.error) << ",\n";
+        out << "      \"frames\": " << result.frames << ",\n";
+        out << "      \"cpuCycles\": " << result.cpuCycles << ",\n";
+        out << "      \"frameHash\": \"" << std::hex << std::setw(16) << std::setfill('0');
+        out << result.frameHash << std::dec << std::setfill(' ') << "\",\n";
+
+        out << "      \"ram\": \"" << std::hex << std::setfill('0');
+        for (uint8_t byte : result.ram)
+            out << std::setw(2) << static_cast<int>(byte);
+        out << std::dec << std::setfill(' ') << "\",\n";
+
+        out << "      \"seconds\": " << result.seconds << ",\n";
+        out << "      \"fps\": " << (result.seconds > 0.0 ? result.frames / result.seconds : 0.0) << ",\n";
+        out << "      \"worker\": " << result.worker << "\n";
+        out << "    }" << (i + 1 < jobs.size() ? "," : "") << "\n";
+    }
+
+    out << "  ]\n";
+    out << "}\n";
+}
+
+int main(int argc, char *argv[]) {
+    // Parse commands line arguments
+    argparse::ArgumentParser argParser("nes_batch");
+
+    argParser.add_argument("jobs")
+        .help("jobs file, each line hold the frames, the ROM path and an optional input script");
+
+    argParser.add_argument("-p", "--palettes")
+        .default_value(std::string("resources/palettes/2C02G.pal"))
+        .help("specify the color palettes file");
+
+    argParser.add_argument("-t", "--threads")
+        .default_value(static_cast<int>(std::thread::hardware_concurrency()))
+        .action([](const std::string& value) { return std::stoi(value); })
+        .help("number of worker threads");
+
+    argParser.add_argument("-o", "--report")
+        .default_value(std::string("batch_report.json"))
+        .help("JSON report file");
+
+    argParser.add_argument("-v", "--verbose")
+        .implicit_value(true)
+        .default_value(false)
+        .help("keep the emulator messages");
+
+    try {
+        argParser.parse_args(argc, argv);
+    }
+    catch (const std::runtime_error& err) {
+        std::cerr << err.what() << std::endl;
+        std::cerr << argParser;
+        return 1;
+    }
+
+    std::vector<Job> jobs;
+    if (!readJobs(argParser.get("jobs"), jobs)) {
+        std::cerr << "Failed to read the jobs file" << std::endl;
+        return 2;
+    }
+
+    std::vector<uint8_t> palette;
+    if (!nesCore::utility::readFile(argParser.get("palettes"), palette)) {
+        std::cerr << "Failed to load color palette" << std::endl;
+        return 2;
+    }
+
+    // The ROMs and the scripts are loaded once and shared by the jobs
+    std::map<std::string, std::vector<uint8_t>> roms;
+    std::map<std::string, nesCore::ScriptedIO> scripts;
+
+    for (const Job& job : jobs) {
+        if (roms.count(job.romPath) == 0 && !nesCore::utility::readFile(job.romPath, roms[job.romPath])) {
+            std::cerr << "Failed to read the ROM " << job.romPath << std::endl;
+            return 2;
+        }
+
+        if (!job.scriptPath.empty() && scripts.count(job.scriptPath) == 0) {
+            int scriptError = scripts[job.scriptPath].loadScript(job.scriptPath);
+            if (scriptError != 0) {
+                std::cerr << "Failed to load the input script " << job.scriptPath;
+                std::cerr << ", error code: " << scriptError << std::endl;
+                return 2;
+            }
+        }
+    }
+
+    // The emulator messages of hundreds of instances are only noise
+    std::streambuf* p_coutBuffer = std::cout.rdbuf();
+    if (!argParser.get<bool>("verbose"))
+        std::cout.rdbuf(nullptr);
+
+    std::vector<JobResult> results(jobs.size());
+    size_t threads = static_cast<size_t>(std::max(argParser.get<int>("threads"), 1));
+
+    auto startTime = std::chrono::steady_clock::now();
+    {
+        batch::WorkStealingPool pool(threads);
+
+        for (size_t i = 0; i < jobs.size(); i++) {
+            const Job& job = jobs[i];
+            const nesCore::ScriptedIO* p_script = job.scriptPath.empty() ? nullptr : &scripts[job.scriptPath];
+            const std::vector<uint8_t>* p_rom = &roms[job.romPath];
+
+            pool.submit([&, i, p_script, p_rom](size_t worker) {
+                runJob(jobs[i], *p_rom, p_script, palette, worker, results[i]);
+            });
+        }
+
+        pool.wait();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+    std::cout.clear();
+    std::cout.rdbuf(p_coutBuffer);
+
+    std::ofstream report(argParser.get("report"));
+    writeReport(report, jobs, results, threads, seconds);
+    if (!report.good()) {
+        std::cerr << "Failed to write the report" << std::endl;
+        return 3;
+    }
+
+    // Summary
+    uint64_t totalFrames = 0;
+    size_t failed = 0;
+    for (const JobResult& result : results) {
+        totalFrames += result.frames;
+        failed += result.error.empty() ? 0 : 1;
+    }
+
+    std::cout << jobs.size() << " jobs (" << failed << " failed), " << totalFrames << " frames on ";
+    std::cout << threads << " threads in " << std::fixed << std::setprecision(3) << seconds << " s, ";
+    std::cout << std::setprecision(1) << (seconds > 0.0 ? totalFrames / seconds : 0.0) << " fps" << std::endl;
+
+    return 0;
+}
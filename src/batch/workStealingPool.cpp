@@ -0,0 +1,114 @@
+#include "nesPch.h"
+
+#include "workStealingPool.h"
+
+namespace batch {
+// Start the workers
+WorkStealingPool::WorkStealingPool(size_t threadCount) :
+    m_nextQueue(0), m_queued(0), m_pending(0), m_stop(false)
+{
+    threadCount = std::max<size_t>(threadCount, 1);
+
+    for (size_t i = 0; i < threadCount; i++)
+        m_queues.push_back(new Queue());
+
+    for (size_t i = 0; i < threadCount; i++)
+        m_threads.emplace_back(&WorkStealingPool::workerLoop, this, i);
+}
+// Finish the queued tasks and stop the workers
+WorkStealingPool::~WorkStealingPool() {
+    this->wait();
+
+    {
+        std::lock_guard<std::mutex> lock(m_stateMutex);
+        m_stop = true;
+    }
+    m_taskCondition.notify_all();
+
+    for (std::thread& thread : m_threads)
+        thread.join();
+
+    for (Queue* p_queue : m_queues)
+        delete p_queue;
+}
+
+// Queue a task round robin
+void WorkStealingPool::submit(Task task) {
+    Queue* p_queue = m_queues[m_nextQueue];
+    m_nextQueue = (m_nextQueue + 1) % m_queues.size();
+
+    // Count the task before publishing it, a worker
+    // can take and finish it as soon as it's queued
+    {
+        std::lock_guard<std::mutex> lock(m_stateMutex);
+        m_queued++;
+        m_pending++;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(p_queue->mutex);
+        p_queue->tasks.push_back(std::move(task));
+    }
+    m_taskCondition.notify_one();
+}
+
+// Wait until all the queued tasks are finished
+void WorkStealingPool::wait() {
+    std::unique_lock<std::mutex> lock(m_stateMutex);
+    m_doneCondition.wait(lock, [this] { return m_pending == 0; });
+}
+
+size_t WorkStealingPool::threadCount() {
+    return m_threads.size();
+}
+
+// Run the tasks until the pool is stopped
+void WorkStealingPool::workerLoop(size_t worker) {
+    Task task;
+
+    while (true) {
+        if (this->takeTask(worker, task)) {
+            task(worker);
+            task = nullptr;
+
+            std::lock_guard<std::mutex> lock(m_stateMutex);
+            if (--m_pending == 0)
+                m_doneCondition.notify_all();
+
+            continue;
+        }
+
+        // Sleep until a task is queued, another worker may take it first
+        std::unique_lock<std::mutex> lock(m_stateMutex);
+        m_taskCondition.wait(lock, [this] { return m_stop || m_queued != 0; });
+
+        if (m_stop && m_queued == 0)
+            return;
+    }
+}
+
+// Take the newest task of the worker queue or steal the oldest of another one
+bool WorkStealingPool::takeTask(size_t worker, Task& task) {
+    for (size_t i = 0; i < m_queues.size(); i++) {
+        Queue* p_queue = m_queues[(worker + i) % m_queues.size()];
+        std::lock_guard<std::mutex> lock(p_queue->mutex);
+
+        if (p_queue->tasks.empty())
+            continue;
+
+        if (i == 0) {
+            task = std::move(p_queue->tasks.back());
+            p_queue->tasks.pop_back();
+        } else {
+            task = std::move(p_queue->tasks.front());
+            p_queue->tasks.pop_front();
+        }
+
+        std::lock_guard<std::mutex> stateLock(m_stateMutex);
+        m_queued--;
+        return true;
+    }
+
+    return false;
+}
+}
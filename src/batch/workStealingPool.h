@@ -0,0 +1,70 @@
+#ifndef WORK_STEALING_POOL_H_
+#define WORK_STEALING_POOL_H_
+
+#include "nesPch.h"
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace batch {
+// Thread pool with one task queue per worker
+//
+// The tasks are queued round robin, a worker run the newest task of its
+// own queue and steal the oldest task of the other queues when its queue
+// is empty, so long tasks don't leave the other workers idle
+class WorkStealingPool {
+public:
+    // A task receive the index of the worker running it,
+    // used to reuse per worker buffers
+    typedef std::function<void(size_t worker)> Task;
+
+    // Start the given number of workers, at least one
+    explicit WorkStealingPool(size_t threadCount);
+    // Finish the queued tasks and stop the workers
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    // Queue a task
+    void submit(Task task);
+    // Wait until all the queued tasks are finished
+    void wait();
+
+    size_t threadCount();
+
+// Private methods
+private:
+    void workerLoop(size_t worker);
+    // Take a task from the worker queue or steal one, return false if none is left
+    bool takeTask(size_t worker, Task& task);
+
+// Private types
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+// Private member variables
+private:
+    std::vector<std::thread> m_threads;
+    std::vector<Queue*> m_queues;
+    size_t m_nextQueue;
+
+    // Number of tasks queued and not finished, the workers sleep
+    // while no task is queued
+    std::mutex m_stateMutex;
+    std::condition_variable m_taskCondition;
+    std::condition_variable m_doneCondition;
+    size_t m_queued;
+    size_t m_pending;
+    bool m_stop;
+};
+}
+
+#endif
@@ -0,0 +1,149 @@
+#include "nesPch.h"
+
+#include "nesCore/cpuBus.h"
+#include "nesCore/apu/apu.h"
+#include "nesCore/apu/audioSink.h"
+
+// APU synthesis cost benchmark
+//
+// Run the APU alone with the register writes of typical and worst case
+// workloads, advanced in instruction sized steps like the emulator does,
+// and report the host time spent for each emulated second
+
+// CPU cycles in one NTSC frame
+#define BENCH_FRAME_CYCLES 29781
+
+// Audio sink counting the received samples
+class CountingSink : public nesCore::AudioSink {
+public:
+    void pushSamples(const int16_t* samples, size_t count) override {
+        m_count += count;
+        m_checksum += samples[count - 1];
+    }
+
+    uint64_t m_count = 0;
+    int64_t m_checksum = 0;
+};
+
+struct Workload {
+    const char* name;
+    // Register writes executed at the start of every frame
+    void (*frame)(nesCore::APU& apu, int frame);
+};
+
+// Only the frame counter is running
+static void silentFrame(nesCore::APU& apu, int frame) {
+    if (frame == 0)
+        apu.writeRegister(0x4015, 0x00);
+}
+
+// Two pulses, triangle and noise playing notes with envelopes
+static void musicFrame(nesCore::APU& apu, int frame) {
+    if (frame == 0) {
+        apu.writeRegister(0x4015, 0x0F);
+        apu.writeRegister(0x4017, 0x40);
+    }
+
+    if (frame % 8 != 0)
+        return;
+
+    uint16_t note = 0x0FD + (frame / 8 % 12) * 16;
+
+    apu.writeRegister(0x4000, 0x9F);
+    apu.writeRegister(0x4001, 0x00);
+    apu.writeRegister(0x4002, note & 0xFF);
+    apu.writeRegister(0x4003, 0x08 | (note >> 8));
+
+    apu.writeRegister(0x4004, 0x54);
+    apu.writeRegister(0x4005, 0x00);
+    apu.writeRegister(0x4006, (note >> 1) & 0xFF);
+    apu.writeRegister(0x4007, 0x08 | (note >> 9));
+
+    apu.writeRegister(0x4008, 0x81);
+    apu.writeRegister(0x400A, (note << 1) & 0xFF);
+    apu.writeRegister(0x400B, 0x08 | ((note >> 7) & 0x07));
+
+    apu.writeRegister(0x400C, 0x04);
+    apu.writeRegister(0x400E, frame / 8 % 16);
+    apu.writeRegister(0x400F, 0x08);
+}
+
+// Every channel at its highest audible rate, the DMC loop a sample
+static void worstFrame(nesCore::APU& apu, int frame) {
+    if (frame != 0)
+        return;
+
+    apu.writeRegister(0x4017, 0x40);
+
+    apu.writeRegister(0x4000, 0xBF);
+    apu.writeRegister(0x4002, 0x08);
+    apu.writeRegister(0x4003, 0x00);
+    apu.writeRegister(0x4004, 0xBF);
+    apu.writeRegister(0x4006, 0x09);
+    apu.writeRegister(0x4007, 0x00);
+
+    apu.writeRegister(0x4008, 0xFF);
+    apu.writeRegister(0x400A, 0x02);
+    apu.writeRegister(0x400B, 0x00);
+
+    apu.writeRegister(0x400C, 0x3F);
+    apu.writeRegister(0x400E, 0x00);
+    apu.writeRegister(0x400F, 0x00);
+
+    apu.writeRegister(0x4010, 0x4F);
+    apu.writeRegister(0x4012, 0x00);
+    apu.writeRegister(0x4013, 0xFF);
+
+    apu.writeRegister(0x4015, 0x1F);
+}
+
+int main(int argc, char *argv[]) {
+    // Emulated seconds for each workload
+    int seconds = argc > 1 ? std::atoi(argv[1]) : 60;
+    uint32_t sampleRate = argc > 2 ? std::atoi(argv[2]) : 48000;
+
+    const Workload workloads[] = {
+        {"silent", silentFrame},
+        {"music", musicFrame},
+        {"worst case", worstFrame},
+    };
+
+    std::cout << "APU benchmark, " << seconds << " emulated seconds at ";
+    std::cout << sampleRate << " Hz" << std::endl;
+
+    for (const Workload& workload : workloads) {
+        // The bus own the APU and provide the DMC memory
+        nesCore::Bus* bus = new nesCore::Bus();
+        nesCore::APU& apu = bus->m_apu;
+
+        CountingSink sink;
+        apu.setSampleRate(sampleRate);
+        apu.attachAudioSink(&sink);
+
+        int frames = seconds * APU_CPU_CLOCK_RATE / BENCH_FRAME_CYCLES;
+        auto start = std::chrono::steady_clock::now();
+
+        for (int frame = 0; frame < frames; frame++) {
+            workload.frame(apu, frame);
+
+            // Advance the APU by instruction sized steps
+            for (int cycles = 0; cycles < BENCH_FRAME_CYCLES; cycles += 3)
+                apu.run(3);
+        }
+        apu.sync();
+
+        auto end = std::chrono::steady_clock::now();
+        double elapsed = std::chrono::duration<double>(end - start).count();
+        double emulated = static_cast<double>(frames) * BENCH_FRAME_CYCLES / APU_CPU_CLOCK_RATE;
+
+        std::cout << std::left << std::setw(12) << workload.name;
+        std::cout << std::fixed << std::setprecision(3);
+        std::cout << elapsed * 1000.0 / emulated << " ms per emulated second, ";
+        std::cout << sink.m_count / emulated << " samples per second";
+        std::cout << " (checksum " << sink.m_checksum << ")" << std::endl;
+
+        delete bus;
+    }
+
+    return 0;
+}
@@ -0,0 +1,649 @@
+#include "nesPch.h"
+
+#include <argparse/argparse.hpp>
+
+#include <functional>
+#include <map>
+#include <vector>
+
+#include "nesCore/nesEmulator.h"
+#include "nesCore/cpuBus.h"
+#include "nesCore/ppuBus.h"
+#include "nesCore/frameBuffer.h"
+#include "nesCore/cartridge/cartridge.h"
+#include "nesCore/inputOutput/dummyIO.h"
+#include "nesCore/utility/utilityFunctions.h"
+
+// Emulator core benchmark suite
+//
+// The micro benchmarks time the bus accesses, the CPU instruction families,
+// the PPU clock, the frame buffer and the cartridge loading on synthetic
+// ROMs built in memory. The macro benchmarks run a synthetic homebrew like
+// ROM and the given ROM files for a fixed number of frames. The results are
+// written as CSV with the build configuration and compared to the CSV of
+// another build, the macro checksums are the hash of the last frame and
+// must be the same on every build
+
+// CPU cycles in one NTSC frame
+#define BENCH_FRAME_CYCLES 29781
+// Repetitions of the instruction block of a CPU benchmark, the loop
+// is long enough to never be skipped as an idle loop
+#define BENCH_CPU_BLOCK_REPEAT 32
+
+// Result of a benchmark
+struct BenchResult {
+    std::string name;
+    std::string group;
+    uint64_t iterations;
+    double nsPerOp;
+    uint64_t checksum;
+};
+
+struct Benchmark {
+    std::string name;
+    std::string group;
+    // Unit of an operation, shown with the results
+    std::string unit;
+    // Run the given number of operations after the setup, return the
+    // elapsed seconds of the operations and accumulate in the checksum
+    std::function<double(uint64_t iterations, uint64_t& checksum)> run;
+    // Fixed number of operations, 0 run as many as fit in the minimum time
+    uint64_t fixedIterations;
+};
+
+// Return the elapsed seconds since the given time
+static double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Return the emulator options of this build
+static std::string buildName() {
+    std::string name;
+
+#if defined(NES_CPU_DISPATCH_SWITCH)
+    name = "switch";
+#elif defined(NES_CPU_DISPATCH_TABLE)
+    name = "table";
+#else
+    name = "threaded";
+#endif
+#if defined(NES_CPU_DECODE_CACHE)
+    name += "+decode-cache";
+#endif
+#if defined(NES_CPU_DYNAREC)
+    name += "+dynarec";
+#endif
+#if defined(NES_PPU_SCANLINE_RENDERER)
+    name += "+scanline";
+#endif
+
+    return name;
+}
+
+/*
+ *
+ *  Synthetic ROMs
+ *
+ */
+
+// Build a NROM ROM with the code at $8000, the NMI handler at $C000,
+// a subroutine returning at $9000 and a pattern in the CHR ROM
+static std::vector<uint8_t> buildRom(const std::vector<uint8_t>& code, const std::vector<uint8_t>& nmi) {
+    // Two 16 KB PRG banks and one 8 KB CHR bank
+    std::vector<uint8_t> rom(16 + 0x8000 + 0x2000, 0xEA);
+    const uint8_t header[16] = {'N', 'E', 'S', 0x1A, 2, 1, 0x00, 0x00};
+    std::copy(header, header + sizeof(header), rom.begin());
+
+    uint8_t* p_prg = rom.data() + 16;
+    std::copy(code.begin(), code.end(), p_prg);
+    std::copy(nmi.begin(), nmi.end(), p_prg + 0x4000);
+    p_prg[0x1000] = 0x60;
+    p_prg[0x3000] = 0x40;
+
+    // NMI, reset and IRQ vectors
+    p_prg[0x7FFA] = 0x00; p_prg[0x7FFB] = 0xC0;
+    p_prg[0x7FFC] = 0x00; p_prg[0x7FFD] = 0x80;
+    p_prg[0x7FFE] = 0x00; p_prg[0x7FFF] = 0xB0;
+
+    uint8_t* p_chr = p_prg + 0x8000;
+    for (int i = 0; i < 0x2000; i++)
+        p_chr[i] = static_cast<uint8_t>(i * 37 ^ (i >> 3));
+
+    return rom;
+}
+
+// Build a ROM running the init code then the block in a loop
+static std::vector<uint8_t> buildCpuRom(const std::vector<uint8_t>& init, const std::vector<uint8_t>& block) {
+    std::vector<uint8_t> code = init;
+    uint16_t loop = 0x8000 + code.size();
+
+    for (int i = 0; i < BENCH_CPU_BLOCK_REPEAT; i++)
+        code.insert(code.end(), block.begin(), block.end());
+
+    code.insert(code.end(), {0x4C, static_cast<uint8_t>(loop & 0xFF), static_cast<uint8_t>(loop >> 8)});
+
+    return buildRom(code, {0x40});
+}
+
+// Build a ROM drawing the background and the sprites with the
+// OAM DMA and the scrolling updated in the NMI, like a simple game
+static std::vector<uint8_t> buildDemoRom() {
+    std::vector<uint8_t> code = {
+        0x78, 0xD8, 0xA2, 0xFF, 0x9A,               // SEI, CLD, LDX #$FF, TXS
+        0x2C, 0x02, 0x20, 0x10, 0xFB,               // Wait two vblanks
+        0x2C, 0x02, 0x20, 0x10, 0xFB,
+        0xA9, 0x3F, 0x8D, 0x06, 0x20,               // Palette address
+        0xA9, 0x00, 0x8D, 0x06, 0x20,
+        0xA2, 0x00,                                 // Write the 32 colors
+        0x8A, 0x8D, 0x07, 0x20, 0xE8, 0xE0, 0x20, 0xD0, 0xF7,
+        0xA9, 0x20, 0x8D, 0x06, 0x20,               // Name table address
+        0xA9, 0x00, 0x8D, 0x06, 0x20,
+        0xA0, 0x04, 0xA2, 0x00,                     // Write 4 pages of tiles
+        0x8A, 0x8D, 0x07, 0x20, 0xE8, 0xD0, 0xF9, 0x88, 0xD0, 0xF6,
+        0xA2, 0x00,                                 // Fill the OAM page
+        0x8A, 0x9D, 0x00, 0x02, 0xE8, 0xD0, 0xF9,
+        0xA9, 0x80, 0x8D, 0x00, 0x20,               // Enable the NMI
+        0xA9, 0x1E, 0x8D, 0x01, 0x20,               // Enable the rendering
+    };
+
+    // Main loop updating the game state
+    uint16_t main = 0x8000 + code.size();
+    code.insert(code.end(), {
+        0xE6, 0x00, 0xA5, 0x00, 0x65, 0x01, 0x85, 0x01,    // INC, LDA, ADC, STA
+        0xA2, 0x10, 0xCA, 0xD0, 0xFD,                      // Delay loop
+        0x4C, static_cast<uint8_t>(main & 0xFF), static_cast<uint8_t>(main >> 8)
+    });
+
+    std::vector<uint8_t> nmi = {
+        0x48,                                       // PHA
+        0xA9, 0x00, 0x8D, 0x03, 0x20,               // OAM DMA from page 2
+        0xA9, 0x02, 0x8D, 0x14, 0x40,
+        0xE6, 0x02,                                 // Scroll one pixel per frame
+        0xA5, 0x02, 0x8D, 0x05, 0x20,
+        0xA9, 0x00, 0x8D, 0x05, 0x20,
+        0xA9, 0x80, 0x8D, 0x00, 0x20,
+        0x68, 0x40                                  // PLA, RTI
+    };
+
+    return buildRom(code, nmi);
+}
+
+/*
+ *
+ *  Benchmarks
+ *
+ */
+
+// Run the instructions of a synthetic ROM with the rendering disabled, an
+// operation is one frame of CPU cycles as the threaded engine run several
+// instructions per step
+static Benchmark cpuBenchmark(const std::string& name, const std::vector<uint8_t>& init, const std::vector<uint8_t>& block) {
+    std::vector<uint8_t> rom = buildCpuRom(init, block);
+
+    return {name, "micro", "frame", [rom](uint64_t iterations, uint64_t& checksum) {
+        nesCore::NesEmulator* emulator = new nesCore::NesEmulator();
+        nesCore::DummyIO io;
+        emulator->attachIO(&io);
+        emulator->loadCartridgeFromMemory(rom.data(), rom.size());
+
+        auto start = std::chrono::steady_clock::now();
+        for (uint64_t i = 0; i < iterations; i++)
+            emulator->runFrame();
+        double elapsed = secondsSince(start);
+
+        checksum += emulator->cpuDebugInfo().cpuCycle;
+        delete emulator;
+
+        return elapsed;
+    }, 0};
+}
+
+// Read or write the bus at pseudo random addresses of a region,
+// an operation is one access
+static Benchmark busBenchmark(const std::string& name, uint16_t base, uint16_t mask, bool write) {
+    std::vector<uint8_t> rom = buildCpuRom({}, {0xEA});
+
+    return {name, "micro", "access", [rom, base, mask, write](uint64_t iterations, uint64_t& checksum) {
+        nesCore::Cartridge* cartridge = nesCore::Cartridge::loadCartridgeFromMemory(rom.data(), rom.size());
+        nesCore::PpuBus* ppuBus = new nesCore::PpuBus();
+        nesCore::Bus* bus = new nesCore::Bus();
+
+        ppuBus->attachCartriadge(cartridge);
+        bus->attachPpu(&ppuBus->m_ppu);
+        bus->attachCartriadge(cartridge);
+
+        uint8_t sum = 0;
+        auto start = std::chrono::steady_clock::now();
+
+        if (write) {
+            for (uint64_t i = 0; i < iterations; i++)
+                bus->write(base | ((i * 7919) & mask), static_cast<uint8_t>(i));
+            sum = bus->mp_ram[iterations & 0x07FF];
+        } else {
+            for (uint64_t i = 0; i < iterations; i++)
+                sum += bus->read(base | ((i * 7919) & mask));
+        }
+
+        double elapsed = secondsSince(start);
+        checksum += sum;
+
+        delete bus;
+        delete ppuBus;
+        delete cartridge;
+
+        return elapsed;
+    }, 0};
+}
+
+// Clock a rendering PPU by a scan line or a frame of CPU cycles,
+// an operation is one scan line or one frame
+static Benchmark ppuBenchmark(const std::string& name, bool frame) {
+    std::vector<uint8_t> rom = buildCpuRom({}, {0xEA});
+
+    return {name, "micro", frame ? "frame" : "scan line", [rom, frame](uint64_t iterations, uint64_t& checksum) {
+        nesCore::Cartridge* cartridge = nesCore::Cartridge::loadCartridgeFromMemory(rom.data(), rom.size());
+        nesCore::PpuBus* ppuBus = new nesCore::PpuBus();
+        nesCore::FrameBuffer* frameBuffer = new nesCore::FrameBuffer();
+        nesCore::PPU& ppu = ppuBus->m_ppu;
+
+        ppuBus->attachCartriadge(cartridge);
+        ppu.attachFrameBuffer(frameBuffer);
+        ppu.reset();
+
+        // The registers ignore the writes of the first frame
+        ppu.clock(BENCH_FRAME_CYCLES);
+
+        // Tiles, colors and sprites spread over the screen
+        for (uint16_t addr = 0x2000; addr < 0x2800; addr++)
+            ppuBus->write(addr, static_cast<uint8_t>(addr * 13));
+        for (uint16_t addr = 0x3F00; addr < 0x3F20; addr++)
+            ppuBus->write(addr, static_cast<uint8_t>(addr));
+
+        ppu.writeRegister(0x2003, 0x00);
+        for (int i = 0; i < 256; i++)
+            ppu.writeRegister(0x2004, static_cast<uint8_t>(i * 29));
+
+        ppu.writeRegister(0x2000, 0x80);
+        ppu.writeRegister(0x2001, 0x1E);
+
+        uint64_t interrupts = 0;
+        auto start = std::chrono::steady_clock::now();
+
+        for (uint64_t i = 0; i < iterations; i++) {
+            // A scan line is 341 dots, 113.67 CPU cycles
+            size_t cycles = frame ? BENCH_FRAME_CYCLES : (i % 3 == 2 ? 113 : 114);
+            interrupts += ppu.clock(cycles) == nesCore::NMI;
+        }
+
+        double elapsed = secondsSince(start);
+        checksum += interrupts;
+
+        delete frameBuffer;
+        delete ppuBus;
+        delete cartridge;
+
+        return elapsed;
+    }, 0};
+}
+
+// Write every pixel of the frame, an operation is one pixel
+static Benchmark frameBufferBenchmark() {
+    return {"framebuffer.setPixel", "micro", "pixel", [](uint64_t iterations, uint64_t& checksum) {
+        nesCore::FrameBuffer* frameBuffer = new nesCore::FrameBuffer();
+
+        auto start = std::chrono::steady_clock::now();
+        for (uint64_t i = 0; i < iterations; i++) {
+            size_t pixel = i % (nesCore::SCREEN_WIDTH * nesCore::SCREEN_HEIGHT);
+            frameBuffer->setPixel(pixel % nesCore::SCREEN_WIDTH, pixel / nesCore::SCREEN_WIDTH, i & 0x3F);
+        }
+        double elapsed = secondsSince(start);
+
+        frameBuffer->swapBuffers();
+        checksum += frameBuffer->indices()[iterations % 1024];
+        delete frameBuffer;
+
+        return elapsed;
+    }, 0};
+}
+
+// Publish drawn frames in the given format, an operation is one frame
+static Benchmark frameBufferSwapBenchmark(const std::string& name, nesCore::FrameFormat format) {
+    return {name, "micro", "frame", [format](uint64_t iterations, uint64_t& checksum) {
+        nesCore::FrameBuffer* frameBuffer = new nesCore::FrameBuffer();
+        frameBuffer->setFormat(format);
+
+        auto start = std::chrono::steady_clock::now();
+        for (uint64_t i = 0; i < iterations; i++) {
+            frameBuffer->setPixel(i % nesCore::SCREEN_WIDTH, 0, i & 0x3F);
+            frameBuffer->swapBuffers();
+        }
+        double elapsed = secondsSince(start);
+
+        checksum += frameBuffer->data()[iterations % 768] + frameBuffer->indices()[iterations % 256];
+        delete frameBuffer;
+
+        return elapsed;
+    }, 0};
+}
+
+// Load and free a 32 KB PRG, 8 KB CHR cartridge, an operation is one load
+static Benchmark cartridgeBenchmark() {
+    std::vector<uint8_t> rom = buildDemoRom();
+
+    return {"cartridge.load", "micro", "load", [rom](uint64_t iterations, uint64_t& checksum) {
+        auto start = std::chrono::steady_clock::now();
+        for (uint64_t i = 0; i < iterations; i++) {
+            nesCore::Cartridge* cartridge = nesCore::Cartridge::loadCartridgeFromMemory(rom.data(), rom.size());
+            checksum += cartridge != nullptr;
+            delete cartridge;
+        }
+
+        return secondsSince(start);
+    }, 0};
+}
+
+// Run a ROM for a fixed number of frames, an operation is one frame
+// and the checksum is the hash of the last frame
+static Benchmark romBenchmark(
+    const std::string& name, const std::vector<uint8_t>& rom,
+    const std::vector<uint8_t>& palette, uint64_t frames
+) {
+    return {name, "macro", "frame", [rom, palette](uint64_t iterations, uint64_t& checksum) {
+        nesCore::NesEmulator* emulator = new nesCore::NesEmulator();
+        nesCore::DummyIO io;
+        emulator->attachIO(&io);
+        emulator->getFrameBuffer()->setPalette(palette.data(), palette.size());
+
+        if (emulator->loadCartridgeFromMemory(rom.data(), rom.size()) != 0) {
+            delete emulator;
+            return 0.0;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        for (uint64_t i = 0; i < iterations; i++)
+            emulator->runFrame();
+        double elapsed = secondsSince(start);
+
+        checksum = nesCore::utility::hashBytes(
+            emulator->getFrameBuffer()->data(),
+            nesCore::SCREEN_WIDTH * nesCore::SCREEN_HEIGHT * 3
+        );
+        delete emulator;
+
+        return elapsed;
+    }, frames};
+}
+
+// Run the benchmark with the number of operations growing
+// until it last the minimum time
+static BenchResult measure(const Benchmark& benchmark, double minTime) {
+    BenchResult result;
+    result.name = benchmark.name;
+    result.group = benchmark.group;
+
+    uint64_t iterations = benchmark.fixedIterations != 0 ? benchmark.fixedIterations : 16;
+    double elapsed;
+
+    while (true) {
+        result.checksum = 0;
+        elapsed = benchmark.run(iterations, result.checksum);
+
+        if (benchmark.fixedIterations != 0 || elapsed >= minTime)
+            break;
+
+        // Aim a bit above the minimum time from the last run
+        double scale = elapsed > 0.0 ? minTime * 1.2 / elapsed : 100.0;
+        iterations = static_cast<uint64_t>(iterations * std::min(std::max(scale, 2.0), 100.0));
+    }
+
+    result.iterations = iterations;
+    result.nsPerOp = elapsed * 1e9 / iterations;
+
+    return result;
+}
+
+/*
+ *
+ *  Results
+ *
+ */
+
+// Write the results as CSV, return false on failure
+static bool writeCsv(const std::string& filename, const std::string& build, const std::vector<BenchResult>& results) {
+    std::ofstream file(filename);
+    if (!file.good())
+        return false;
+
+    file << "name,group,build,iterations,ns_per_op,checksum\n";
+    for (const BenchResult& result : results) {
+        file << result.name << "," << result.group << "," << build << ",";
+        file << result.iterations << "," << std::fixed << std::setprecision(3) << result.nsPerOp << ",";
+        file << std::hex << std::setw(16) << std::setfill('0') << result.checksum << std::dec << "\n";
+    }
+
+    return file.good();
+}
+
+// Read the results of a CSV written by another build
+// Return 0 on success, 1 if the file can't be opened and 2 on format error
+static int readCsv(const std::string& filename, std::string& build, std::map<std::string, BenchResult>& results) {
+    std::ifstream file(filename);
+    if (!file.good())
+        return 1;
+
+    std::string line;
+    std::getline(file, line);
+
+    while (std::getline(file, line)) {
+        if (line.empty())
+            continue;
+
+        std::vector<std::string> fields;
+        std::stringstream s(line);
+        std::string field;
+        while (std::getline(s, field, ','))
+            fields.push_back(field);
+
+        if (fields.size() != 6)
+            return 2;
+
+        BenchResult result;
+        result.name = fields[0];
+        result.group = fields[1];
+        result.iterations = std::strtoull(fields[3].c_str(), nullptr, 10);
+        result.nsPerOp = std::strtod(fields[4].c_str(), nullptr);
+        result.checksum = std::strtoull(fields[5].c_str(), nullptr, 16);
+
+        build = fields[2];
+        results[result.name] = result;
+    }
+
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    // Parse commands line arguments
+    argparse::ArgumentParser argParser("core_benchmark");
+
+    argParser.add_argument("--rom")
+        .default_value(std::vector<std::string>())
+        .append()
+        .help("ROM file run by a macro benchmark, can be repeated");
+
+    argParser.add_argument("-p", "--palettes")
+        .default_value(std::string("resources/palettes/2C02G.pal"))
+        .help("specify the color palettes file used by the macro benchmarks");
+
+    argParser.add_argument("-f", "--frames")
+        .default_value(600ULL)
+        .action([](const std::string& value) { return std::stoull(value); })
+        .help("number of frames run by the macro benchmarks");
+
+    argParser.add_argument("-t", "--min-time")
+        .default_value(0.5)
+        .action([](const std::string& value) { return std::stod(value); })
+        .help("minimum time of a micro benchmark in seconds");
+
+    argParser.add_argument("--filter")
+        .default_value(std::string())
+        .help("only run the benchmarks with the given text in their name");
+
+    argParser.add_argument("-o", "--output")
+        .default_value(std::string())
+        .help("write the results to the given CSV file");
+
+    argParser.add_argument("-b", "--baseline")
+        .default_value(std::string())
+        .help("compare the results with the CSV file of another build");
+
+    try {
+        argParser.parse_args(argc, argv);
+    }
+    catch (const std::runtime_error& err) {
+        std::cerr << err.what() << std::endl;
+        std::cerr << argParser;
+        return 1;
+    }
+
+    uint64_t frames = std::max(argParser.get<unsigned long long>("frames"), 1ULL);
+    double minTime = argParser.get<double>("min-time");
+    std::string filter = argParser.get("filter");
+    std::string outputPath = argParser.get("output");
+    std::string baselinePath = argParser.get("baseline");
+
+    std::string baselineBuild;
+    std::map<std::string, BenchResult> baseline;
+    if (!baselinePath.empty()) {
+        int readError = readCsv(baselinePath, baselineBuild, baseline);
+        if (readError != 0) {
+            std::cerr << "Failed to read the baseline, error code: " << readError << std::endl;
+            return 2;
+        }
+    }
+
+    std::vector<uint8_t> palette;
+    if (!nesCore::utility::readFile(argParser.get("palettes"), palette)) {
+        std::cerr << "Failed to open the palette " << argParser.get("palettes") << std::endl;
+        return 2;
+    }
+
+    std::vector<Benchmark> benchmarks = {
+        busBenchmark("bus.read.ram", 0x0000, 0x1FFF, false),
+        busBenchmark("bus.write.ram", 0x0000, 0x1FFF, true),
+        busBenchmark("bus.read.prg", 0x8000, 0x7FFF, false),
+
+        // Zero page, absolute and indexed loads and stores
+        cpuBenchmark("cpu.load_store", {0xA2, 0x03}, {
+            0xA5, 0x10, 0x85, 0x11, 0xAD, 0x00, 0x02, 0x8D, 0x01, 0x02, 0xB5, 0x10, 0xBD, 0x00, 0x02
+        }),
+        // Immediate and zero page arithmetic and logic
+        cpuBenchmark("cpu.alu", {}, {
+            0x69, 0x01, 0xE9, 0x01, 0x29, 0xFF, 0x09, 0x01, 0x49, 0x55, 0xC9, 0x10, 0x65, 0x10
+        }),
+        // Read modify write on memory and the accumulator
+        cpuBenchmark("cpu.rmw", {}, {
+            0xE6, 0x10, 0x06, 0x11, 0x66, 0x12, 0xC6, 0x13, 0xEE, 0x00, 0x02, 0x0A
+        }),
+        // Taken and not taken branches
+        cpuBenchmark("cpu.branch", {}, {
+            0x18, 0x90, 0x00, 0xB0, 0x00, 0xF0, 0x00, 0xD0, 0x00
+        }),
+        // Pushes and pulls
+        cpuBenchmark("cpu.stack", {}, {
+            0x48, 0x08, 0x68, 0x28
+        }),
+        // Subroutine calls and returns
+        cpuBenchmark("cpu.jump", {}, {
+            0x20, 0x00, 0x90
+        }),
+        // Indirect indexed addressing through a zero page pointer
+        cpuBenchmark("cpu.indirect", {0xA9, 0x00, 0x85, 0x20, 0xA9, 0x02, 0x85, 0x21, 0xA2, 0x00, 0xA0, 0x04}, {
+            0xB1, 0x20, 0x91, 0x20, 0xA1, 0x20, 0x81, 0x20
+        }),
+        // Transfers, increments and flags
+        cpuBenchmark("cpu.implied", {}, {
+            0xAA, 0xA8, 0x8A, 0xE8, 0x88, 0x38, 0x18, 0xEA
+        }),
+
+        ppuBenchmark("ppu.clock.scanline", false),
+        ppuBenchmark("ppu.clock.frame", true),
+        frameBufferBenchmark(),
+        frameBufferSwapBenchmark("framebuffer.swap.rgb", nesCore::FRAME_RGB),
+        frameBufferSwapBenchmark("framebuffer.swap.indexed", nesCore::FRAME_INDEXED),
+        cartridgeBenchmark(),
+
+        romBenchmark("rom.demo", buildDemoRom(), palette, frames),
+    };
+
+    // ROM files given on the command line
+    for (const std::string& path : argParser.get<std::vector<std::string>>("rom")) {
+        std::vector<uint8_t> rom;
+        if (!nesCore::utility::readFile(path, rom)) {
+            std::cerr << "Failed to open " << path << std::endl;
+            return 3;
+        }
+
+        // Check the ROM once, the benchmark output is silenced
+        std::streambuf* p_coutBuffer = std::cout.rdbuf(nullptr);
+        nesCore::Cartridge* cartridge = nesCore::Cartridge::loadCartridgeFromMemory(rom.data(), rom.size());
+        std::cout.rdbuf(p_coutBuffer);
+
+        if (cartridge == nullptr) {
+            std::cerr << "Failed to load " << path << std::endl;
+            return 3;
+        }
+        delete cartridge;
+
+        std::string name = "rom." + path.substr(path.find_last_of("/\\") + 1);
+        benchmarks.push_back(romBenchmark(name, rom, palette, frames));
+    }
+
+    std::string build = buildName();
+    std::cout << "Core benchmark, build " << build;
+    if (!baselineBuild.empty())
+        std::cout << " against " << baselineBuild;
+    std::cout << std::endl;
+
+    std::vector<BenchResult> results;
+
+    for (const Benchmark& benchmark : benchmarks) {
+        if (benchmark.name.find(filter) == std::string::npos)
+            continue;
+
+        // The cartridge loading and the CPU warnings are not part of the timing
+        std::streambuf* p_coutBuffer = std::cout.rdbuf(nullptr);
+        std::cerr.setstate(std::ios_base::badbit);
+
+        BenchResult result = measure(benchmark, minTime);
+
+        std::cout.rdbuf(p_coutBuffer);
+        std::cerr.clear();
+
+        results.push_back(result);
+
+        std::cout << std::left << std::setw(22) << result.name << std::right;
+        std::cout << std::fixed << std::setprecision(2) << std::setw(12) << result.nsPerOp;
+        std::cout << " ns per " << benchmark.unit;
+
+        if (benchmark.group == "macro")
+            std::cout << " (" << std::setprecision(1) << 1e9 / result.nsPerOp << " fps)";
+
+        auto base = baseline.find(result.name);
+        if (base != baseline.end() && base->second.nsPerOp > 0.0) {
+            double change = (result.nsPerOp / base->second.nsPerOp - 1.0) * 100.0;
+            std::cout << ", " << std::showpos << std::setprecision(1) << change << std::noshowpos << "%";
+
+            // The same operations must give the same result on every build
+            if (base->second.iterations == result.iterations && base->second.checksum != result.checksum)
+                std::cout << ", checksum differs";
+        }
+        std::cout << std::endl;
+    }
+
+    if (!outputPath.empty() && !writeCsv(outputPath, build, results)) {
+        std::cerr << "Failed to write the results" << std::endl;
+        return 3;
+    }
+
+    return 0;
+}
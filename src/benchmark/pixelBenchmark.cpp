@@ -0,0 +1,210 @@
+#include "nesPch.h"
+
+#include <cstring>
+#include <vector>
+
+#include "nesCore/frameBuffer.h"
+#include "nesCore/utility/pixelKernels.h"
+
+// Pixel kernels check and benchmark
+//
+// Check every SIMD variant supported by the host against the scalar
+// reference, on sizes hitting the vector loops and their tails and with
+// guard bytes after the outputs, then report the throughput of each
+// kernel in output pixels per nanosecond on a NES frame
+
+// Bytes after each output that no kernel may write
+#define BENCH_GUARD_BYTES 64
+#define BENCH_GUARD_VALUE 0xA5
+
+using nesCore::utility::PixelKernels;
+
+// Deterministic palette indices and pixels
+static void fillRandom(uint8_t* data, size_t size, uint32_t seed, uint8_t mask) {
+    for (size_t i = 0; i < size; i++) {
+        seed = seed * 1664525 + 1013904223;
+        data[i] = (seed >> 24) & mask;
+    }
+}
+
+// Run a kernel on an output filled with the guard value, the returned
+// bytes are the output followed by the guard bytes, compared as a whole
+template <typename Kernel>
+static std::vector<uint8_t> runGuarded(size_t outputBytes, Kernel kernel) {
+    // 32 bits pixels are written, keep the storage aligned for them
+    std::vector<uint32_t> storage((outputBytes + BENCH_GUARD_BYTES) / 4 + 1);
+    std::memset(storage.data(), BENCH_GUARD_VALUE, storage.size() * 4);
+
+    kernel(reinterpret_cast<uint8_t*>(storage.data()));
+
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(storage.data());
+    return std::vector<uint8_t>(bytes, bytes + outputBytes + BENCH_GUARD_BYTES);
+}
+
+// Compare every kernel of a variant with the scalar one
+// Return the number of failed checks
+static int checkKernels(const PixelKernels& kernels, const PixelKernels& reference, const uint32_t* palette) {
+    const size_t counts[] = {0, 1, 3, 4, 5, 7, 8, 9, 31, 32, 33, 34, 35, 63, 64, 65, 66, 100, 257,
+        nesCore::SCREEN_WIDTH * nesCore::SCREEN_HEIGHT};
+    const size_t sizes[][2] = {{1, 1}, {3, 2}, {4, 1}, {7, 3}, {8, 2}, {9, 5}, {17, 4}, {256, 240}};
+    int failures = 0;
+
+    std::vector<uint8_t> indices(nesCore::SCREEN_WIDTH * nesCore::SCREEN_HEIGHT);
+    fillRandom(indices.data(), indices.size(), 0x1234, 0x3F);
+
+    for (size_t count : counts) {
+        auto rgb24 = [&](const PixelKernels& k) {
+            return runGuarded(count * 3, [&](uint8_t* output) {
+                k.indexToRgb24(indices.data(), count, palette, output);
+            });
+        };
+        auto pixel32 = [&](const PixelKernels& k) {
+            return runGuarded(count * 4, [&](uint8_t* output) {
+                k.indexToPixel32(indices.data(), count, palette, reinterpret_cast<uint32_t*>(output));
+            });
+        };
+
+        if (rgb24(kernels) != rgb24(reference)) {
+            std::cerr << kernels.name << " indexToRgb24 differ for " << count << " pixels" << std::endl;
+            failures++;
+        }
+        if (pixel32(kernels) != pixel32(reference)) {
+            std::cerr << kernels.name << " indexToPixel32 differ for " << count << " pixels" << std::endl;
+            failures++;
+        }
+    }
+
+    for (const size_t* size : sizes) {
+        std::vector<uint32_t> image(size[0] * size[1]);
+        fillRandom(reinterpret_cast<uint8_t*>(image.data()), image.size() * 4, 0x5678, 0xFF);
+
+        for (int factor = 1; factor <= 5; factor++) {
+            auto scale = [&](const PixelKernels& k) {
+                return runGuarded(image.size() * factor * factor * 4, [&](uint8_t* output) {
+                    k.scale32(image.data(), size[0], size[1], factor, reinterpret_cast<uint32_t*>(output));
+                });
+            };
+
+            if (scale(kernels) != scale(reference)) {
+                std::cerr << kernels.name << " scale32 x" << factor << " differ for ";
+                std::cerr << size[0] << "x" << size[1] << std::endl;
+                failures++;
+            }
+        }
+    }
+
+    return failures;
+}
+
+// Repeat a kernel for at least the given time and return the output pixels per nanosecond
+template <typename Kernel>
+static double measure(double minSeconds, size_t pixels, Kernel kernel) {
+    uint64_t iterations = 0;
+    double elapsed = 0.0;
+
+    auto start = std::chrono::steady_clock::now();
+    while (elapsed < minSeconds) {
+        for (int i = 0; i < 16; i++)
+            kernel();
+
+        iterations += 16;
+        elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    return static_cast<double>(iterations) * pixels / (elapsed * 1e9);
+}
+
+int main(int argc, char *argv[]) {
+    // Minimum time of each measure in milliseconds
+    int milliseconds = argc > 1 ? std::atoi(argv[1]) : 200;
+    double minSeconds = milliseconds / 1000.0;
+
+    const PixelKernels& reference = *nesCore::utility::pixelKernels(nesCore::utility::SIMD_SCALAR);
+    const PixelKernels& selected = nesCore::utility::pixelKernels();
+
+    std::cout << "Pixel kernels benchmark, selected kernels: " << selected.name << std::endl;
+
+    // Palette with distinct bytes so any swapped byte is detected
+    uint8_t colors[64 * 3];
+    fillRandom(colors, sizeof(colors), 0x9ABC, 0xFF);
+
+    uint32_t rgbaPalette[64];
+    uint32_t bgraPalette[64];
+    nesCore::utility::buildPixelPalette(colors, nesCore::utility::PIXEL_RGBA32, rgbaPalette);
+    nesCore::utility::buildPixelPalette(colors, nesCore::utility::PIXEL_BGRA32, bgraPalette);
+
+    // Check the variants
+    std::vector<const PixelKernels*> variants;
+    int failures = 0;
+
+    for (int level = nesCore::utility::SIMD_SCALAR; level <= nesCore::utility::SIMD_AVX2; level++) {
+        const PixelKernels* p_kernels = nesCore::utility::pixelKernels(static_cast<nesCore::utility::SimdLevel>(level));
+        if (p_kernels == nullptr)
+            continue;
+
+        int kernelFailures = checkKernels(*p_kernels, reference, rgbaPalette);
+        kernelFailures += checkKernels(*p_kernels, reference, bgraPalette);
+
+        std::cout << "Check " << p_kernels->name << ": " << (kernelFailures == 0 ? "OK" : "FAILED") << std::endl;
+
+        failures += kernelFailures;
+        variants.push_back(p_kernels);
+    }
+
+    if (failures != 0)
+        return 1;
+
+    // Benchmark the variants on a frame
+    const size_t width = nesCore::SCREEN_WIDTH;
+    const size_t height = nesCore::SCREEN_HEIGHT;
+    const size_t pixels = width * height;
+
+    std::vector<uint8_t> indices(pixels);
+    fillRandom(indices.data(), indices.size(), 0x1234, 0x3F);
+
+    std::vector<uint8_t> rgbFrame(pixels * 3);
+    std::vector<uint32_t> frame(pixels);
+    std::vector<uint32_t> scaled(pixels * 16);
+    uint64_t checksum = 0;
+
+    for (const PixelKernels* p_kernels : variants) {
+        const PixelKernels& k = *p_kernels;
+
+        struct Result {
+            const char* name;
+            double pixelsPerNs;
+        };
+        const Result results[] = {
+            {"rgb24", measure(minSeconds, pixels, [&]() {
+                k.indexToRgb24(indices.data(), pixels, rgbaPalette, rgbFrame.data());
+            })},
+            {"rgba32", measure(minSeconds, pixels, [&]() {
+                k.indexToPixel32(indices.data(), pixels, rgbaPalette, frame.data());
+            })},
+            {"bgra32", measure(minSeconds, pixels, [&]() {
+                k.indexToPixel32(indices.data(), pixels, bgraPalette, frame.data());
+            })},
+            {"scale2x", measure(minSeconds, pixels * 4, [&]() {
+                k.scale32(frame.data(), width, height, 2, scaled.data());
+            })},
+            {"scale3x", measure(minSeconds, pixels * 9, [&]() {
+                k.scale32(frame.data(), width, height, 3, scaled.data());
+            })},
+            {"scale4x", measure(minSeconds, pixels * 16, [&]() {
+                k.scale32(frame.data(), width, height, 4, scaled.data());
+            })},
+        };
+
+        for (const Result& result : results) {
+            std::cout << std::left << std::setw(8) << k.name << std::setw(10) << result.name;
+            std::cout << std::right << std::fixed << std::setprecision(3) << std::setw(9);
+            std::cout << result.pixelsPerNs << " pixels per ns" << std::endl;
+        }
+
+        checksum += rgbFrame[pixels / 2] + frame[pixels / 3] + scaled[pixels * 5];
+    }
+
+    std::cout << "Checksum " << checksum << std::endl;
+
+    return 0;
+}
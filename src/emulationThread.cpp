@@ -0,0 +1,207 @@
+#include "nesPch.h"
+
+#include "emulationThread.h"
+#include "nesCore/cpu/cpu6502debug.h"
+
+namespace emulation {
+EmulationThread::EmulationThread(nesCore::NesEmulator& emulator) :
+    m_emulator(emulator), mp_audio(nullptr), mp_rewind(nullptr), mp_movie(nullptr),
+    m_commands(EMULATION_COMMAND_QUEUE_SIZE), m_input(0),
+    m_running(true), m_rewinding(false), m_limitFps(true), m_audioSync(false),
+    m_emulationFps(60), m_frameCount(0), m_frameMicroseconds(0.0) {}
+EmulationThread::~EmulationThread() {
+    if (m_thread.joinable()) {
+        this->sendCommand(COMMAND_QUIT);
+        m_thread.join();
+    }
+}
+
+void EmulationThread::attachAudio(audio::Sdl2Audio* audio, bool audioSync) {
+    mp_audio = audio;
+    m_audioSync = audioSync && audio != nullptr;
+}
+void EmulationThread::attachRewindBuffer(nesCore::RewindBuffer* rewind) {
+    mp_rewind = rewind;
+}
+void EmulationThread::attachMovie(nesCore::Movie* movie) {
+    mp_movie = movie;
+}
+
+// Start the emulation thread
+void EmulationThread::start() {
+    m_emulator.attachIO(mp_movie != nullptr ? static_cast<nesCore::IOInterface*>(mp_movie) : &m_controllers);
+    m_thread = std::thread(&EmulationThread::run, this);
+}
+void EmulationThread::join() {
+    if (m_thread.joinable())
+        m_thread.join();
+}
+
+/*
+ *
+ *  Main thread side
+ *
+ */
+
+bool EmulationThread::sendCommand(Command command) {
+    return m_commands.write(&command, 1) == 1;
+}
+void EmulationThread::setInput(uint8_t buttons) {
+    m_input.store(buttons, std::memory_order_relaxed);
+}
+
+uint64_t EmulationThread::emulatedFrames() {
+    return m_frameCount;
+}
+double EmulationThread::averageFrameMicroseconds() {
+    return m_frameCount != 0 ? m_frameMicroseconds / m_frameCount : 0.0;
+}
+
+/*
+ *
+ *  Emulation thread side
+ *
+ */
+
+// Emulation thread loop
+void EmulationThread::run() {
+    std::chrono::time_point<std::chrono::steady_clock> frameTimer;
+
+    while (true) {
+        // Start the frame timer
+        frameTimer = std::chrono::steady_clock::now();
+
+        if (!this->handleCommands())
+            break;
+
+        // The audio sink is detached while rewinding, the
+        // frame limiter pace the emulation without audio
+        bool audioPaced = m_audioSync && !m_rewinding;
+
+        if (audioPaced && m_running && m_limitFps) {
+            // Wait for the audio device if the emulation is ahead
+            mp_audio->waitForPlayback();
+            m_emulator.setAudioRateRatio(mp_audio->rateRatio());
+        }
+
+        // Restore the previous frame and run it again to draw it,
+        // the emulation stop at the oldest frame of the buffer
+        bool runFrame = m_running;
+        if (m_rewinding && runFrame)
+            runFrame = mp_rewind->rewind(m_emulator) == 0;
+
+        if (runFrame)
+            this->emulateFrame();
+
+        if (mp_rewind != nullptr && runFrame && !m_rewinding)
+            mp_rewind->push(m_emulator);
+
+        if (m_limitFps && m_emulationFps > 0 && !audioPaced) {
+            // Get the elapsed time and calculate the delay for the next frame
+            auto frameTime = std::chrono::microseconds(1'000'000 / m_emulationFps);
+            auto frameDelta = std::chrono::duration_cast<std::chrono::microseconds>(
+                frameTime - (std::chrono::steady_clock::now() - frameTimer
+            ));
+
+            // Sleep for the necessary amount of time
+            std::this_thread::sleep_for(frameDelta);
+        } else if (!runFrame) {
+            // Wait for the commands while paused
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+}
+
+// Execute the queued commands
+bool EmulationThread::handleCommands() {
+    Command command;
+
+    while (m_commands.read(&command, 1) == 1) {
+        switch (command) {
+            case COMMAND_QUIT:
+                return false;
+
+            case COMMAND_PAUSE:
+                m_running = !m_running;
+                break;
+
+            // The movie reset the emulator at the start of the next frame
+            case COMMAND_RESET:
+                if (mp_movie != nullptr)
+                    mp_movie->requestReset();
+                else
+                    m_emulator.reset();
+                break;
+
+            // Stepping, loading a state and rewinding would break the movie
+            case COMMAND_STEP_FRAME:
+                if (!m_running && mp_movie == nullptr)
+                    m_emulator.runFrame();
+                break;
+
+            // Run one instruction and print debug info
+            case COMMAND_STEP_INSTRUCTION:
+                if (!m_running && mp_movie == nullptr) {
+                    m_emulator.step(1);
+
+                    nesCore::debug::Cpu6502Debug info = m_emulator.cpuDebugInfo();
+
+                    std::cout << info.log() << " -- ";
+                    std::cout << m_emulator.decompileInstruction(info.pc) << std::endl;
+                }
+                break;
+
+            case COMMAND_QUICK_SAVE:
+                m_emulator.saveState(m_quickState);
+                break;
+
+            case COMMAND_QUICK_LOAD:
+                if (!m_quickState.empty() && mp_movie == nullptr) {
+                    int loadError = m_emulator.loadState(m_quickState);
+                    if (loadError != 0)
+                        std::cerr << "Failed to load the state, error code: " << loadError << std::endl;
+                }
+                break;
+
+            // The audio is muted while rewinding
+            case COMMAND_REWIND_START:
+            case COMMAND_REWIND_STOP:
+                if (mp_rewind != nullptr && mp_movie == nullptr) {
+                    m_rewinding = command == COMMAND_REWIND_START;
+
+                    if (mp_audio != nullptr)
+                        m_emulator.attachAudioSink(m_rewinding ? nullptr : mp_audio);
+                }
+                break;
+
+            case COMMAND_TOGGLE_FRAME_LIMIT:
+                m_limitFps = !m_limitFps;
+                break;
+        }
+    }
+
+    return true;
+}
+
+// Run a frame with the current inputs
+void EmulationThread::emulateFrame() {
+    auto startTime = std::chrono::steady_clock::now();
+    uint8_t input = m_input.load(std::memory_order_relaxed);
+
+    if (mp_movie != nullptr) {
+        mp_movie->beginFrame(m_emulator, input, 0x00);
+        m_emulator.runFrame();
+
+        if (!mp_movie->endFrame(m_emulator) && mp_movie->desyncs() == 1)
+            std::cerr << "Movie desync at frame " << mp_movie->firstDesync() << std::endl;
+    } else {
+        m_controllers.setButtons(0, input);
+        m_emulator.runFrame();
+    }
+
+    m_frameCount++;
+    m_frameMicroseconds += std::chrono::duration<double, std::micro>(
+        std::chrono::steady_clock::now() - startTime
+    ).count();
+}
+}
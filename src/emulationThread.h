@@ -0,0 +1,125 @@
+#ifndef EMULATION_THREAD_H_
+#define EMULATION_THREAD_H_
+
+#include "nesPch.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "nesCore/nesEmulator.h"
+#include "nesCore/movie.h"
+#include "nesCore/rewindBuffer.h"
+#include "nesCore/inputOutput/controllerIO.h"
+#include "nesCore/utility/spscRingBuffer.h"
+
+#include "sdl2/sdl2Audio.h"
+
+// Size of the command queue, the commands come from key presses
+#define EMULATION_COMMAND_QUEUE_SIZE 64
+
+namespace emulation {
+
+// Control commands sent by the main thread
+enum Command {
+    COMMAND_QUIT = 0,
+    // Pause or resume the emulation
+    COMMAND_PAUSE = 1,
+    COMMAND_RESET = 2,
+    // Run one frame or one instruction while paused
+    COMMAND_STEP_FRAME = 3,
+    COMMAND_STEP_INSTRUCTION = 4,
+    COMMAND_QUICK_SAVE = 5,
+    COMMAND_QUICK_LOAD = 6,
+    // Rewind while the key is held
+    COMMAND_REWIND_START = 7,
+    COMMAND_REWIND_STOP = 8,
+    COMMAND_TOGGLE_FRAME_LIMIT = 9,
+};
+
+// Run the emulator on its own thread
+//
+// The emulation thread own the emulator after start, it paces the frames with
+// the frame limiter or the audio device, the PPU publish every finished frame
+// in the triple-buffered frame buffer. The main thread only present the latest
+// frame and handle the events, the controller state is passed as an atomic
+// snapshot read once per frame and the other inputs as commands in a lock-free
+// queue. A slow present never stall the emulation, the frames it doesn't take
+// are skipped
+class EmulationThread {
+public:
+    EmulationThread(nesCore::NesEmulator& emulator);
+    ~EmulationThread();
+
+    // The thread point to this object
+    EmulationThread(const EmulationThread&) = delete;
+    EmulationThread& operator=(const EmulationThread&) = delete;
+
+    // Attach the optional components before the start, the audio
+    // is used by the rewind and the audio sync, nullptr disable them
+    void attachAudio(audio::Sdl2Audio* audio, bool audioSync);
+    void attachRewindBuffer(nesCore::RewindBuffer* rewind);
+    // Play or record a movie, the movie replace the controllers
+    void attachMovie(nesCore::Movie* movie);
+
+    // Start the emulation thread
+    void start();
+    // Wait for the thread to end after a quit command
+    void join();
+
+    // Main thread side
+    //
+    // Send a command, return false if the queue is full
+    bool sendCommand(Command command);
+    // Set the buttons of the first controller used by the next frames
+    void setInput(uint8_t buttons);
+
+    // Statistics, valid after the join
+    //
+    // Number of emulated frames and average host time of a frame in microseconds
+    uint64_t emulatedFrames();
+    double averageFrameMicroseconds();
+
+// Private methods
+private:
+    // Emulation thread loop
+    void run();
+    // Execute the queued commands, return false on quit
+    bool handleCommands();
+
+    // Run a frame with the current inputs
+    void emulateFrame();
+
+// Private member variables
+private:
+    std::thread m_thread;
+
+    nesCore::NesEmulator& m_emulator;
+    nesCore::ControllerIO m_controllers;
+
+    audio::Sdl2Audio* mp_audio;
+    nesCore::RewindBuffer* mp_rewind;
+    nesCore::Movie* mp_movie;
+
+    // Shared with the main thread
+    nesCore::utility::SpscRingBuffer<Command> m_commands;
+    std::atomic<uint8_t> m_input;
+
+    // Emulation thread state
+    bool m_running;
+    bool m_rewinding;
+    bool m_limitFps;
+    bool m_audioSync;
+    // Emulator max fps, values <= 0 means no limit
+    int m_emulationFps;
+
+    // Quick save slot
+    std::vector<uint8_t> m_quickState;
+
+    // Statistics
+    uint64_t m_frameCount;
+    double m_frameMicroseconds;
+};
+}
+
+#endif
@@ -0,0 +1,254 @@
+#include "nesPch.h"
+
+#include <argparse/argparse.hpp>
+
+#include "nesCore/nesEmulator.h"
+#include "nesCore/movie.h"
+#include "nesCore/inputOutput/dummyIO.h"
+#include "nesCore/inputOutput/scriptedIO.h"
+#include "nesCore/utility/utilityFunctions.h"
+
+// Emulator without display, audio or window system
+//
+// Run a ROM for a number of frames or CPU cycles, dump the frame hashes,
+// the frames as PPM images or the RAM, and report the emulation speed.
+// The inputs come from a script or a FM2 movie, a script can be recorded
+// as a movie and a movie is checked against its state hashes
+
+// NTSC frames per second, used to report the speed relative to the console
+#define HEADLESS_NTSC_FPS 60.0988
+
+int main(int argc, char *argv[]) {
+    // Parse commands line arguments
+    argparse::ArgumentParser argParser("nes_headless");
+
+    argParser.add_argument("romPath")
+        .help("specify the ROM file path");
+
+    argParser.add_argument("-p", "--palettes")
+        .default_value(std::string("resources/palettes/2C02G.pal"))
+        .help("specify the color palettes file");
+
+    argParser.add_argument("-f", "--frames")
+        .default_value(0ULL)
+        .action([](const std::string& value) { return std::stoull(value); })
+        .help("number of frames to run, 0 run the whole movie or 600 frames without movie");
+
+    argParser.add_argument("-c", "--cycles")
+        .default_value(0ULL)
+        .action([](const std::string& value) { return std::stoull(value); })
+        .help("number of CPU cycles to run, replace the number of frames if not 0");
+
+    argParser.add_argument("-i", "--input")
+        .default_value(std::string())
+        .help("input script, each line hold a frame and the RLDUTSBA buttons of the controllers");
+
+    argParser.add_argument("--movie")
+        .default_value(std::string())
+        .help("play the inputs of a FM2 movie and check its state hashes");
+
+    argParser.add_argument("--record-movie")
+        .default_value(std::string())
+        .help("record the inputs of the run to a FM2 movie with its state hashes");
+
+    argParser.add_argument("--frame-hashes")
+        .default_value(std::string())
+        .help("write the hash of every frame to the given file");
+
+    argParser.add_argument("--indexed")
+        .implicit_value(true)
+        .default_value(false)
+        .help("keep the palette indices of the frames without RGB conversion, the hashes are computed on the indices");
+
+    argParser.add_argument("--dump-frames")
+        .default_value(std::string())
+        .help("write the frames as PPM images in the given directory");
+
+    argParser.add_argument("--dump-every")
+        .default_value(1ULL)
+        .action([](const std::string& value) { return std::stoull(value); })
+        .help("number of frames between two dumped frames");
+
+    argParser.add_argument("--dump-ram")
+        .default_value(std::string())
+        .help("write the 2 KB of RAM at the end of the run to the given file");
+
+    try {
+        argParser.parse_args(argc, argv);
+    }
+    catch (const std::runtime_error& err) {
+        std::cerr << err.what() << std::endl;
+        std::cerr << argParser;
+        return 1;
+    }
+
+    uint64_t maxFrames = argParser.get<unsigned long long>("frames");
+    uint64_t maxCycles = argParser.get<unsigned long long>("cycles");
+    uint64_t dumpEvery = std::max(argParser.get<unsigned long long>("dump-every"), 1ULL);
+    std::string scriptPath = argParser.get("input");
+    std::string moviePath = argParser.get("movie");
+    std::string recordPath = argParser.get("record-movie");
+    std::string hashesPath = argParser.get("frame-hashes");
+    std::string framesPath = argParser.get("dump-frames");
+    std::string ramPath = argParser.get("dump-ram");
+    bool indexed = argParser.get<bool>("indexed");
+
+    if (!moviePath.empty() && (!recordPath.empty() || !scriptPath.empty())) {
+        std::cerr << "A movie can't be played with an input script or while recording" << std::endl;
+        return 1;
+    }
+
+    if (indexed && !framesPath.empty()) {
+        std::cerr << "The frames can't be dumped as PPM images with the indexed output" << std::endl;
+        return 1;
+    }
+
+    // Emulator initialization
+    nesCore::NesEmulator emulator;
+
+    int emuSetupError = emulator.setup(argParser.get("romPath"), argParser.get("palettes"));
+    if (emuSetupError != 0)
+        return emuSetupError;
+
+    if (indexed)
+        emulator.getFrameBuffer()->setFormat(nesCore::FRAME_INDEXED);
+
+    // Input setup, the controllers are released without a script
+    nesCore::DummyIO dummyIO;
+    nesCore::ScriptedIO scriptedIO;
+
+    if (!scriptPath.empty()) {
+        int scriptError = scriptedIO.loadScript(scriptPath);
+        if (scriptError != 0) {
+            std::cerr << "Failed to load the input script, error code: " << scriptError << std::endl;
+            return 2;
+        }
+
+        emulator.attachIO(&scriptedIO);
+    } else {
+        emulator.attachIO(&dummyIO);
+    }
+
+    // The movie replace the other inputs, the recorded one
+    // copy the buttons of the script
+    nesCore::Movie movie;
+
+    if (!moviePath.empty()) {
+        int movieError = movie.startPlayback(moviePath);
+        if (movieError != 0) {
+            std::cerr << "Failed to load the movie, error code: " << movieError << std::endl;
+            return 2;
+        }
+
+        emulator.attachIO(&movie);
+    } else if (!recordPath.empty()) {
+        movie.startRecording();
+        emulator.attachIO(&movie);
+    }
+
+    if (maxFrames == 0 && maxCycles == 0)
+        maxFrames = movie.mode() == nesCore::MOVIE_PLAYBACK ? movie.frames() : 600;
+
+    std::ofstream hashesFile;
+    if (!hashesPath.empty()) {
+        hashesFile.open(hashesPath);
+        if (!hashesFile.good()) {
+            std::cerr << "Failed to open the frame hashes file" << std::endl;
+            return 3;
+        }
+    }
+
+    // Emulator main loop
+    uint64_t frame = 0;
+    bool frameStart = true;
+
+    auto startTime = std::chrono::steady_clock::now();
+
+    while (maxCycles != 0 ? emulator.cpuDebugInfo().cpuCycle < maxCycles : frame < maxFrames) {
+        // Inputs of the frame
+        if (frameStart) {
+            scriptedIO.setFrame(frame);
+            movie.beginFrame(emulator, scriptedIO.buttons(0), scriptedIO.buttons(1));
+            frameStart = false;
+        }
+
+        if (maxCycles != 0) {
+            emulator.step();
+            if (!emulator.frameReady())
+                continue;
+        } else if (!nesCore::utility::runFrameOrHalt(emulator)) {
+            std::cerr << "The CPU halted at frame " << frame + 1 << std::endl;
+            return 3;
+        }
+
+        frame++;
+        frameStart = true;
+
+        if (!movie.endFrame(emulator) && movie.desyncs() == 1)
+            std::cerr << "Movie desync at frame " << movie.firstDesync() << std::endl;
+
+        if (hashesFile.is_open()) {
+            nesCore::FrameBuffer* frameBuffer = emulator.getFrameBuffer();
+            uint64_t hash = indexed ?
+                nesCore::utility::hashBytes(frameBuffer->indices(), nesCore::SCREEN_WIDTH * nesCore::SCREEN_HEIGHT) :
+                nesCore::utility::hashBytes(frameBuffer->data(), nesCore::SCREEN_WIDTH * nesCore::SCREEN_HEIGHT * 3);
+            hashesFile << frame << " " << std::hex << std::setw(16) << std::setfill('0');
+            hashesFile << hash << std::dec << "\n";
+        }
+
+        if (!framesPath.empty() && frame % dumpEvery == 0) {
+            std::stringstream filename;
+            filename << framesPath << "/frame" << std::setw(6) << std::setfill('0') << frame << ".ppm";
+
+            if (!nesCore::utility::writePpm(filename.str(), emulator.getFrameBuffer())) {
+                std::cerr << "Failed to write " << filename.str() << std::endl;
+                return 3;
+            }
+        }
+    }
+
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    uint64_t cycles = emulator.cpuDebugInfo().cpuCycle;
+
+    if (!ramPath.empty()) {
+        uint8_t ram[2048];
+        for (uint16_t addr = 0; addr < 2048; addr++)
+            ram[addr] = emulator.readMemory(addr);
+
+        std::ofstream ramFile(ramPath, std::ios_base::binary);
+        ramFile.write(reinterpret_cast<const char*>(ram), sizeof(ram));
+        if (!ramFile.good()) {
+            std::cerr << "Failed to write the RAM dump" << std::endl;
+            return 3;
+        }
+    }
+
+    if (!recordPath.empty()) {
+        std::string romPath = argParser.get("romPath");
+        if (movie.save(recordPath, romPath.substr(romPath.find_last_of("/\\") + 1)) != 0) {
+            std::cerr << "Failed to write the movie" << std::endl;
+            return 3;
+        }
+    }
+
+    // Report the emulation speed
+    double fps = elapsed > 0.0 ? frame / elapsed : 0.0;
+    std::cout << frame << " frames, " << cycles << " CPU cycles in ";
+    std::cout << std::fixed << std::setprecision(3) << elapsed << " s, ";
+    std::cout << std::setprecision(1) << fps << " fps (";
+    std::cout << std::setprecision(2) << fps / HEADLESS_NTSC_FPS << "x real time)" << std::endl;
+
+    // Report the movie desyncs
+    if (movie.mode() == nesCore::MOVIE_PLAYBACK) {
+        std::cout << "Movie: " << movie.frame() << " of " << movie.frames() << " frames played, ";
+        std::cout << movie.desyncs() << " desyncs";
+        if (movie.firstDesync() >= 0)
+            std::cout << ", first at frame " << movie.firstDesync();
+        std::cout << std::endl;
+
+        if (movie.desyncs() != 0)
+            return 4;
+    }
+
+    return 0;
+}
@@ -2,13 +2,16 @@
 
 #include <SDL2/SDL_events.h>
 #include <SDL2/SDL_keycode.h>
+#include <SDL2/SDL_timer.h>
 #include <bits/chrono.h>
 #include <chrono>
-#include <thread>
+#include <cmath>
 
 #include "nesCore/utility/utilityFunctions.h"
 #include "nesCore/inputOutput/IOInterface.h"
 #include "nesCore/nesEmulator.h"
+#include "nesCore/rewindBuffer.h"
+#include "nesCore/movie.h"
 #include "nesCore/cpu/cpu6502.h"
 
 #include "nesCore/cpu/cpu6502debug.h"
@@ -19,6 +22,7 @@
 #include "sdl2/sdl2Input.h"
 
 #include "argumentParser.h"
+#include "emulationThread.h"
 
 int main(int argc, char *argv[]) {
     // SDL2 initialization 
@@ -31,7 +35,7 @@ int main(int argc, char *argv[]) {
     AppOptions options = parseArguments(argc, argv);
  
     // Emulator initialization
-    nesCore::NesEmulator emulator = nesCore::NesEmulator();
+    nesCore::NesEmulator emulator;
 
     // Setup the emulator
     int emuSetupError = emulator.setup(
@@ -57,38 +61,76 @@ int main(int argc, char *argv[]) {
         return 3;
     }
 
-    display.attachFrameBuffer(emulator.getFrameBuffer());
+    // The frames are kept as palette indices and
+    // converted to RGB by the fragment shader
+    uint8_t palette[64 * 3];
+    emulator.getFrameBuffer()->getPalette(palette);
+    emulator.getFrameBuffer()->setFormat(nesCore::FRAME_INDEXED);
+    display.setPalette(palette);
 
     // Audio setup
-    audio::Sdl2Audio sdlAudio;
+    audio::Sdl2Audio sdlAudio(options.audioLatency, options.audioBufferSamples);
+    if (sdlAudio.sampleRate() != 0) {
+        emulator.setAudioSampleRate(sdlAudio.sampleRate());
+        emulator.attachAudioSink(&sdlAudio);
+    }
 
-    // Input setup
+    // Input setup, the gamepad state is sent to the emulation thread
     input::Sdl2Input sdlGamepad;
-    emulator.attachIO(&sdlGamepad);
 
-    // Emulator main loop
+    // Input movie, the emulator read the movie inputs instead of the gamepad
+    nesCore::Movie* p_movie = nullptr;
+    if (!options.recordPath.empty() || !options.playPath.empty()) {
+        p_movie = new nesCore::Movie();
+
+        if (!options.playPath.empty()) {
+            int movieError = p_movie->startPlayback(options.playPath);
+            if (movieError != 0) {
+                std::cerr << "Failed to load the movie, error code: " << movieError << std::endl;
+                delete p_movie;
+                return 6;
+            }
+        } else {
+            p_movie->startRecording();
+        }
+    }
+
+    // Validate the dynarec against the interpreter
+    if (options.dynarecDiff && emulator.enableDifferentialMode() != 0)
+        return 4;
+
+    // Show the frames ahead of the emulation to hide the input lag
+    if (options.runAhead > 0 && emulator.enableRunAhead(options.runAhead, options.runAheadInstance) != 0)
+        return 5;
+
+    // Rewind buffer, the previous frames are restored while backspace is held
+    nesCore::RewindBuffer* p_rewind = nullptr;
+    if (options.rewindMemory > 0)
+        p_rewind = new nesCore::RewindBuffer(static_cast<size_t>(options.rewindMemory) * 1024 * 1024);
+
+    // Emulation thread, the emulator is only used by the thread until the join.
+    // With the audio sync the frame limiter is replaced by the ring buffer fill
+    // level and the sample rate is nudged to keep it at the target latency
+    emulation::EmulationThread emulationThread(emulator);
+    emulationThread.attachAudio(sdlAudio.sampleRate() != 0 ? &sdlAudio : nullptr, options.audioSync);
+    emulationThread.attachRewindBuffer(p_rewind);
+    emulationThread.attachMovie(p_movie);
+    emulationThread.start();
+
+    // The PPU publish the frames from the emulation thread
+    nesCore::FrameBuffer* p_frameBuffer = emulator.getFrameBuffer();
+    uint64_t presentedSequence = 0;
+
+    // Main loop, present the frames and handle the events
     bool quit = false;
     bool runEmulation = true;
-    bool limitFps = true;
-    
-    // Emulator max fps, values <= 0 means no limit
-    int emulationFps = 60;
+
+    uint64_t presentedFrames = 0;
+    double presentMicroseconds = 0.0;
 
     SDL_Event event;
-    std::chrono::time_point<std::chrono::system_clock> frameTimer;
 
     while (!quit) {
-        // Start the frame timer
-        frameTimer = std::chrono::system_clock::now();
-
-        // Prepare a frame
-        while (!emulator.frameReady() && runEmulation) {
-            emulator.step();
-        }
-
-        // Update the display
-        display.update();
-    
         // Handle event in queue
         while (SDL_PollEvent(&event)) {
             // Set all event to the sdl gamepad implementation
@@ -103,6 +145,14 @@ int main(int argc, char *argv[]) {
                 }
             }
 
+            // Rewind while backspace is held
+            bool keyEvent = event.type == SDL_KEYDOWN || event.type == SDL_KEYUP;
+            if (keyEvent && event.key.keysym.sym == SDLK_BACKSPACE && event.key.repeat == 0) {
+                emulationThread.sendCommand(
+                    event.type == SDL_KEYDOWN ? emulation::COMMAND_REWIND_START : emulation::COMMAND_REWIND_STOP
+                );
+            }
+
             if (event.type == SDL_KEYDOWN) {
                 // Toggle window fullscreen
                 if (event.key.keysym.sym == SDLK_F11)
@@ -110,7 +160,7 @@ int main(int argc, char *argv[]) {
 
                 // Toggle frame limiter 
                 if (event.key.keysym.sym == SDLK_F8)
-                    limitFps = !limitFps;
+                    emulationThread.sendCommand(emulation::COMMAND_TOGGLE_FRAME_LIMIT);
 
                 // Toggle vsync
                 if (event.key.keysym.sym == SDLK_F10)
@@ -118,27 +168,27 @@ int main(int argc, char *argv[]) {
 
                 // Reset the emulator
                 if (event.key.keysym.sym == SDLK_F5)
-                    emulator.reset();
+                    emulationThread.sendCommand(emulation::COMMAND_RESET);
+
+                // Quick save and quick load
+                if (event.key.keysym.sym == SDLK_F2)
+                    emulationThread.sendCommand(emulation::COMMAND_QUICK_SAVE);
+
+                if (event.key.keysym.sym == SDLK_F4)
+                    emulationThread.sendCommand(emulation::COMMAND_QUICK_LOAD);
     
-                if (event.key.keysym.sym == SDLK_p)
+                if (event.key.keysym.sym == SDLK_p) {
                     runEmulation = !runEmulation;
+                    emulationThread.sendCommand(emulation::COMMAND_PAUSE);
+                }
 
                 // Render one frame
-                if (event.key.keysym.sym == SDLK_f && !runEmulation) {
-                    while (!emulator.frameReady()) {
-                        emulator.step();
-                    }
-                }
+                if (event.key.keysym.sym == SDLK_f && !runEmulation)
+                    emulationThread.sendCommand(emulation::COMMAND_STEP_FRAME);
 
                 // Run one emulator step and print debug info
-                if (event.key.keysym.sym == SDLK_t && !runEmulation) {
-                    emulator.step();
-
-                    nesCore::debug::Cpu6502Debug info = emulator.cpuDebugInfo(); 
-
-                    std::cout << info.log() << " -- ";
-                    std::cout << emulator.decompileInstruction(info.pc) << std::endl;
-                }
+                if (event.key.keysym.sym == SDLK_t && !runEmulation)
+                    emulationThread.sendCommand(emulation::COMMAND_STEP_INSTRUCTION);
             }
 
             // Handle quit event
@@ -146,16 +196,78 @@ int main(int argc, char *argv[]) {
                 quit = true;
         }
 
-        if (limitFps && emulationFps > 0) {
-            // Get the elapsed time and calculate the delay for the next frame
-            auto frameTime = std::chrono::microseconds(1'000'000 / emulationFps);
-            auto frameDelta = std::chrono::duration_cast<std::chrono::microseconds>(
-                frameTime - (std::chrono::system_clock::now() - frameTimer
-            ));
+        emulationThread.setInput(sdlGamepad.buttons());
+
+        // Present the latest frame, the frames finished since
+        // the last present are skipped
+        nesCore::FrameView frame = p_frameBuffer->latestFrame();
+        if (frame.sequence != presentedSequence) {
+            auto presentStart = std::chrono::steady_clock::now();
+            display.updateIndexed(frame.indices);
+            presentedSequence = frame.sequence;
+
+            presentedFrames++;
+            presentMicroseconds += std::chrono::duration<double, std::micro>(
+                std::chrono::steady_clock::now() - presentStart
+            ).count();
+        } else {
+            SDL_Delay(1);
+        }
+    }
+
+    emulationThread.sendCommand(emulation::COMMAND_QUIT);
+    emulationThread.join();
+
+    // Report the emulation and present times
+    std::cout << "Frame time: emulation " << emulationThread.averageFrameMicroseconds() / 1000.0;
+    std::cout << " ms for " << emulationThread.emulatedFrames() << " frames, present ";
+    std::cout << (presentedFrames != 0 ? presentMicroseconds / presentedFrames / 1000.0 : 0.0);
+    std::cout << " ms for " << presentedFrames << " frames" << std::endl;
+
+    // Report the audio glitches
+    if (sdlAudio.underruns() != 0 || sdlAudio.overruns() != 0) {
+        std::cout << "Audio underruns: " << sdlAudio.underruns();
+        std::cout << ", overruns: " << sdlAudio.overruns() << std::endl;
+    }
+
+    // Report the audio buffer stability
+    if (options.audioSync && sdlAudio.sampleRate() != 0) {
+        double msPerSample = 1000.0 / sdlAudio.sampleRate();
+        std::cout << "Audio buffer fill: mean " << sdlAudio.fillMean() * msPerSample;
+        std::cout << " ms, standard deviation ";
+        std::cout << std::sqrt(sdlAudio.fillVariance()) * msPerSample << " ms";
+        std::cout << " (variance " << sdlAudio.fillVariance() << " samples^2)" << std::endl;
+    }
+
+    // Report the host time added by the run-ahead
+    if (options.runAhead > 0) {
+        std::cout << "Run-ahead: " << options.runAhead << " frames, ";
+        std::cout << emulator.runAheadFrameMicroseconds() << " us added per frame" << std::endl;
+    }
 
-            // Sleep for the necessary amount of time
-            std::this_thread::sleep_for(frameDelta);
+    // Save the recorded movie and report the playback desyncs
+    if (p_movie != nullptr) {
+        if (p_movie->mode() == nesCore::MOVIE_RECORDING) {
+            std::string romName = options.romPath.substr(options.romPath.find_last_of("/\\") + 1);
+            if (p_movie->save(options.recordPath, romName) != 0)
+                std::cerr << "Failed to save the movie " << options.recordPath << std::endl;
+            else
+                std::cout << "Movie: " << p_movie->frames() << " frames recorded" << std::endl;
+        } else {
+            std::cout << "Movie: " << p_movie->frame() << " of " << p_movie->frames() << " frames played, ";
+            std::cout << p_movie->desyncs() << " desyncs";
+            if (p_movie->firstDesync() >= 0)
+                std::cout << ", first at frame " << p_movie->firstDesync();
+            std::cout << std::endl;
         }
+
+        delete p_movie;
+    }
+
+    // Report the rewind buffer usage
+    if (p_rewind != nullptr) {
+        std::cout << p_rewind->formatStats() << std::endl;
+        delete p_rewind;
     }
 
     display.quit();
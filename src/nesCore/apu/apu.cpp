@@ -1,60 +1,326 @@
 #include "nesPch.h"
 
 #include "nesCore/apu/apu.h"
+#include "nesCore/utility/stateBuffer.h"
 #include <cstdint>
 
 namespace nesCore {
-APU::APU() {
+// CPU cycles from a frame counter step to the next one in four
+// and five step mode, the first step happen 7457 cycles after a reset
+#define APU_FIRST_STEP_CYCLES 7457
 
+static const uint32_t s_fourStepCycles[4] = {7456, 7458, 7458, 7458};
+static const uint32_t s_fiveStepCycles[5] = {7456, 7458, 7458, 7452, 7458};
+
+APU::APU() : 
+    m_time(0), m_sampleRate(APU_DEFAULT_SAMPLE_RATE), mp_audioSink(nullptr),
+    m_outputEnabled(true), m_pulseOne(true), m_pulseTwo(false)
+{
+    m_buffer.setRates(APU_CPU_CLOCK_RATE, m_sampleRate, APU_MAX_FRAME_CYCLES);
+
+    // Power up state of the frame counter
+    m_fiveStepMode = false;
+    m_irqInhibit = false;
+
+    this->reset();
+}
+
+// Reset the channels and the frame counter
+void APU::reset() {
+    // Silence all the channels
+    m_pulseOne.setEnabled(false);
+    m_pulseTwo.setEnabled(false);
+    m_triangle.setEnabled(false);
+    m_noise.setEnabled(false);
+    m_dmc.setEnabled(false);
+    m_dmc.clearIrq();
+
+    m_frameIrq = false;
+    m_frameStep = 0;
+    m_frameStepCycles = APU_FIRST_STEP_CYCLES;
+
+    this->updateOutputs();
+
+    // Drop the pending cycles
+    m_pendingCycles = 0;
+    m_deadline = this->cpuCyclesToDeadline();
+}
+
+// Attach the bus used by the DMC to read the samples
+void APU::attachBus(Bus* bus) {
+    m_dmc.attachBus(bus);
+}
+
+// Attach the audio sink receiving the samples
+void APU::attachAudioSink(AudioSink* sink) {
+    this->sync();
+    this->flushSamples();
+
+    mp_audioSink = sink;
+}
+// Enable or disable the samples sent to the sink
+void APU::enableOutput(bool enable) {
+    this->sync();
+    this->flushSamples();
+
+    m_outputEnabled = enable;
+}
+
+// Set the output sample rate
+void APU::setSampleRate(uint32_t sampleRate) {
+    this->sync();
+    this->flushSamples();
+
+    m_sampleRate = sampleRate;
+    m_buffer.setRates(APU_CPU_CLOCK_RATE, m_sampleRate, APU_MAX_FRAME_CYCLES);
+}
+
+// Scale the sample rate by a ratio close to one
+void APU::setSampleRateRatio(double ratio) {
+    m_buffer.setRatio(ratio);
+}
+
+// Save the channels, the frame counter and the pending cycles
+void APU::saveState(utility::StateWriter& state) {
+    m_pulseOne.saveState(state);
+    m_pulseTwo.saveState(state);
+    m_triangle.saveState(state);
+    m_noise.saveState(state);
+    m_dmc.saveState(state);
+
+    state.write(m_fiveStepMode);
+    state.write(m_irqInhibit);
+    state.write(m_frameIrq);
+    state.write(m_frameStep);
+    state.write(m_frameStepCycles);
+
+    state.write(m_pendingCycles);
+    state.write(m_deadline);
+}
+// Restore the channels, the frame counter and the pending cycles
+void APU::loadState(utility::StateReader& state) {
+    // The buffer frame restart with the restored state,
+    // the channel level changes are added at its start
+    this->flushSamples();
+
+    m_pulseOne.loadState(state, m_buffer);
+    m_pulseTwo.loadState(state, m_buffer);
+    m_triangle.loadState(state, m_buffer);
+    m_noise.loadState(state, m_buffer);
+    m_dmc.loadState(state, m_buffer);
+
+    state.read(m_fiveStepMode);
+    state.read(m_irqInhibit);
+    state.read(m_frameIrq);
+    state.read(m_frameStep);
+    state.read(m_frameStepCycles);
+
+    state.read(m_pendingCycles);
+    state.read(m_deadline);
 }
 
 uint8_t APU::readRegister(uint16_t addr) {
-    // Pulse 1 channel
-    if (addr >= 0x4000 && addr <= 0x4003) 
-        return m_pulseOne[addr - 0x4000];
-    // Pulse 2 channel
-    else if (addr >= 0x4003 && addr <= 0x4007) 
-        return m_pulseTwo[addr - 0x4004];
-    // Triangle channel
-    else if (addr >= 0x4008 && addr <= 0x400B) 
-        return m_noise[addr - 0x4008];
-    // Noice channel
-    else if (addr >= 0x400C && addr <= 0x400F) 
-        return m_noise[addr - 0x400C];
-    // DMC channel
-    else if (addr >= 0x4010 && addr <= 0x4013) 
-        return m_DMC[addr - 0x4010];
+    // Only the status register can be read
+    if (addr != 0x4015)
+        return 0x00;
+
+    this->sync();
 
-    // Status register
-    else if (addr == 0x4015) 
-        return m_apuStatus;
+    uint8_t status = 0x00;
+    status |= m_pulseOne.active() ? 0x01 : 0x00;
+    status |= m_pulseTwo.active() ? 0x02 : 0x00;
+    status |= m_triangle.active() ? 0x04 : 0x00;
+    status |= m_noise.active() ? 0x08 : 0x00;
+    status |= m_dmc.active() ? 0x10 : 0x00;
+    status |= m_frameIrq ? 0x40 : 0x00;
+    status |= m_dmc.irq() ? 0x80 : 0x00;
 
-    // Default return value
-    return 0x00;
+    // Reading the status acknowledge the frame interrupt
+    m_frameIrq = false;
+
+    return status;
 }
 
 void APU::writeRegister(uint16_t addr, uint8_t data) {
+    // The write happen after the cycles already executed by the CPU
+    this->sync();
+
     // Pulse 1 channel
-    if (addr >= 0x4000 && addr <= 0x4003) 
-        m_pulseOne[addr - 0x4000] = data;
+    if (addr >= 0x4000 && addr <= 0x4003) {
+        m_pulseOne.writeRegister(addr - 0x4000, data);
+        m_pulseOne.updateOutput(m_buffer, m_time);
+    }
     // Pulse 2 channel
-    else if (addr >= 0x4003 && addr <= 0x4007) 
-        m_pulseTwo[addr - 0x4004] = data;
+    else if (addr >= 0x4004 && addr <= 0x4007) {
+        m_pulseTwo.writeRegister(addr - 0x4004, data);
+        m_pulseTwo.updateOutput(m_buffer, m_time);
+    }
     // Triangle channel
     else if (addr >= 0x4008 && addr <= 0x400B) 
-        m_noise[addr - 0x4008] = data;
-    // Noice channel
-    else if (addr >= 0x400C && addr <= 0x400F) 
-        m_noise[addr - 0x400C] = data;
+        m_triangle.writeRegister(addr - 0x4008, data);
+    // Noise channel
+    else if (addr >= 0x400C && addr <= 0x400F) {
+        m_noise.writeRegister(addr - 0x400C, data);
+        m_noise.updateOutput(m_buffer, m_time);
+    }
     // DMC channel
     else if (addr >= 0x4010 && addr <= 0x4013) 
-        m_DMC[addr - 0x4010] = data;
-
-    // Status register
-    else if (addr == 0x4015) 
-        m_apuStatus = data;
-    // Frame counter
-    else if (addr == 0x4017) 
-        m_frameCounter = data;
+        m_dmc.writeRegister(addr - 0x4010, data, m_buffer, m_time);
+
+    // Status register, enable the channels
+    else if (addr == 0x4015) {
+        m_pulseOne.setEnabled(data & 0x01);
+        m_pulseTwo.setEnabled(data & 0x02);
+        m_triangle.setEnabled(data & 0x04);
+        m_noise.setEnabled(data & 0x08);
+        m_dmc.setEnabled(data & 0x10);
+        m_dmc.clearIrq();
+
+        this->updateOutputs();
+    }
+    // Frame counter, restart the sequence
+    else if (addr == 0x4017) {
+        m_fiveStepMode = data & 0x80;
+        m_irqInhibit = data & 0x40;
+
+        if (m_irqInhibit)
+            m_frameIrq = false;
+
+        this->flushSamples();
+        m_frameStep = 0;
+        m_frameStepCycles = APU_FIRST_STEP_CYCLES;
+
+        // The five step mode clock the units immediately
+        if (m_fiveStepMode) {
+            this->clockQuarterFrame();
+            this->clockHalfFrame();
+            this->updateOutputs();
+        }
+    }
+
+    // The write can move the next interrupt
+    m_deadline = this->cpuCyclesToDeadline();
+}
+
+// Add the CPU cycles to the pending cycles and run the APU at the deadline
+Interrupt6502 APU::run(size_t cpuCycle) {
+    m_pendingCycles += cpuCycle;
+
+    if (m_pendingCycles >= m_deadline)
+        this->catchUp();
+
+    return m_frameIrq || m_dmc.irq() ? IRQ : NOINT;
+}
+
+// Execute the pending cycles
+void APU::sync() {
+    if (m_pendingCycles != 0)
+        this->catchUp();
+}
+
+// Execute the pending cycles and set the next deadline
+void APU::catchUp() {
+    this->runCycles(m_pendingCycles);
+
+    m_pendingCycles = 0;
+    m_deadline = this->cpuCyclesToDeadline();
+}
+
+// Return the number of CPU cycles the CPU can run before the APU must catch up
+size_t APU::cpuCyclesToDeadline() {
+    // The frame interrupt is raised by a frame counter step and the DMC
+    // interrupt is raised by the fetch processed before the returned cycle
+    uint64_t deadline = m_frameStepCycles;
+    uint64_t dmcIrq = m_dmc.cyclesToIrq();
+    if (dmcIrq < deadline)
+        deadline = dmcIrq + 1;
+
+    return deadline > m_pendingCycles ? deadline - m_pendingCycles : 0;
+}
+
+// Run the channels and the frame counter for the given CPU cycles
+void APU::runCycles(size_t cycles) {
+    while (cycles > 0) {
+        uint32_t chunk = std::min<size_t>(cycles, m_frameStepCycles);
+        uint32_t endTime = m_time + chunk;
+
+        m_pulseOne.run(m_buffer, m_time, endTime);
+        m_pulseTwo.run(m_buffer, m_time, endTime);
+        m_triangle.run(m_buffer, m_time, endTime);
+        m_noise.run(m_buffer, m_time, endTime);
+        m_dmc.run(m_buffer, m_time, endTime);
+
+        m_time = endTime;
+        cycles -= chunk;
+        m_frameStepCycles -= chunk;
+
+        if (m_frameStepCycles == 0)
+            this->clockFrameCounter();
+    }
+}
+
+// Execute the frame counter step and send the samples to the sink
+void APU::clockFrameCounter() {
+    if (!m_fiveStepMode) {
+        // Quarter frame on every step, half frame and interrupt on the second and last
+        this->clockQuarterFrame();
+
+        if (m_frameStep == 1 || m_frameStep == 3)
+            this->clockHalfFrame();
+
+        if (m_frameStep == 3 && !m_irqInhibit)
+            m_frameIrq = true;
+
+        m_frameStepCycles = s_fourStepCycles[m_frameStep];
+        m_frameStep = (m_frameStep + 1) % 4;
+    } else {
+        // The fourth step doesn't clock anything and there is no interrupt
+        if (m_frameStep != 3)
+            this->clockQuarterFrame();
+
+        if (m_frameStep == 1 || m_frameStep == 4)
+            this->clockHalfFrame();
+
+        m_frameStepCycles = s_fiveStepCycles[m_frameStep];
+        m_frameStep = (m_frameStep + 1) % 5;
+    }
+
+    this->updateOutputs();
+    this->flushSamples();
+}
+
+void APU::clockQuarterFrame() {
+    m_pulseOne.clockQuarterFrame();
+    m_pulseTwo.clockQuarterFrame();
+    m_triangle.clockQuarterFrame();
+    m_noise.clockQuarterFrame();
+}
+void APU::clockHalfFrame() {
+    m_pulseOne.clockHalfFrame();
+    m_pulseTwo.clockHalfFrame();
+    m_triangle.clockHalfFrame();
+    m_noise.clockHalfFrame();
+}
+
+// Update the channels output after a change of their volume
+void APU::updateOutputs() {
+    m_pulseOne.updateOutput(m_buffer, m_time);
+    m_pulseTwo.updateOutput(m_buffer, m_time);
+    m_noise.updateOutput(m_buffer, m_time);
+}
+
+// End the buffer frame and send the samples to the sink
+void APU::flushSamples() {
+    m_buffer.endFrame(m_time);
+    m_time = 0;
+
+    // The samples are read in small blocks to keep them on the stack
+    int16_t samples[256];
+    size_t count;
+
+    while ((count = m_buffer.readSamples(samples, 256)) != 0) {
+        if (mp_audioSink != nullptr && m_outputEnabled)
+            mp_audioSink->pushSamples(samples, count);
+    }
 }
 }
@@ -1,29 +1,109 @@
-
 #ifndef APU_H_
 #define APU_H_
 
 #include "nesPch.h"
-#include <cstdint>
+
+#include "apuChannels.h"
+#include "audioSink.h"
+#include "bandLimitedBuffer.h"
+#include "nesCore/cpu/cpu6502.h"
+
+// NTSC CPU clock rate in Hz
+#define APU_CPU_CLOCK_RATE 1789773
+// Default output sample rate in Hz
+#define APU_DEFAULT_SAMPLE_RATE 44100
+// Longest interval between two frame counter steps in CPU cycles,
+// the samples are sent to the audio sink at every step
+#define APU_MAX_FRAME_CYCLES 7458
 
 namespace nesCore {
+class Bus;
+
 class APU {
 public:
     APU();
 
+    // Reset the channels and the frame counter
+    void reset();
+
+    // Attach the bus used by the DMC to read the samples
+    void attachBus(Bus* bus);
+    // Attach the audio sink receiving the samples, nullptr drop the samples
+    void attachAudioSink(AudioSink* sink);
+    // Enable or disable the samples sent to the sink, the samples
+    // synthesized while disabled are dropped
+    void enableOutput(bool enable);
+    // Set the output sample rate, the samples are band-limited to its half
+    void setSampleRate(uint32_t sampleRate);
+    // Scale the sample rate by a ratio close to one, to follow the
+    // consumer clock without changing the pitch audibly
+    void setSampleRateRatio(double ratio);
+
     // Register read and write operation
     uint8_t readRegister(uint16_t addr);
     void writeRegister(uint16_t addr, uint8_t data);
 
+    // Add the CPU cycles to the pending cycles and run the APU at the deadline,
+    // return the state of the IRQ line
+    Interrupt6502 run(size_t cpuCycle);
+    // Execute the pending cycles
+    void sync();
+
+    // Return the number of CPU cycles the CPU can run before the APU
+    // must catch up, the IRQ line can only change at the deadline
+    size_t cpuCyclesToDeadline();
+
+    // Save and restore the channels and the frame counter, the pending
+    // cycles are saved without running them. The samples of the current
+    // timeline are sent to the sink before loading a state
+    void saveState(utility::StateWriter& state);
+    void loadState(utility::StateReader& state);
+
+// Private methods
 private:
-    uint8_t m_apuStatus;
-    uint8_t m_frameCounter;
-
-    // Channels registers
-    uint8_t m_pulseOne[4];
-    uint8_t m_pulseTwo[4];
-    uint8_t m_triangle[4];
-    uint8_t m_noise[4];
-    uint8_t m_DMC[4];
+    // Execute the pending cycles and set the next deadline
+    void catchUp();
+    // Run the channels and the frame counter for the given CPU cycles
+    void runCycles(size_t cycles);
+    // Execute the frame counter step and send the samples to the sink
+    void clockFrameCounter();
+    void clockQuarterFrame();
+    void clockHalfFrame();
+
+    // Update the channels output after a change of their volume
+    void updateOutputs();
+    // End the buffer frame and send the samples to the sink
+    void flushSamples();
+
+// Private member variable
+private:
+    // Output buffer and the cycle of the current buffer frame
+    BandLimitedBuffer m_buffer;
+    uint32_t m_time;
+    uint32_t m_sampleRate;
+
+    AudioSink* mp_audioSink;
+    bool m_outputEnabled;
+
+    // Channels
+    PulseChannel m_pulseOne;
+    PulseChannel m_pulseTwo;
+    TriangleChannel m_triangle;
+    NoiseChannel m_noise;
+    DmcChannel m_dmc;
+
+    // Frame counter
+    bool m_fiveStepMode;
+    bool m_irqInhibit;
+    bool m_frameIrq;
+
+    uint8_t m_frameStep;
+    uint32_t m_frameStepCycles;
+
+    // CPU cycles executed by the CPU but not yet by the APU,
+    // always lower than the deadline
+    size_t m_pendingCycles;
+    size_t m_deadline;
 };
 }
 
@@ -0,0 +1,706 @@
+#include "nesPch.h"
+
+#include "apuChannels.h"
+#include "nesCore/cpuBus.h"
+#include "nesCore/utility/stateBuffer.h"
+
+namespace nesCore {
+// Length counter load values
+static const uint8_t s_lengthTable[32] = {
+    10, 254, 20,  2, 40,  4, 80,  6, 160,  8, 60, 10, 14, 12, 26, 14,
+    12,  16, 24, 18, 48, 20, 96, 22, 192, 24, 72, 26, 16, 28, 32, 30,
+};
+
+// Pulse waveforms for each duty cycle
+static const uint8_t s_dutyTable[4][8] = {
+    {0, 1, 0, 0, 0, 0, 0, 0},
+    {0, 1, 1, 0, 0, 0, 0, 0},
+    {0, 1, 1, 1, 1, 0, 0, 0},
+    {1, 0, 0, 1, 1, 1, 1, 1},
+};
+
+// Noise timer periods in CPU cycles (NTSC)
+static const uint16_t s_noisePeriods[16] = {
+    4, 8, 16, 32, 64, 96, 128, 160, 202, 254, 380, 508, 762, 1016, 2034, 4068,
+};
+
+// DMC timer periods in CPU cycles (NTSC)
+static const uint16_t s_dmcPeriods[16] = {
+    428, 380, 340, 320, 286, 254, 226, 214, 190, 160, 142, 128, 106, 84, 72, 54,
+};
+
+// Number of timer events from the given time to the end time
+static inline uint32_t eventsBefore(uint32_t time, uint32_t endTime, uint32_t period) {
+    return time < endTime ? (endTime - time - 1) / period + 1 : 0;
+}
+
+/*
+ *
+ *  Envelope
+ *
+ */
+
+// Save the output level and the timer
+void ApuChannel::saveState(utility::StateWriter& state) {
+    state.write(m_level);
+    state.write(m_timer);
+}
+// Restore the output level and the timer
+void ApuChannel::loadState(utility::StateReader& state, BandLimitedBuffer& buffer) {
+    uint8_t level = m_level;
+    state.read(level);
+    state.read(m_timer);
+
+    this->setLevel(buffer, 0, level);
+}
+
+void ApuEnvelope::reset() {
+    start = false;
+    loop = false;
+    constant = false;
+
+    period = 0;
+    divider = 0;
+    decay = 0;
+}
+
+// Clocked by the quarter frames
+void ApuEnvelope::clock() {
+    if (start) {
+        start = false;
+        decay = 15;
+        divider = period;
+    } else if (divider == 0) {
+        divider = period;
+
+        if (decay > 0)
+            decay--;
+        else if (loop)
+            decay = 15;
+    } else {
+        divider--;
+    }
+}
+
+/*
+ *
+ *  Pulse channels
+ *
+ */
+
+PulseChannel::PulseChannel(bool onesComplement) :
+    ApuChannel(APU_PULSE_WEIGHT), m_onesComplement(onesComplement)
+{
+    this->reset();
+}
+
+void PulseChannel::reset() {
+    m_enabled = false;
+
+    m_duty = 0;
+    m_sequencer = 0;
+    m_period = 0;
+    m_length = 0;
+    m_lengthHalt = false;
+
+    m_envelope.reset();
+
+    m_sweepEnabled = false;
+    m_sweepNegate = false;
+    m_sweepReload = false;
+    m_sweepPeriod = 0;
+    m_sweepShift = 0;
+    m_sweepDivider = 0;
+}
+
+void PulseChannel::writeRegister(uint8_t reg, uint8_t data) {
+    switch (reg) {
+        case 0:
+            m_duty = data >> 6;
+            m_lengthHalt = data & 0x20;
+            m_envelope.loop = data & 0x20;
+            m_envelope.constant = data & 0x10;
+            m_envelope.period = data & 0x0F;
+            break;
+
+        case 1:
+            m_sweepEnabled = data & 0x80;
+            m_sweepPeriod = (data >> 4) & 0x07;
+            m_sweepNegate = data & 0x08;
+            m_sweepShift = data & 0x07;
+            m_sweepReload = true;
+            break;
+
+        case 2:
+            m_period = (m_period & 0x0700) | data;
+            break;
+
+        case 3:
+            m_period = (m_period & 0x00FF) | (static_cast<uint16_t>(data & 0x07) << 8);
+
+            if (m_enabled)
+                m_length = s_lengthTable[data >> 3];
+
+            // Restart the waveform and the envelope
+            m_sequencer = 0;
+            m_envelope.start = true;
+            break;
+    }
+}
+
+void PulseChannel::setEnabled(bool enabled) {
+    m_enabled = enabled;
+
+    if (!enabled)
+        m_length = 0;
+}
+
+// Save the channel registers and counters
+void PulseChannel::saveState(utility::StateWriter& state) {
+    ApuChannel::saveState(state);
+
+    state.write(m_enabled);
+    state.write(m_duty);
+    state.write(m_sequencer);
+    state.write(m_period);
+    state.write(m_length);
+    state.write(m_lengthHalt);
+    state.write(m_envelope);
+    state.write(m_sweepEnabled);
+    state.write(m_sweepNegate);
+    state.write(m_sweepReload);
+    state.write(m_sweepPeriod);
+    state.write(m_sweepShift);
+    state.write(m_sweepDivider);
+}
+// Restore the channel registers and counters
+void PulseChannel::loadState(utility::StateReader& state, BandLimitedBuffer& buffer) {
+    ApuChannel::loadState(state, buffer);
+
+    state.read(m_enabled);
+    state.read(m_duty);
+    state.read(m_sequencer);
+    state.read(m_period);
+    state.read(m_length);
+    state.read(m_lengthHalt);
+    state.read(m_envelope);
+    state.read(m_sweepEnabled);
+    state.read(m_sweepNegate);
+    state.read(m_sweepReload);
+    state.read(m_sweepPeriod);
+    state.read(m_sweepShift);
+    state.read(m_sweepDivider);
+}
+
+// Return the timer period target of the sweep unit
+uint16_t PulseChannel::sweepTarget() {
+    int change = m_period >> m_sweepShift;
+
+    if (m_sweepNegate) {
+        int target = m_period - change - (m_onesComplement ? 1 : 0);
+        return target < 0 ? 0 : target;
+    }
+
+    return m_period + change;
+}
+
+// Return true if the channel output can be different from zero
+inline bool PulseChannel::audible() {
+    // Periods too short or that overflow the sweep unit mute the channel
+    return m_length != 0 && m_envelope.volume() != 0 &&
+        m_period >= 8 && this->sweepTarget() <= 0x07FF;
+}
+
+// Return the output volume at the current sequencer step
+inline uint8_t PulseChannel::output() {
+    if (!this->audible())
+        return 0;
+
+    return s_dutyTable[m_duty][m_sequencer] ? m_envelope.volume() : 0;
+}
+
+// Frame counter clocks
+void PulseChannel::clockQuarterFrame() {
+    m_envelope.clock();
+}
+void PulseChannel::clockHalfFrame() {
+    if (!m_lengthHalt && m_length > 0)
+        m_length--;
+
+    // Sweep unit
+    uint16_t target = this->sweepTarget();
+    bool muted = m_period < 8 || target > 0x07FF;
+
+    if (m_sweepDivider == 0 && m_sweepEnabled && m_sweepShift > 0 && !muted)
+        m_period = target;
+
+    if (m_sweepDivider == 0 || m_sweepReload) {
+        m_sweepDivider = m_sweepPeriod;
+        m_sweepReload = false;
+    } else {
+        m_sweepDivider--;
+    }
+}
+
+// Run the channel from the given time to the end time
+void PulseChannel::run(BandLimitedBuffer& buffer, uint32_t time, uint32_t endTime) {
+    // The sequencer is clocked every two CPU cycles
+    uint32_t period = (static_cast<uint32_t>(m_period) + 1) * 2;
+    time += m_timer;
+
+    if (!this->audible()) {
+        // The output can't change, only advance the sequencer
+        uint32_t events = eventsBefore(time, endTime, period);
+        m_sequencer = (m_sequencer + events) & 0x07;
+        time += events * period;
+    } else {
+        uint8_t volume = m_envelope.volume();
+
+        while (time < endTime) {
+            m_sequencer = (m_sequencer + 1) & 0x07;
+            this->setLevel(buffer, time, s_dutyTable[m_duty][m_sequencer] ? volume : 0);
+
+            time += period;
+        }
+    }
+
+    m_timer = time - endTime;
+}
+
+// Update the output after a register write or a frame counter clock
+void PulseChannel::updateOutput(BandLimitedBuffer& buffer, uint32_t time) {
+    this->setLevel(buffer, time, this->output());
+}
+
+/*
+ *
+ *  Triangle channel
+ *
+ */
+
+TriangleChannel::TriangleChannel() : ApuChannel(APU_TRIANGLE_WEIGHT) {
+    this->reset();
+}
+
+void TriangleChannel::reset() {
+    m_enabled = false;
+
+    m_sequencer = 0;
+    m_period = 0;
+    m_length = 0;
+    m_control = false;
+
+    m_linearReload = 0;
+    m_linearCounter = 0;
+    m_linearReloadFlag = false;
+}
+
+void TriangleChannel::writeRegister(uint8_t reg, uint8_t data) {
+    switch (reg) {
+        case 0:
+            m_control = data & 0x80;
+            m_linearReload = data & 0x7F;
+            break;
+
+        case 2:
+            m_period = (m_period & 0x0700) | data;
+            break;
+
+        case 3:
+            m_period = (m_period & 0x00FF) | (static_cast<uint16_t>(data & 0x07) << 8);
+
+            if (m_enabled)
+                m_length = s_lengthTable[data >> 3];
+
+            m_linearReloadFlag = true;
+            break;
+    }
+}
+
+void TriangleChannel::setEnabled(bool enabled) {
+    m_enabled = enabled;
+
+    if (!enabled)
+        m_length = 0;
+}
+
+// Save the channel registers and counters
+void TriangleChannel::saveState(utility::StateWriter& state) {
+    ApuChannel::saveState(state);
+
+    state.write(m_enabled);
+    state.write(m_sequencer);
+    state.write(m_period);
+    state.write(m_length);
+    state.write(m_control);
+    state.write(m_linearReload);
+    state.write(m_linearCounter);
+    state.write(m_linearReloadFlag);
+}
+// Restore the channel registers and counters
+void TriangleChannel::loadState(utility::StateReader& state, BandLimitedBuffer& buffer) {
+    ApuChannel::loadState(state, buffer);
+
+    state.read(m_enabled);
+    state.read(m_sequencer);
+    state.read(m_period);
+    state.read(m_length);
+    state.read(m_control);
+    state.read(m_linearReload);
+    state.read(m_linearCounter);
+    state.read(m_linearReloadFlag);
+}
+
+// Frame counter clocks
+void TriangleChannel::clockQuarterFrame() {
+    if (m_linearReloadFlag)
+        m_linearCounter = m_linearReload;
+    else if (m_linearCounter > 0)
+        m_linearCounter--;
+
+    if (!m_control)
+        m_linearReloadFlag = false;
+}
+void TriangleChannel::clockHalfFrame() {
+    if (!m_control && m_length > 0)
+        m_length--;
+}
+
+// Run the channel from the given time to the end time
+void TriangleChannel::run(BandLimitedBuffer& buffer, uint32_t time, uint32_t endTime) {
+    // The sequencer is clocked every CPU cycle
+    uint32_t period = static_cast<uint32_t>(m_period) + 1;
+    time += m_timer;
+
+    // The sequencer is halted by the counters, ultrasonic
+    // periods are not played to avoid aliasing and save time
+    if (m_length == 0 || m_linearCounter == 0 || m_period < 2) {
+        time += eventsBefore(time, endTime, period) * period;
+    } else {
+        while (time < endTime) {
+            m_sequencer = (m_sequencer + 1) & 0x1F;
+
+            // 15 to 0 and then 0 to 15
+            uint8_t level = m_sequencer < 16 ? 15 - m_sequencer : m_sequencer - 16;
+            this->setLevel(buffer, time, level);
+
+            time += period;
+        }
+    }
+
+    m_timer = time - endTime;
+}
+
+/*
+ *
+ *  Noise channel
+ *
+ */
+
+NoiseChannel::NoiseChannel() : ApuChannel(APU_NOISE_WEIGHT) {
+    this->reset();
+}
+
+void NoiseChannel::reset() {
+    m_enabled = false;
+
+    m_shift = 0x0001;
+    m_shortMode = false;
+    m_period = s_noisePeriods[0];
+    m_length = 0;
+    m_lengthHalt = false;
+
+    m_envelope.reset();
+}
+
+void NoiseChannel::writeRegister(uint8_t reg, uint8_t data) {
+    switch (reg) {
+        case 0:
+            m_lengthHalt = data & 0x20;
+            m_envelope.loop = data & 0x20;
+            m_envelope.constant = data & 0x10;
+            m_envelope.period = data & 0x0F;
+            break;
+
+        case 2:
+            m_shortMode = data & 0x80;
+            m_period = s_noisePeriods[data & 0x0F];
+            break;
+
+        case 3:
+            if (m_enabled)
+                m_length = s_lengthTable[data >> 3];
+
+            m_envelope.start = true;
+            break;
+    }
+}
+
+void NoiseChannel::setEnabled(bool enabled) {
+    m_enabled = enabled;
+
+    if (!enabled)
+        m_length = 0;
+}
+
+// Save the channel registers and counters
+void NoiseChannel::saveState(utility::StateWriter& state) {
+    ApuChannel::saveState(state);
+
+    state.write(m_enabled);
+    state.write(m_shift);
+    state.write(m_shortMode);
+    state.write(m_period);
+    state.write(m_length);
+    state.write(m_lengthHalt);
+    state.write(m_envelope);
+}
+// Restore the channel registers and counters
+void NoiseChannel::loadState(utility::StateReader& state, BandLimitedBuffer& buffer) {
+    ApuChannel::loadState(state, buffer);
+
+    state.read(m_enabled);
+    state.read(m_shift);
+    state.read(m_shortMode);
+    state.read(m_period);
+    state.read(m_length);
+    state.read(m_lengthHalt);
+    state.read(m_envelope);
+}
+
+// Return the output volume for the current shift register
+inline uint8_t NoiseChannel::output() {
+    if (m_length == 0 || (m_shift & 0x0001) != 0)
+        return 0;
+
+    return m_envelope.volume();
+}
+
+// Frame counter clocks
+void NoiseChannel::clockQuarterFrame() {
+    m_envelope.clock();
+}
+void NoiseChannel::clockHalfFrame() {
+    if (!m_lengthHalt && m_length > 0)
+        m_length--;
+}
+
+// Run the channel from the given time to the end time
+void NoiseChannel::run(BandLimitedBuffer& buffer, uint32_t time, uint32_t endTime) {
+    time += m_timer;
+
+    // The shift register is always clocked,
+    // the output is only updated if it can change
+    bool audible = m_length != 0 && m_envelope.volume() != 0;
+    uint8_t tap = m_shortMode ? 6 : 1;
+
+    while (time < endTime) {
+        uint16_t feedback = (m_shift ^ (m_shift >> tap)) & 0x0001;
+        m_shift = (m_shift >> 1) | (feedback << 14);
+
+        if (audible)
+            this->setLevel(buffer, time, this->output());
+
+        time += m_period;
+    }
+
+    m_timer = time - endTime;
+}
+
+// Update the output after a register write or a frame counter clock
+void NoiseChannel::updateOutput(BandLimitedBuffer& buffer, uint32_t time) {
+    this->setLevel(buffer, time, this->output());
+}
+
+/*
+ *
+ *  Delta modulation channel
+ *
+ */
+
+DmcChannel::DmcChannel() : ApuChannel(APU_DMC_WEIGHT), mp_bus(nullptr) {
+    this->reset();
+}
+
+// Attach the bus used to read the samples
+void DmcChannel::attachBus(Bus* bus) {
+    mp_bus = bus;
+}
+
+void DmcChannel::reset() {
+    m_irqEnabled = false;
+    m_loop = false;
+    m_irq = false;
+    m_period = s_dmcPeriods[0];
+
+    m_sampleAddr = 0xC000;
+    m_sampleLength = 1;
+    m_currentAddr = 0xC000;
+    m_bytesRemaining = 0;
+
+    m_sampleBuffer = 0x00;
+    m_sampleBufferEmpty = true;
+
+    m_shift = 0x00;
+    m_bitsRemaining = 8;
+    m_silence = true;
+}
+
+void DmcChannel::writeRegister(uint8_t reg, uint8_t data, BandLimitedBuffer& buffer, uint32_t time) {
+    switch (reg) {
+        case 0:
+            m_irqEnabled = data & 0x80;
+            m_loop = data & 0x40;
+            m_period = s_dmcPeriods[data & 0x0F];
+
+            if (!m_irqEnabled)
+                m_irq = false;
+            break;
+
+        // Direct load of the output level
+        case 1:
+            this->setLevel(buffer, time, data & 0x7F);
+            break;
+
+        case 2:
+            m_sampleAddr = 0xC000 | (static_cast<uint16_t>(data) << 6);
+            break;
+
+        case 3:
+            m_sampleLength = (static_cast<uint16_t>(data) << 4) | 0x0001;
+            break;
+    }
+}
+
+void DmcChannel::setEnabled(bool enabled) {
+    if (!enabled) {
+        m_bytesRemaining = 0;
+        return;
+    }
+
+    // Restart the sample if it ended
+    if (m_bytesRemaining == 0) {
+        m_currentAddr = m_sampleAddr;
+        m_bytesRemaining = m_sampleLength;
+        this->fetchSample();
+    }
+}
+
+// Save the channel registers and counters
+void DmcChannel::saveState(utility::StateWriter& state) {
+    ApuChannel::saveState(state);
+
+    state.write(m_irqEnabled);
+    state.write(m_loop);
+    state.write(m_irq);
+    state.write(m_period);
+    state.write(m_sampleAddr);
+    state.write(m_sampleLength);
+    state.write(m_currentAddr);
+    state.write(m_bytesRemaining);
+    state.write(m_sampleBuffer);
+    state.write(m_sampleBufferEmpty);
+    state.write(m_shift);
+    state.write(m_bitsRemaining);
+    state.write(m_silence);
+}
+// Restore the channel registers and counters
+void DmcChannel::loadState(utility::StateReader& state, BandLimitedBuffer& buffer) {
+    ApuChannel::loadState(state, buffer);
+
+    state.read(m_irqEnabled);
+    state.read(m_loop);
+    state.read(m_irq);
+    state.read(m_period);
+    state.read(m_sampleAddr);
+    state.read(m_sampleLength);
+    state.read(m_currentAddr);
+    state.read(m_bytesRemaining);
+    state.read(m_sampleBuffer);
+    state.read(m_sampleBufferEmpty);
+    state.read(m_shift);
+    state.read(m_bitsRemaining);
+    state.read(m_silence);
+}
+
+// Return the number of CPU cycles before the interrupt flag can be set
+uint64_t DmcChannel::cyclesToIrq() {
+    if (!m_irqEnabled || m_loop || m_bytesRemaining == 0)
+        return UINT64_MAX;
+
+    // The sample buffer is full, the next byte is read when the
+    // current output cycle ends and then one byte every 8 clocks
+    uint64_t nextFetch = m_timer + static_cast<uint64_t>(m_bitsRemaining - 1) * m_period;
+    return nextFetch + static_cast<uint64_t>(m_bytesRemaining - 1) * 8 * m_period;
+}
+
+// Fill the sample buffer if it's empty and sample bytes remain
+void DmcChannel::fetchSample() {
+    if (!m_sampleBufferEmpty || m_bytesRemaining == 0)
+        return;
+
+    // The CPU stall of the DMA read is not emulated
+    m_sampleBuffer = mp_bus != nullptr ? mp_bus->read(m_currentAddr, true) : 0x00;
+    m_sampleBufferEmpty = false;
+
+    m_currentAddr = m_currentAddr == 0xFFFF ? 0x8000 : m_currentAddr + 1;
+    m_bytesRemaining--;
+
+    if (m_bytesRemaining == 0) {
+        if (m_loop) {
+            m_currentAddr = m_sampleAddr;
+            m_bytesRemaining = m_sampleLength;
+        } else if (m_irqEnabled) {
+            m_irq = true;
+        }
+    }
+}
+
+// Clock the output unit
+inline void DmcChannel::clockOutput(BandLimitedBuffer& buffer, uint32_t time) {
+    if (!m_silence) {
+        if (m_shift & 0x01) {
+            if (m_level <= 125)
+                this->setLevel(buffer, time, m_level + 2);
+        } else if (m_level >= 2) {
+            this->setLevel(buffer, time, m_level - 2);
+        }
+    }
+
+    m_shift >>= 1;
+
+    // Start a new output cycle with the sample buffer
+    if (--m_bitsRemaining == 0) {
+        m_bitsRemaining = 8;
+
+        if (m_sampleBufferEmpty) {
+            m_silence = true;
+        } else {
+            m_silence = false;
+            m_shift = m_sampleBuffer;
+            m_sampleBufferEmpty = true;
+
+            this->fetchSample();
+        }
+    }
+}
+
+// Run the channel from the given time to the end time
+void DmcChannel::run(BandLimitedBuffer& buffer, uint32_t time, uint32_t endTime) {
+    time += m_timer;
+
+    if (m_silence && m_sampleBufferEmpty) {
+        // Nothing to play, only advance the bits counter
+        uint32_t events = eventsBefore(time, endTime, m_period);
+        m_bitsRemaining = 8 - ((8 - m_bitsRemaining + events) & 0x07);
+        time += events * m_period;
+    } else {
+        while (time < endTime) {
+            this->clockOutput(buffer, time);
+            time += m_period;
+        }
+    }
+
+    m_timer = time - endTime;
+}
+}
@@ -0,0 +1,252 @@
+#ifndef APU_CHANNELS_H_
+#define APU_CHANNELS_H_
+
+#include "nesPch.h"
+
+#include "bandLimitedBuffer.h"
+
+namespace nesCore {
+class Bus;
+namespace utility {
+class StateWriter;
+class StateReader;
+}
+
+// Amplitude of one output level step of each channel, a linear
+// approximation of the NES mixer scaled to the 16 bit output range
+#define APU_PULSE_WEIGHT 241
+#define APU_TRIANGLE_WEIGHT 272
+#define APU_NOISE_WEIGHT 158
+#define APU_DMC_WEIGHT 107
+
+// Base of the APU channels, track the output level and add
+// its changes to the band-limited buffer
+//
+// The channels are run from the current time to an end time, the timer
+// events in between are processed at once and only the output changes
+// are written to the buffer. Times are in CPU cycles from the start of the
+// buffer frame, the timers count the cycles left to the next event
+class ApuChannel {
+public:
+    explicit ApuChannel(int32_t weight) : m_weight(weight), m_level(0), m_timer(0) {};
+
+    // Return the current output level
+    uint8_t level() { return m_level; }
+
+protected:
+    // Save and restore the output level and the timer, the restored
+    // level is added to the buffer as a step at the frame start
+    void saveState(utility::StateWriter& state);
+    void loadState(utility::StateReader& state, BandLimitedBuffer& buffer);
+
+    // Set the output level at the given time
+    void setLevel(BandLimitedBuffer& buffer, uint32_t time, uint8_t level) {
+        if (level != m_level) {
+            buffer.addDelta(time, (static_cast<int32_t>(level) - m_level) * m_weight);
+            m_level = level;
+        }
+    }
+
+    int32_t m_weight;
+    uint8_t m_level;
+
+    // CPU cycles left to the next timer event
+    uint32_t m_timer;
+};
+
+// Volume envelope of the pulse and noise channels
+struct ApuEnvelope {
+    bool start;
+    bool loop;
+    bool constant;
+
+    uint8_t period;
+    uint8_t divider;
+    uint8_t decay;
+
+    void reset();
+    // Clocked by the quarter frames
+    void clock();
+    // Return the current volume
+    uint8_t volume() { return constant ? period : decay; }
+};
+
+class PulseChannel : public ApuChannel {
+public:
+    // The first pulse channel sweep unit negate with one's complement
+    explicit PulseChannel(bool onesComplement);
+
+    void reset();
+    void writeRegister(uint8_t reg, uint8_t data);
+    void setEnabled(bool enabled);
+    // Return true if the length counter is not zero
+    bool active() { return m_length != 0; }
+
+    // Frame counter clocks
+    void clockQuarterFrame();
+    void clockHalfFrame();
+
+    // Run the channel from the given time to the end time
+    void run(BandLimitedBuffer& buffer, uint32_t time, uint32_t endTime);
+    // Update the output after a register write or a frame counter clock
+    void updateOutput(BandLimitedBuffer& buffer, uint32_t time);
+
+    // Save and restore the channel registers and counters
+    void saveState(utility::StateWriter& state);
+    void loadState(utility::StateReader& state, BandLimitedBuffer& buffer);
+
+private:
+    // Return the timer period target of the sweep unit
+    uint16_t sweepTarget();
+    // Return true if the channel output can be different from zero
+    bool audible();
+    // Return the output volume at the current sequencer step
+    uint8_t output();
+
+    bool m_onesComplement;
+    bool m_enabled;
+
+    uint8_t m_duty;
+    uint8_t m_sequencer;
+    uint16_t m_period;
+    uint8_t m_length;
+    bool m_lengthHalt;
+
+    ApuEnvelope m_envelope;
+
+    bool m_sweepEnabled;
+    bool m_sweepNegate;
+    bool m_sweepReload;
+    uint8_t m_sweepPeriod;
+    uint8_t m_sweepShift;
+    uint8_t m_sweepDivider;
+};
+
+class TriangleChannel : public ApuChannel {
+public:
+    TriangleChannel();
+
+    void reset();
+    void writeRegister(uint8_t reg, uint8_t data);
+    void setEnabled(bool enabled);
+    // Return true if the length counter is not zero
+    bool active() { return m_length != 0; }
+
+    // Frame counter clocks
+    void clockQuarterFrame();
+    void clockHalfFrame();
+
+    // Run the channel from the given time to the end time
+    void run(BandLimitedBuffer& buffer, uint32_t time, uint32_t endTime);
+
+    // Save and restore the channel registers and counters
+    void saveState(utility::StateWriter& state);
+    void loadState(utility::StateReader& state, BandLimitedBuffer& buffer);
+
+private:
+    bool m_enabled;
+
+    uint8_t m_sequencer;
+    uint16_t m_period;
+    uint8_t m_length;
+    bool m_control;
+
+    uint8_t m_linearReload;
+    uint8_t m_linearCounter;
+    bool m_linearReloadFlag;
+};
+
+class NoiseChannel : public ApuChannel {
+public:
+    NoiseChannel();
+
+    void reset();
+    void writeRegister(uint8_t reg, uint8_t data);
+    void setEnabled(bool enabled);
+    // Return true if the length counter is not zero
+    bool active() { return m_length != 0; }
+
+    // Frame counter clocks
+    void clockQuarterFrame();
+    void clockHalfFrame();
+
+    // Run the channel from the given time to the end time
+    void run(BandLimitedBuffer& buffer, uint32_t time, uint32_t endTime);
+    // Update the output after a register write or a frame counter clock
+    void updateOutput(BandLimitedBuffer& buffer, uint32_t time);
+
+    // Save and restore the channel registers and counters
+    void saveState(utility::StateWriter& state);
+    void loadState(utility::StateReader& state, BandLimitedBuffer& buffer);
+
+private:
+    // Return the output volume for the current shift register
+    uint8_t output();
+
+    bool m_enabled;
+
+    uint16_t m_shift;
+    bool m_shortMode;
+    uint16_t m_period;
+    uint8_t m_length;
+    bool m_lengthHalt;
+
+    ApuEnvelope m_envelope;
+};
+
+class DmcChannel : public ApuChannel {
+public:
+    DmcChannel();
+
+    // Attach the bus used to read the samples
+    void attachBus(Bus* bus);
+
+    void reset();
+    void writeRegister(uint8_t reg, uint8_t data, BandLimitedBuffer& buffer, uint32_t time);
+    void setEnabled(bool enabled);
+    // Return true if sample bytes remain to be read
+    bool active() { return m_bytesRemaining != 0; }
+
+    // Interrupt flag
+    bool irq() { return m_irq; }
+    void clearIrq() { m_irq = false; }
+    // Return the number of CPU cycles before the interrupt flag can be set
+    uint64_t cyclesToIrq();
+
+    // Run the channel from the given time to the end time
+    void run(BandLimitedBuffer& buffer, uint32_t time, uint32_t endTime);
+
+    // Save and restore the channel registers and counters
+    void saveState(utility::StateWriter& state);
+    void loadState(utility::StateReader& state, BandLimitedBuffer& buffer);
+
+private:
+    // Fill the sample buffer if it's empty and sample bytes remain
+    void fetchSample();
+    // Clock the output unit
+    void clockOutput(BandLimitedBuffer& buffer, uint32_t time);
+
+    Bus* mp_bus;
+
+    bool m_irqEnabled;
+    bool m_loop;
+    bool m_irq;
+    uint16_t m_period;
+
+    // Memory reader
+    uint16_t m_sampleAddr;
+    uint16_t m_sampleLength;
+    uint16_t m_currentAddr;
+    uint16_t m_bytesRemaining;
+
+    uint8_t m_sampleBuffer;
+    bool m_sampleBufferEmpty;
+
+    // Output unit
+    uint8_t m_shift;
+    uint8_t m_bitsRemaining;
+    bool m_silence;
+};
+}
+
+#endif
@@ -0,0 +1,17 @@
+#ifndef AUDIO_SINK_H_
+#define AUDIO_SINK_H_
+
+#include "nesPch.h"
+
+namespace nesCore {
+class AudioSink {
+public:
+    virtual ~AudioSink() {};
+
+    // Receive the mono signed 16 bit samples produced by the APU,
+    // called from the emulation thread while the emulator is running
+    virtual void pushSamples(const int16_t* samples, size_t count) = 0;
+};
+}
+
+#endif
@@ -0,0 +1,131 @@
+#include "nesPch.h"
+
+#include "bandLimitedBuffer.h"
+
+#include <cmath>
+#include <cstring>
+
+// Cutoff frequency of the kernel relative to the output Nyquist frequency
+#define BLIP_CUTOFF 0.90
+// Time constant of the DC blocking filter in samples, as a power of two
+#define BLIP_DC_SHIFT 9
+
+namespace nesCore {
+BandLimitedBuffer::BandLimitedBuffer() :
+    mp_buffer(nullptr), m_size(0), m_factor(0), m_baseFactor(0), m_nextFactor(0)
+{
+    this->computeKernel();
+    this->clear();
+}
+BandLimitedBuffer::~BandLimitedBuffer() {
+    delete[] mp_buffer;
+}
+
+// Set the input clock rate and the output sample rate
+void BandLimitedBuffer::setRates(uint32_t clockRate, uint32_t sampleRate, uint32_t maxFrameClocks) {
+    m_factor = (static_cast<uint64_t>(sampleRate) << BLIP_FRAC_BITS) / clockRate;
+    m_baseFactor = m_factor;
+    m_nextFactor = m_factor;
+
+    // Samples of a whole frame at the highest ratio, the kernel
+    // tail of the last step and the samples left by an incomplete read
+    size_t frameSamples = (static_cast<uint64_t>(maxFrameClocks) * m_factor >> BLIP_FRAC_BITS) * 2 + 1;
+    m_size = frameSamples * 2 + BLIP_WIDTH;
+
+    delete[] mp_buffer;
+    mp_buffer = new int32_t[m_size];
+
+    this->clear();
+}
+
+// Drop the samples and the pending steps
+void BandLimitedBuffer::clear() {
+    if (mp_buffer != nullptr)
+        std::fill(mp_buffer, mp_buffer + m_size, 0);
+
+    m_offset = 0;
+    m_integrator = 0;
+    m_dcLevel = 0;
+}
+
+// Scale the sample rate by the given ratio from the next frame
+void BandLimitedBuffer::setRatio(double ratio) {
+    // The buffer is sized for frames up to twice the nominal rate
+    ratio = std::clamp(ratio, 0.5, 2.0);
+    m_nextFactor = static_cast<uint64_t>(m_baseFactor * ratio);
+}
+
+// Compute the windowed sinc step kernel
+void BandLimitedBuffer::computeKernel() {
+    const double pi = 3.14159265358979323846;
+    const double halfWidth = BLIP_WIDTH / 2;
+
+    for (int phase = 0; phase < BLIP_PHASES; phase++) {
+        double fraction = static_cast<double>(phase) / BLIP_PHASES;
+        double taps[BLIP_WIDTH];
+        double sum = 0.0;
+
+        // Blackman windowed sinc centered between the
+        // two middle taps, shifted by the step position
+        for (int i = 0; i < BLIP_WIDTH; i++) {
+            double x = i - (halfWidth - 1) - fraction;
+
+            double sinc = x == 0.0 ? 1.0 : std::sin(pi * BLIP_CUTOFF * x) / (pi * BLIP_CUTOFF * x);
+            double window = 0.42 + 0.5 * std::cos(pi * x / halfWidth) + 0.08 * std::cos(2 * pi * x / halfWidth);
+
+            taps[i] = sinc * window;
+            sum += taps[i];
+        }
+
+        // Each step must add exactly its amplitude to the integrated signal
+        int total = 0;
+        int largest = 0;
+        for (int i = 0; i < BLIP_WIDTH; i++) {
+            mp_kernel[phase][i] = static_cast<int16_t>(std::lround(taps[i] / sum * (1 << BLIP_KERNEL_BITS)));
+            total += mp_kernel[phase][i];
+
+            if (mp_kernel[phase][i] > mp_kernel[phase][largest])
+                largest = i;
+        }
+
+        mp_kernel[phase][largest] += (1 << BLIP_KERNEL_BITS) - total;
+    }
+}
+
+// End the current frame after the given number of clocks
+void BandLimitedBuffer::endFrame(uint32_t time) {
+    m_offset += static_cast<uint64_t>(time) * m_factor;
+
+    // The steps of a frame must all use the same factor
+    m_factor = m_nextFactor;
+}
+
+// Return the number of samples that can be read
+size_t BandLimitedBuffer::samplesAvailable() {
+    return m_offset >> BLIP_FRAC_BITS;
+}
+
+// Read and remove up to count samples
+size_t BandLimitedBuffer::readSamples(int16_t* out, size_t count) {
+    count = std::min(count, this->samplesAvailable());
+
+    for (size_t i = 0; i < count; i++) {
+        m_integrator += mp_buffer[i];
+
+        // Remove the DC offset of the mixed channels
+        int32_t sample = m_integrator >> BLIP_KERNEL_BITS;
+        m_dcLevel += ((static_cast<int64_t>(sample) << 16) - m_dcLevel) >> BLIP_DC_SHIFT;
+        sample -= static_cast<int32_t>(m_dcLevel >> 16);
+
+        out[i] = static_cast<int16_t>(std::clamp(sample, -32768, 32767));
+    }
+
+    // Move the steps of the following samples to the beginning of the buffer
+    size_t remaining = this->samplesAvailable() - count + BLIP_WIDTH;
+    std::memmove(mp_buffer, mp_buffer + count, remaining * sizeof(int32_t));
+    std::fill(mp_buffer + remaining, mp_buffer + remaining + count, 0);
+
+    m_offset -= static_cast<uint64_t>(count) << BLIP_FRAC_BITS;
+    return count;
+}
+}
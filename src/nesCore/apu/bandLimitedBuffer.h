@@ -0,0 +1,87 @@
+#ifndef BAND_LIMITED_BUFFER_H_
+#define BAND_LIMITED_BUFFER_H_
+
+#include "nesPch.h"
+
+// Number of output samples touched by one amplitude step
+#define BLIP_WIDTH 16
+// Sub-sample positions of the step kernel
+#define BLIP_PHASE_BITS 6
+#define BLIP_PHASES (1 << BLIP_PHASE_BITS)
+// Fixed point precision of the kernel and of the sample positions
+#define BLIP_KERNEL_BITS 14
+#define BLIP_FRAC_BITS 32
+
+namespace nesCore {
+// Band-limited step synthesis buffer
+//
+// The channels add the changes of their output amplitude at the clock
+// cycle they happen, each change is stored as a band-limited step spread
+// over BLIP_WIDTH output samples. The samples are reconstructed by
+// integrating the steps, so the cost only depend on the number of changes
+// and on the number of output samples, not on the input clock rate
+class BandLimitedBuffer {
+public:
+    BandLimitedBuffer();
+    ~BandLimitedBuffer();
+
+    // The buffer own the sample memory
+    BandLimitedBuffer(const BandLimitedBuffer&) = delete;
+    BandLimitedBuffer& operator=(const BandLimitedBuffer&) = delete;
+
+    // Set the input clock rate and the output sample rate, the frames
+    // can't be longer than the given number of clocks. Clear the buffer
+    void setRates(uint32_t clockRate, uint32_t sampleRate, uint32_t maxFrameClocks);
+    // Drop the samples and the pending steps
+    void clear();
+    // Scale the sample rate by the given ratio from the next frame,
+    // used to adjust the rate to the consumer without clearing the buffer
+    void setRatio(double ratio);
+
+    // Add an amplitude change at the given clock of the current frame
+    void addDelta(uint32_t time, int32_t delta) {
+        uint64_t position = m_offset + static_cast<uint64_t>(time) * m_factor;
+
+        int32_t* p_out = mp_buffer + (position >> BLIP_FRAC_BITS);
+        const int16_t* p_kernel = mp_kernel[(position >> (BLIP_FRAC_BITS - BLIP_PHASE_BITS)) & (BLIP_PHASES - 1)];
+
+        for (int i = 0; i < BLIP_WIDTH; i++)
+            p_out[i] += p_kernel[i] * delta;
+    }
+
+    // End the current frame after the given number of clocks,
+    // the samples of the frame become available
+    void endFrame(uint32_t time);
+
+    // Return the number of samples that can be read
+    size_t samplesAvailable();
+    // Read and remove up to count samples, return the number of samples read
+    size_t readSamples(int16_t* out, size_t count);
+
+private:
+    // Compute the windowed sinc step kernel
+    void computeKernel();
+
+private:
+    int32_t* mp_buffer;
+    size_t m_size;
+
+    // Output samples per input clock and position of the
+    // current frame start, in BLIP_FRAC_BITS fixed point
+    uint64_t m_factor;
+    uint64_t m_offset;
+
+    // Factor of the nominal sample rate and of the next frame
+    uint64_t m_baseFactor;
+    uint64_t m_nextFactor;
+
+    // Steps derivative for each sub-sample position
+    int16_t mp_kernel[BLIP_PHASES][BLIP_WIDTH];
+
+    // Integrated amplitude and DC blocking filter state
+    int32_t m_integrator;
+    int64_t m_dcLevel;
+};
+}
+
+#endif
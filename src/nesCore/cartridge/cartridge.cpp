@@ -4,13 +4,16 @@
 #include "nromCartridge.h"
 #include "cnromCartridge.h"
 
+#include <iterator>
+#include <vector>
+
 namespace nesCore {
 // Parse file header for iNES and NES 2
-CartridgeOption iNESparse(uint8_t* header);
-CartridgeOption NES2parse(uint8_t* header);
+CartridgeOption iNESparse(const uint8_t* header);
+CartridgeOption NES2parse(const uint8_t* header);
 
 Cartridge* Cartridge::loadCartridgeFromFile(const std::string& filename) {
-   // open the file and read the header
+   // open the file and read the whole content
     std::ifstream file(filename, std::ios_base::binary);
 
     // Check if the given palette file exist
@@ -18,8 +21,19 @@ Cartridge* Cartridge::loadCartridgeFromFile(const std::string& filename) {
         return nullptr;
     }
 
-    uint8_t header[16];
-    file.read((char*)header, 16);
+    std::vector<uint8_t> data(
+        (std::istreambuf_iterator<char>(file)),
+        std::istreambuf_iterator<char>()
+    );
+
+    return loadCartridgeFromMemory(data.data(), data.size());
+}
+
+Cartridge* Cartridge::loadCartridgeFromMemory(const uint8_t* data, size_t size) {
+    if (size < 16)
+        return nullptr;
+
+    const uint8_t* header = data;
 
     // Check the header for a iNES file
     if (header[0] != 0x4E || header[1] != 0x45 || header[2] != 0x53 || header[3] != 0x1A)
@@ -28,14 +42,22 @@ Cartridge* Cartridge::loadCartridgeFromFile(const std::string& filename) {
     // Check for NES2 rom format and parse cartridge options
     bool NES2Format = (header[7] & 0x0C) == 0x08;
     CartridgeOption cartOpt = NES2Format ? iNESparse(header) : NES2parse(header);
+
+    // Check the file contains the ROM banks
+    size_t prgSize = 16 * 1024 * cartOpt.prgBanksCount;
+    size_t chrSize = 8 * 1024 * cartOpt.chrBanksCount;
+    if (size - 16 < prgSize + chrSize) {
+        std::cerr << "ROM file too small for its banks" << std::endl;
+        return nullptr;
+    }
     
     // Load the program ROM
-    uint8_t* prgRom = new uint8_t[16 * 1024 * cartOpt.prgBanksCount];
-    file.read((char*)prgRom, 16 * 1024 * cartOpt.prgBanksCount);
+    uint8_t* prgRom = new uint8_t[prgSize];
+    std::copy(data + 16, data + 16 + prgSize, prgRom);
 
     // Load the character ROM
-    uint8_t* chrRom = new uint8_t[8 * 1024 * cartOpt.chrBanksCount];
-    file.read((char*)chrRom, 8 * 1024 * cartOpt.chrBanksCount);
+    uint8_t* chrRom = new uint8_t[chrSize];
+    std::copy(data + 16 + prgSize, data + 16 + prgSize + chrSize, chrRom);
 
     // Print file information
     if (NES2Format)
@@ -57,6 +79,8 @@ Cartridge* Cartridge::loadCartridgeFromFile(const std::string& filename) {
 
         case FOUR_SCREEN:
             std::cout << "Mirroring: four screen(Not supported)" << std::endl;
+            delete[] prgRom;
+            delete[] chrRom;
             return nullptr;
     }
             
@@ -76,15 +100,15 @@ Cartridge* Cartridge::loadCartridgeFromFile(const std::string& filename) {
         default:
             std::cout << "Mapper unsupported";
             std::cout << std::endl;
-    }
 
-    // Close the file and return
-    file.close();
+            delete[] prgRom;
+            delete[] chrRom;
+    }
 
     return outputCartridge;
 }
 
-CartridgeOption iNESparse(uint8_t* header) {
+CartridgeOption iNESparse(const uint8_t* header) {
     CartridgeOption outputOpt;
     outputOpt.NES2format = false;
 
@@ -110,7 +134,7 @@ CartridgeOption iNESparse(uint8_t* header) {
     return outputOpt;
 }
 
-CartridgeOption NES2parse(uint8_t* header) {
+CartridgeOption NES2parse(const uint8_t* header) {
     CartridgeOption outputOpt;
     outputOpt.NES2format = true;
 
@@ -3,7 +3,14 @@
 
 #include "nesPch.h"
 
+#include "nesCore/cpuPageTable.h"
+#include "chrTileCache.h"
+
 namespace nesCore {
+namespace utility {
+class StateWriter;
+class StateReader;
+}
 
 // Cartridge mirroring type
 enum MirroringMode {
@@ -29,7 +36,7 @@ struct CartridgeOption {
 
 class Cartridge {
 public:
-    Cartridge() {};
+    Cartridge() : mp_pageTable(nullptr) {};
     virtual ~Cartridge() {};
 
     // Write to a specific address of the cartridge
@@ -38,17 +45,63 @@ public:
     virtual uint8_t cpuRead(uint16_t addr) = 0;
     // Read the byte of memory at the given address in CHR memory
     virtual uint8_t ppuRead(uint16_t addr) = 0;
+    // Write a byte to CHR memory, ignored by cartridges without CHR RAM
+    virtual void ppuWrite(uint16_t addr, uint8_t data) { (void)addr; (void)data; };
+
+    // Return the decoded row of the tile at the given pattern address,
+    // bit 3 of the address must be clear
+    const ChrTileRow& chrTileRow(uint16_t addr) { return m_chrTileCache.row(this, addr); }
 
     // Set reset signal to the cartridge
     virtual void reset() = 0;
 
+    // Save the mapper registers and the cartridge RAM, the banks are
+    // stored as bank numbers. The state start with the mapper layout,
+    // a state saved by a different cartridge layout is rejected
+    virtual void saveState(utility::StateWriter& state) = 0;
+    // Restore a state saved by the same cartridge layout, return false
+    // without changing the cartridge otherwise. Mappers switching
+    // PRG banks must map the restored banks in the page table
+    virtual bool loadState(utility::StateReader& state) = 0;
+
     // Get the cartridge name table mirroring type
     virtual MirroringMode getMirroringMode() = 0;
 
+    // Return the 8Kb PRG ROM bank mapped at the given address
+    // of the $8000-$FFFF window
+    uint16_t prgBank(uint16_t addr) { return mp_prgBanks[(addr >> 13) & 0x03]; }
+
+    // Map the cartridge memory in the given CPU page table, the mapper
+    // keep the table up to date when it switch PRG banks
+    void attachPageTable(CpuPageTable* pageTable) {
+        mp_pageTable = pageTable;
+        this->mapCpuPages();
+    }
+
     // Load a cartridge from a file
     // Return a cartridge on success
     // Nullptr on failure
     static Cartridge* loadCartridgeFromFile(const std::string& filename);
+    // Load a cartridge from the content of a ROM file, the data is copied
+    // Return a cartridge on success
+    // Nullptr on failure
+    static Cartridge* loadCartridgeFromMemory(const uint8_t* data, size_t size);
+
+protected:
+    // Map the PRG RAM and the current PRG ROM banks in the page table,
+    // by default all the accesses go through cpuRead and cpuWrite
+    virtual void mapCpuPages() {};
+
+    // CPU page table of the bus, nullptr if the cartridge isn't attached
+    CpuPageTable* mp_pageTable;
+
+    // Decoded tiles of the CHR memory mapped in the pattern tables,
+    // mappers must invalidate it when they switch CHR banks
+    ChrTileCache m_chrTileCache;
+
+    // 8Kb PRG ROM bank mapped in each 8Kb slot of the $8000-$FFFF window,
+    // mappers must keep it updated when they switch PRG banks
+    uint16_t mp_prgBanks[4];
 };
 
 
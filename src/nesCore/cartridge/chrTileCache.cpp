@@ -0,0 +1,37 @@
+#include "nesPch.h"
+
+#include "chrTileCache.h"
+#include "cartridge.h"
+
+namespace nesCore {
+// Construct an empty cache
+ChrTileCache::ChrTileCache() {
+    this->invalidateAll();
+}
+
+// Drop the tiles in the given CHR address range
+void ChrTileCache::invalidate(uint16_t from, uint16_t to) {
+    for (uint16_t tile = from >> 4; tile <= (to >> 4) && tile < CHR_TILES_COUNT; tile++)
+        mp_valid[tile] = false;
+}
+
+// Drop all the tiles
+void ChrTileCache::invalidateAll() {
+    std::fill(mp_valid, mp_valid + CHR_TILES_COUNT, false);
+}
+
+// Read and decode the given tile
+void ChrTileCache::decode(Cartridge* cartridge, uint16_t tile) {
+    for (uint16_t y = 0; y < 8; y++) {
+        ChrTileRow& row = mp_rows[(tile << 3) | y];
+
+        uint16_t addr = (tile << 4) | y;
+        row.low = cartridge->ppuRead(addr);
+        row.high = cartridge->ppuRead(addr | 0x08);
+
+        decodeTileRow(row);
+    }
+
+    mp_valid[tile] = true;
+}
+}
@@ -0,0 +1,69 @@
+#ifndef CHR_TILE_CACHE_H_
+#define CHR_TILE_CACHE_H_
+
+#include "nesPch.h"
+
+// Number of 8x8 tiles in the $0000-$1FFF pattern tables window
+#define CHR_TILES_COUNT 512
+
+namespace nesCore {
+class Cartridge;
+
+// One row of a pattern table tile
+struct ChrTileRow {
+    // Bit planes as stored in CHR memory
+    uint8_t low;
+    uint8_t high;
+
+    // Pixels decoded to one byte per pixel, from left to right
+    // and horizontally flipped
+    uint8_t pixels[8];
+    uint8_t flipped[8];
+};
+
+// Decode the bit planes of the row to one byte per pixel
+inline void decodeTileRow(ChrTileRow& row) {
+    // Combine the two bit planes, the most significant bit is the left pixel
+    for (int x = 0; x < 8; x++) {
+        uint8_t pixel = (row.low >> (7 - x)) & 0x01;
+        pixel |= ((row.high >> (7 - x)) & 0x01) << 1;
+
+        row.pixels[x] = pixel;
+        row.flipped[7 - x] = pixel;
+    }
+}
+
+// Tiles of the CHR banks mapped in the pattern tables window, decoded
+// when they are first used. The cartridge must invalidate the tiles
+// when it switch CHR banks or when CHR RAM is written
+class ChrTileCache {
+public:
+    ChrTileCache();
+
+    // Return the row of the tile at the given pattern address,
+    // bit 3 of the address must be clear
+    const ChrTileRow& row(Cartridge* cartridge, uint16_t addr) {
+        uint16_t tile = (addr >> 4) & (CHR_TILES_COUNT - 1);
+
+        if (!mp_valid[tile])
+            this->decode(cartridge, tile);
+
+        return mp_rows[(tile << 3) | (addr & 0x07)];
+    }
+
+    // Drop the tiles in the given CHR address range (both extreme are included)
+    void invalidate(uint16_t from, uint16_t to);
+    // Drop all the tiles
+    void invalidateAll();
+
+private:
+    // Read and decode the given tile
+    void decode(Cartridge* cartridge, uint16_t tile);
+
+private:
+    ChrTileRow mp_rows[CHR_TILES_COUNT * 8];
+    bool mp_valid[CHR_TILES_COUNT];
+};
+}
+
+#endif
@@ -2,6 +2,7 @@
 
 #include "cartridge.h"
 #include "cnromCartridge.h"
+#include "nesCore/utility/stateBuffer.h"
 
 namespace nesCore {
 // Take a pointer to the program ROM and the number of 16Kb memory banks in the ROM
@@ -42,6 +43,10 @@ CnromCartridge::CnromCartridge(uint8_t* p_prgRom, uint8_t* p_chrRom, CartridgeOp
     // Set the banks window pointer to the beginning of chr memory 
     mp_chrWindow = mp_chrRom;
 
+    // Map the PRG ROM banks, 16Kb ROM are mirrored
+    for (int i = 0; i < 4; i++)
+        mp_prgBanks[i] = i % (m_prgBanksCount * 2);
+
     // Store mirroring mode
     m_mirroringMode = cartOpt.mirroringMode;
 }
@@ -56,6 +61,47 @@ CnromCartridge::~CnromCartridge() {
 // Handle reset signal
 void CnromCartridge::reset() {
     mp_chrWindow = mp_chrRom;
+    m_chrTileCache.invalidateAll();
+}
+
+// Save the PRG RAM and the CHR bank number
+void CnromCartridge::saveState(utility::StateWriter& state) {
+    // Layout of the cartridge
+    state.write(static_cast<uint16_t>(0x03));
+    state.write(m_prgBanksCount);
+    state.write(m_chrBanksCount);
+
+    state.writeArray(mp_prgRam, 8 * 1024);
+
+    uint8_t chrBank = static_cast<uint8_t>((mp_chrWindow - mp_chrRom) / (8 * 1024));
+    state.write(chrBank);
+}
+
+// Restore the PRG RAM and the CHR window
+bool CnromCartridge::loadState(utility::StateReader& state) {
+    uint16_t mapperId = 0xFFFF;
+    uint8_t prgBanksCount = 0;
+    uint8_t chrBanksCount = 0;
+
+    state.read(mapperId);
+    state.read(prgBanksCount);
+    state.read(chrBanksCount);
+
+    if (mapperId != 0x03 || prgBanksCount != m_prgBanksCount || chrBanksCount != m_chrBanksCount)
+        return false;
+
+    state.readArray(mp_prgRam, 8 * 1024);
+
+    uint8_t chrBank = 0;
+    state.read(chrBank);
+
+    uint8_t* chrWindow = mp_chrRom + (8 * 1024 * (chrBank % m_chrBanksCount));
+    if (chrWindow != mp_chrWindow) {
+        mp_chrWindow = chrWindow;
+        m_chrTileCache.invalidateAll();
+    }
+
+    return !state.failed();
 }
 
 // Write to a specific address of the cartridge
@@ -68,8 +114,13 @@ void CnromCartridge::cpuWrite(uint16_t addr, uint8_t data) {
         // Perform the modulo of the requested window and 
         // the number of banks to avoid overflow
         data %= m_chrBanksCount;
+        uint8_t* chrWindow = mp_chrRom + (8 * 1024 * data);
 
-        mp_chrWindow = mp_chrRom + (8 * 1024 * data);
+        // The decoded tiles are from the old bank
+        if (chrWindow != mp_chrWindow) {
+            mp_chrWindow = chrWindow;
+            m_chrTileCache.invalidateAll();
+        }
     }
 }
 
@@ -84,6 +135,15 @@ uint8_t CnromCartridge::cpuRead(uint16_t addr) {
     return 0x00;
 }
 
+// Map PRG RAM and PRG ROM in the CPU page table, 16Kb ROM are mirrored
+void CnromCartridge::mapCpuPages() {
+    if (mp_pageTable == nullptr)
+        return;
+
+    mp_pageTable->map(0x6000, 0x7FFF, mp_prgRam, 8 * 1024, true);
+    mp_pageTable->map(0x8000, 0xFFFF, mp_prgRom, m_prgBanksCount * 16 * 1024, false);
+}
+
 // Read to a specific address of the cartridge
 uint8_t CnromCartridge::ppuRead(uint16_t addr) {
     if (addr >= 0x0000 && addr <= 0x1FFF)
@@ -23,7 +23,14 @@ public:
     // Handle reset signal
     void reset() override;
 
+    // Save and restore the PRG RAM and the CHR bank
+    void saveState(utility::StateWriter& state) override;
+    bool loadState(utility::StateReader& state) override;
+
 private:
+    // Map PRG RAM and PRG ROM in the CPU page table
+    void mapCpuPages() override;
+
     uint8_t* mp_prgRom;
     uint8_t* mp_prgRam;
     uint8_t* mp_chrRom;
@@ -2,6 +2,7 @@
 
 #include "cartridge.h"
 #include "nromCartridge.h"
+#include "nesCore/utility/stateBuffer.h"
 
 namespace nesCore {
 // Take a pointer to the program ROM and the number of 16Kb memory banks in the ROM
@@ -28,14 +29,23 @@ NromCartridge::NromCartridge(uint8_t* p_prgRom, uint8_t* p_chrRom, CartridgeOpti
         std::fill(mp_prgRom, mp_prgRom + (16 * 1024 * cartOpt.prgBanksCount), 0x00);
     }
 
+    // Cartridges without CHR ROM have 8Kb of CHR RAM
+    m_chrRam = cartOpt.chrBanksCount == 0;
+
     // If a null pointer to p_chrRom is given allocate a 16Kb memory bank
-    if (p_chrRom != nullptr) {
+    if (p_chrRom != nullptr && !m_chrRam) {
         mp_chrRom = p_chrRom;
     } else {
+        delete[] p_chrRom;
+
         mp_chrRom = new uint8_t[8 * 1024];
         std::fill(mp_chrRom, mp_chrRom + (8 * 1024), 0x00);
     }
 
+    // Map the PRG ROM banks, 16Kb ROM are mirrored
+    for (int i = 0; i < 4; i++)
+        mp_prgBanks[i] = i % (m_banksCount * 2);
+
     // Store mirroring mode
     m_mirroringMode = cartOpt.mirroringMode;
 }
@@ -50,6 +60,40 @@ NromCartridge::~NromCartridge() {
 // Handle reset signal
 void NromCartridge::reset() {} 
 
+// Save the PRG RAM and the CHR RAM
+void NromCartridge::saveState(utility::StateWriter& state) {
+    // Layout of the cartridge
+    state.write(static_cast<uint16_t>(0x00));
+    state.write(m_banksCount);
+    state.write(m_chrRam);
+
+    state.writeArray(mp_prgRam, 8 * 1024);
+    if (m_chrRam)
+        state.writeArray(mp_chrRom, 8 * 1024);
+}
+
+// Restore the PRG RAM and the CHR RAM
+bool NromCartridge::loadState(utility::StateReader& state) {
+    uint16_t mapperId = 0xFFFF;
+    uint8_t banksCount = 0;
+    bool chrRam = false;
+
+    state.read(mapperId);
+    state.read(banksCount);
+    state.read(chrRam);
+
+    if (mapperId != 0x00 || banksCount != m_banksCount || chrRam != m_chrRam)
+        return false;
+
+    state.readArray(mp_prgRam, 8 * 1024);
+    if (m_chrRam) {
+        state.readArray(mp_chrRom, 8 * 1024);
+        m_chrTileCache.invalidateAll();
+    }
+
+    return !state.failed();
+}
+
 // Write to a specific address of the cartridge
 void NromCartridge::cpuWrite(uint16_t addr, uint8_t data) {
     if (addr >= 0x6000 && addr <= 0x7FFF)
@@ -67,6 +111,15 @@ uint8_t NromCartridge::cpuRead(uint16_t addr) {
     return 0x00;
 }
 
+// Map PRG RAM and PRG ROM in the CPU page table, 16Kb ROM are mirrored
+void NromCartridge::mapCpuPages() {
+    if (mp_pageTable == nullptr)
+        return;
+
+    mp_pageTable->map(0x6000, 0x7FFF, mp_prgRam, 8 * 1024, true);
+    mp_pageTable->map(0x8000, 0xFFFF, mp_prgRom, m_banksCount * 16 * 1024, false);
+}
+
 // Read to a specific address of the cartridge
 uint8_t NromCartridge::ppuRead(uint16_t addr) {
     if (addr >= 0x0000 && addr <= 0x1FFF)
@@ -75,6 +128,17 @@ uint8_t NromCartridge::ppuRead(uint16_t addr) {
     return 0x00;
 }
 
+// Write to CHR RAM, CHR ROM can't be written
+void NromCartridge::ppuWrite(uint16_t addr, uint8_t data) {
+    if (!m_chrRam || addr > 0x1FFF)
+        return;
+
+    if (mp_chrRom[addr] != data) {
+        mp_chrRom[addr] = data;
+        m_chrTileCache.invalidate(addr, addr);
+    }
+}
+
 // Return the mirroring mode
 MirroringMode NromCartridge::getMirroringMode() {
     return m_mirroringMode;
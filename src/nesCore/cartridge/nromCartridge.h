@@ -17,6 +17,8 @@ public:
     uint8_t cpuRead(uint16_t addr) override;
     // Read the byte of memory at the given address in CHR memory
     virtual uint8_t ppuRead(uint16_t addr) override;
+    // Write a byte to CHR RAM
+    virtual void ppuWrite(uint16_t addr, uint8_t data) override;
     
     // Get the cartridge name table mirroring type
     virtual MirroringMode getMirroringMode() override;
@@ -24,10 +26,19 @@ public:
     // Handle reset signal
     void reset() override;
 
+    // Save and restore the PRG RAM and the CHR RAM
+    void saveState(utility::StateWriter& state) override;
+    bool loadState(utility::StateReader& state) override;
+
 private:
+    // Map PRG RAM and PRG ROM in the CPU page table
+    void mapCpuPages() override;
+
     uint8_t* mp_prgRom;
     uint8_t* mp_prgRam;
     uint8_t* mp_chrRom;
+    // True if the CHR memory is RAM
+    bool m_chrRam;
 
     // Number of install memory bank
     uint8_t m_banksCount;
@@ -3,7 +3,20 @@
 #include "cpu6502debug.h"
 #include "nesCore/utility/utilityFunctions.h"
 #include "cpu6502.h"
+#include "cpu6502opcodes.h"
+#include "cpu6502dynarec.h"
 #include "nesCore/cpuBus.h"
+#include "nesCore/utility/stateBuffer.h"
+
+// Select the opcode dispatch engine, default to the handlers table.
+// Computed goto are only available on GCC compatible compilers
+#if defined(NES_CPU_DISPATCH_THREADED) && !defined(__GNUC__)
+#undef NES_CPU_DISPATCH_THREADED
+#endif
+
+#if !defined(NES_CPU_DISPATCH_SWITCH) && !defined(NES_CPU_DISPATCH_THREADED) && !defined(NES_CPU_DISPATCH_TABLE)
+#define NES_CPU_DISPATCH_TABLE
+#endif
 
 namespace nesCore {
 // CPU constructor
@@ -13,14 +26,146 @@ Cpu6502::Cpu6502(Bus* bus) : m_bus(bus) {
     m_regY = 0;
     m_accumulator = 0;
 
-    // Initialize status registers
-    m_carryFlag = false;
-    m_zeroFlag = false;
-    m_interruptDisable = true;
-    m_decimalMode = false; 
-    m_overflowFlag = false;
-    m_negativeFlag = false;
+    // Initialize status registers, only the interrupt disable flag is set
+    m_status = FLAG_INTERRUPT;
+    m_nzResult = 0x0001;
+
+    m_operand = 0x0000;
+
+    // Allocate an empty decoded instructions cache
+    mp_decodeCache = new DecodedInstruction[DECODE_CACHE_SIZE];
+
+    // Create the dynarec if it was enabled at build time
+    mp_dynarec = nullptr;
+    m_dynarecEnabled = false;
+#if defined(NES_CPU_DYNAREC)
+    mp_dynarec = new Dynarec6502(this);
+    m_dynarecEnabled = mp_dynarec->available();
+#endif
+
+    // Idle loop are skipped by default, the first
+    // snapshot is taken by the first detection step
+    m_idleSkipEnabled = true;
+    m_idleCyclesSkipped = 0;
+    m_idleSnapshot = IdleLoopSnapshot();
+    m_idleSnapshot.steps = IDLE_LOOP_MAX_STEPS;
+
+    this->flushDecodeCache();
 };
+Cpu6502::~Cpu6502() {
+    delete [] mp_decodeCache;
+
+#if defined(NES_CPU_DYNAREC)
+    delete mp_dynarec;
+#endif
+}
+
+// Drop all the instructions in the decoded instructions cache and the dynarec
+void Cpu6502::flushDecodeCache() {
+    for (size_t i = 0; i < DECODE_CACHE_SIZE; i++)
+        mp_decodeCache[i].handler = nullptr;
+
+    m_decodeCacheHits = 0;
+    m_decodeCacheLookups = 0;
+
+#if defined(NES_CPU_DYNAREC)
+    mp_dynarec->flush();
+#endif
+}
+
+// Enable or disable the dynarec
+bool Cpu6502::enableDynarec(bool enable) {
+#if defined(NES_CPU_DYNAREC)
+    if (!mp_dynarec->available())
+        return !enable;
+
+    m_dynarecEnabled = enable;
+    return true;
+#else
+    return !enable;
+#endif
+}
+
+// Enable or disable the idle loop skipping
+void Cpu6502::enableIdleLoopSkip(bool enable) {
+    m_idleSkipEnabled = enable;
+    this->resetIdleLoop();
+}
+// Drop the idle loop snapshot, the next step take a new one
+void Cpu6502::resetIdleLoop() {
+    m_idleSnapshot.steps = IDLE_LOOP_MAX_STEPS;
+}
+
+// Skip the iterations of the idle loop at the program counter
+size_t Cpu6502::skipIdleLoop(size_t maxCycles, size_t maxStatusCycles) {
+    if (!m_idleSkipEnabled)
+        return 0;
+
+    IdleLoopSnapshot& head = m_idleSnapshot;
+
+    // Wait for the program counter to come back to the loop head,
+    // give up and use a new head if it takes too many steps,
+    // a snapshot with too many steps is never compared
+    if (m_pc != head.pc || head.steps >= IDLE_LOOP_MAX_STEPS) {
+        head.steps++;
+        if (head.steps >= IDLE_LOOP_MAX_STEPS)
+            this->takeIdleSnapshot(maxStatusCycles);
+
+        return 0;
+    }
+
+    // The loop is idle if an iteration has no side effect and leave the CPU
+    // in the same state, every following iteration then behave the same
+    // until an interrupt or a change of the PPU status register. The status
+    // must not have changed during the iteration reading it
+    uint64_t statusReads = m_bus->m_statusReadCount - head.statusReadCount;
+    bool idle =
+        m_cpuCycle != head.cpuCycle &&
+        m_stackPointer == head.stackPointer &&
+        m_regX == head.regX && m_regY == head.regY &&
+        m_accumulator == head.accumulator &&
+        this->getStatusByte(false) == head.statusByte &&
+        m_bus->m_writeCount == head.writeCount &&
+        m_bus->m_ioReadCount - head.ioReadCount == statusReads &&
+        (statusReads == 0 || m_cpuCycle <= head.statusDeadline);
+
+    uint64_t period = m_cpuCycle - head.cpuCycle;
+    this->takeIdleSnapshot(maxStatusCycles);
+
+    if (!idle)
+        return 0;
+
+    // Skip the whole iterations fitting in the cycles limit
+    if (statusReads != 0)
+        maxCycles = std::min(maxCycles, maxStatusCycles);
+
+    uint64_t skipped = (maxCycles / period) * period;
+    m_cpuCycle += skipped;
+    m_idleCyclesSkipped += skipped;
+
+    head.cpuCycle = m_cpuCycle;
+    return skipped;
+}
+
+// Store the registers and bus counters at the program counter
+void Cpu6502::takeIdleSnapshot(size_t statusCycles) {
+    IdleLoopSnapshot& head = m_idleSnapshot;
+
+    head.cpuCycle = m_cpuCycle;
+    head.writeCount = m_bus->m_writeCount;
+    head.ioReadCount = m_bus->m_ioReadCount;
+    head.statusReadCount = m_bus->m_statusReadCount;
+    head.statusDeadline = m_cpuCycle + statusCycles;
+
+    head.pc = m_pc;
+    head.stackPointer = m_stackPointer;
+    head.regX = m_regX;
+    head.regY = m_regY;
+    head.accumulator = m_accumulator;
+    head.statusByte = this->getStatusByte(false);
+
+    head.steps = 0;
+}
 
 // Reset all the CPU register
 void Cpu6502::reset() {
@@ -32,7 +177,66 @@ void Cpu6502::reset() {
     m_stackPointer = 0xFD;
 
     // Reset status registers
-    m_interruptDisable = true;
+    this->setFlag(FLAG_INTERRUPT, true);
+
+    // Restart the idle loop detection
+    m_idleSnapshot.steps = IDLE_LOOP_MAX_STEPS;
+}
+
+// Save the registers and the idle loop snapshot
+void Cpu6502::saveState(utility::StateWriter& state) {
+    state.write(m_cpuCycle);
+    state.write(m_pc);
+    state.write(m_stackPointer);
+    state.write(m_regX);
+    state.write(m_regY);
+    state.write(m_accumulator);
+    state.write(m_operand);
+    state.write(m_status);
+    state.write(m_nzResult);
+
+    // The snapshot is written field by field, its padding bytes are undefined
+    const IdleLoopSnapshot& head = m_idleSnapshot;
+    state.write(head.cpuCycle);
+    state.write(head.writeCount);
+    state.write(head.ioReadCount);
+    state.write(head.statusReadCount);
+    state.write(head.statusDeadline);
+    state.write(head.pc);
+    state.write(head.stackPointer);
+    state.write(head.regX);
+    state.write(head.regY);
+    state.write(head.accumulator);
+    state.write(head.statusByte);
+    state.write(static_cast<uint64_t>(head.steps));
+}
+// Restore the registers and the idle loop snapshot
+void Cpu6502::loadState(utility::StateReader& state) {
+    state.read(m_cpuCycle);
+    state.read(m_pc);
+    state.read(m_stackPointer);
+    state.read(m_regX);
+    state.read(m_regY);
+    state.read(m_accumulator);
+    state.read(m_operand);
+    state.read(m_status);
+    state.read(m_nzResult);
+
+    IdleLoopSnapshot& head = m_idleSnapshot;
+    uint64_t steps = IDLE_LOOP_MAX_STEPS;
+    state.read(head.cpuCycle);
+    state.read(head.writeCount);
+    state.read(head.ioReadCount);
+    state.read(head.statusReadCount);
+    state.read(head.statusDeadline);
+    state.read(head.pc);
+    state.read(head.stackPointer);
+    state.read(head.regX);
+    state.read(head.regY);
+    state.read(head.accumulator);
+    state.read(head.statusByte);
+    state.read(steps);
+    head.steps = static_cast<size_t>(steps);
 }
 
 // Return a copy of the status of the CPU
@@ -49,38 +253,80 @@ debug::Cpu6502Debug Cpu6502::getDebugInfo() {
     output.pc = m_pc;
     output.stackPointer = m_stackPointer;
 
-    output.carryFlag = m_carryFlag;
-    output.zeroFlag = m_zeroFlag;
-    output.overflowFlag = m_overflowFlag;
-    output.negativeFlag = m_negativeFlag;
+    output.carryFlag = this->getFlag(FLAG_CARRY);
+    output.zeroFlag = this->zeroFlag();
+    output.overflowFlag = this->getFlag(FLAG_OVERFLOW);
+    output.negativeFlag = this->negativeFlag();
 
-    output.interruptDisable = m_interruptDisable;
-    output.decimalMode = m_decimalMode; 
+    output.interruptDisable = this->getFlag(FLAG_INTERRUPT);
+    output.decimalMode = this->getFlag(FLAG_DECIMAL); 
     output.breakCommand = false;
 
     output.statusByte = this->getStatusByte(false);
 
+    output.decodeCacheHits = m_decodeCacheHits;
+    output.decodeCacheLookups = m_decodeCacheLookups;
+
+    output.dynarecEnabled = m_dynarecEnabled;
+    output.dynarecBlocksRun = 0;
+    output.dynarecBlocksTranslated = 0;
+#if defined(NES_CPU_DYNAREC)
+    output.dynarecBlocksRun = mp_dynarec->blocksRun();
+    output.dynarecBlocksTranslated = mp_dynarec->blocksTranslated();
+#endif
+
+    output.idleCyclesSkipped = m_idleCyclesSkipped;
+
     return output;
 }
 
 // Convert the status register to a byte using the format of the original 6502
 uint8_t Cpu6502::getStatusByte(bool bFlag) {
-    uint8_t output = 0;
+    // C, I, D and V are already stored in place, N and Z
+    // are evaluated from the last result, bit 5 is always 1
+    uint8_t output = m_status | FLAG_UNUSED;
 
-    // Set the status bits to the right value
-    output |= static_cast<uint8_t>(m_carryFlag);
-    output |= static_cast<uint8_t>(m_zeroFlag) << 1;
-    output |= static_cast<uint8_t>(m_interruptDisable) << 2;
-    output |= static_cast<uint8_t>(m_decimalMode) << 3;
+    output |= static_cast<uint8_t>(this->zeroFlag()) << 1;
     output |= static_cast<uint8_t>(bFlag) << 4;
-    // Bit 5 is always 1
-    output |= 0b00100000;
-    output |= static_cast<uint8_t>(m_overflowFlag) << 6;
-    output |= static_cast<uint8_t>(m_negativeFlag) << 7;
+    output |= static_cast<uint8_t>(this->negativeFlag()) << 7;
 
     return output;
 }
 
+// Load the status register from a byte, the B flag and bit 5 are ignored
+void Cpu6502::setStatusByte(uint8_t status) {
+    m_status = status & (FLAG_CARRY | FLAG_INTERRUPT | FLAG_DECIMAL | FLAG_OVERFLOW);
+    this->setNegativeZero((status & FLAG_NEGATIVE) != 0, (status & FLAG_ZERO) != 0);
+}
+
+// Read and write the C, I, D and V flags
+inline bool Cpu6502::getFlag(uint8_t flag) {
+    return (m_status & flag) != 0;
+}
+inline void Cpu6502::setFlag(uint8_t flag, bool value) {
+    m_status = (m_status & ~flag) | (value ? flag : 0);
+}
+
+// Update carry and overflow with a single store
+inline void Cpu6502::setCarryOverflow(bool carry, bool overflow) {
+    m_status = (m_status & ~(FLAG_CARRY | FLAG_OVERFLOW)) | 
+        static_cast<uint8_t>(carry) | (static_cast<uint8_t>(overflow) << 6);
+}
+
+// Evaluate Z and N from the last result
+inline bool Cpu6502::zeroFlag() {
+    return (m_nzResult & 0x00FF) == 0;
+}
+inline bool Cpu6502::negativeFlag() {
+    return (m_nzResult & 0x0180) != 0;
+}
+
+// Build a result giving the requested Z and N flags, bit 8
+// is used to set N when the low byte must be zero
+inline void Cpu6502::setNegativeZero(bool negative, bool zero) {
+    m_nzResult = static_cast<uint16_t>(!zero) | (static_cast<uint16_t>(negative) << 8);
+}
+
 // Set the CPU program counter at the given address
 void Cpu6502::setProgramCounter(uint16_t addr) {
     m_pc = addr;
@@ -90,7 +336,7 @@ void Cpu6502::setProgramCounter(uint16_t addr) {
 // based on the disable interrupt flag
 Interrupt6502 Cpu6502::pollInterrupt(Interrupt6502 interrupt) {
     return static_cast<Interrupt6502>(
-        interrupt & (static_cast<int>(!m_interruptDisable) | NMI)
+        interrupt & (static_cast<int>(!this->getFlag(FLAG_INTERRUPT)) | NMI)
     );
 }
 
@@ -107,7 +353,7 @@ void Cpu6502::executeInterrupt(Interrupt6502 interrupt) {
         this->stackPush(this->getStatusByte(false));
 
         // Set the PC to the new address and update the I disable flag
-        m_interruptDisable = true;
+        this->setFlag(FLAG_INTERRUPT, true);
         m_pc = m_bus->read16(IRQ_BRK_VECTOR_ADDR);       
     } 
 
@@ -119,13 +365,13 @@ void Cpu6502::executeInterrupt(Interrupt6502 interrupt) {
         this->stackPush(this->getStatusByte(false));
 
         // Set the PC to the new address and update the I disable flag
-        m_interruptDisable = true;
+        this->setFlag(FLAG_INTERRUPT, true);
         m_pc = m_bus->read16(NMI_VECTOR_ADDR);       
     }
 }
 
 // Execute an instruction and return the number of cycle required
-size_t Cpu6502::step(Interrupt6502 interrupt) {
+size_t Cpu6502::step(Interrupt6502 interrupt, size_t syncCycles) {
     uint64_t startCycles = m_cpuCycle;
 
     // Poll the interrupt for the next instruction
@@ -133,11 +379,149 @@ size_t Cpu6502::step(Interrupt6502 interrupt) {
     // execution to avoid problems with instructions that set the interrupt disable flags
     interrupt = pollInterrupt(interrupt);
 
-    // Read OP code from the buffer and increment the program counter
-    uint8_t opCode = m_bus->read(m_pc);
+#if defined(NES_CPU_DYNAREC)
+    // Run a translated block when no interrupt is pending,
+    // blocks never access the I/O registers or start a DMA transfer
+    if (m_dynarecEnabled && interrupt == NOINT && mp_dynarec->run(startCycles + syncCycles))
+        return m_cpuCycle - startCycles;
+#else
+    (void)syncCycles;
+#endif
+
+#if defined(NES_CPU_DISPATCH_THREADED)
+    // Chain the instructions up to the sync cycles when no interrupt is pending,
+    // the PPU and the APU can't raise one before and only catch up after the step
+    uint64_t cycleLimit = interrupt == NOINT ? startCycles + syncCycles : startCycles;
+
+    // Stop if the op code halted the CPU
+    if (!this->runThreaded(cycleLimit))
+        return 0;
+#else
+    // Execute the instruction from the decoded instructions cache
+    // or fetch it from the bus and dispatch it
+    if (!this->executeDecoded()) {
+        // Read OP code and operand from the buffer and increment the program counter
+        uint16_t pc = m_pc;
+        uint8_t opCode = m_bus->read(m_pc);
+        this->fetchOperand(opCode);
+        m_pc++;
+
+        this->storeDecoded(pc, opCode);
+
+        // Execute instruction
+#if defined(NES_CPU_DISPATCH_SWITCH)
+        bool running = this->dispatchSwitch(opCode);
+#else
+        bool running = this->dispatchTable(opCode);
+#endif
+
+        // Stop if the op code halted the CPU
+        if (!running)
+            return 0;
+    }
+#endif
+
+    // Execute interrupt if one was received during the last instruction
+    // and increment the cycle counter
+    executeInterrupt(interrupt);
+
+    // Check if the DMA was active
+    if (m_bus->dmaCycles())
+        // Add an aliment cycle on odd CPU cycles
+        m_cpuCycle += m_cpuCycle % 2 ? 514 : 513;
+
+    // Return the number of cycle and update CPU cycle counter
+    return m_cpuCycle - startCycles;
+}
+
+// Read the operand of the given op code at the program counter
+// Immediate operands are read by the instruction from their address
+inline void Cpu6502::fetchOperand(uint8_t opCode) {
+    const OpcodeInfo6502& info = OPCODE_INFO_6502[opCode];
+
+    if (info.mode == ADDR_IMM)
+        return;
+
+    switch (operandBytes(info.mode)) {
+        case 1:
+            m_operand = m_bus->read(m_pc + 1); break;
+        case 2:
+            m_operand = m_bus->read16(m_pc + 1); break;
+    }
+}
+
+// Return true if the instruction at the program counter is in the cache
+inline bool Cpu6502::decodedHit() {
+#if defined(NES_CPU_DECODE_CACHE)
+    m_decodeCacheLookups++;
+
+    // Only PRG ROM is cached
+    if (m_pc < 0x8000 || m_bus->mp_cartridge == nullptr)
+        return false;
+
+    // Check the cache tag
+    DecodedInstruction& decoded = mp_decodeCache[m_pc & (DECODE_CACHE_SIZE - 1)];
+    if (decoded.handler == nullptr || decoded.pc != m_pc)
+        return false;
+    if (decoded.bank != m_bus->mp_cartridge->prgBank(m_pc))
+        return false;
+
+    m_decodeCacheHits++;
+    return true;
+#else
+    return false;
+#endif
+}
+
+// Execute the instruction at the program counter if it's in the cache
+inline bool Cpu6502::executeDecoded() {
+#if defined(NES_CPU_DECODE_CACHE)
+    if (!this->decodedHit())
+        return false;
+
+    // Execute the instruction with the cached operand
+    DecodedInstruction& decoded = mp_decodeCache[m_pc & (DECODE_CACHE_SIZE - 1)];
+
+    m_operand = decoded.operand;
     m_pc++;
 
-    // Execute instruction
+    decoded.handler(this);
+    m_cpuCycle += decoded.cycles;
+
+    return true;
+#else
+    return false;
+#endif
+}
+
+// Store the instruction just fetched at the given address in the cache
+inline void Cpu6502::storeDecoded(uint16_t pc, uint8_t opCode) {
+#if defined(NES_CPU_DECODE_CACHE)
+    const OpcodeInfo6502& info = OPCODE_INFO_6502[opCode];
+
+    // Only PRG ROM is cached, op codes that stop the CPU are never cached
+    if (pc < 0x8000 || m_bus->mp_cartridge == nullptr || info.cycles == 0)
+        return;
+
+    // Don't cache instructions crossing a PRG bank boundary
+    uint16_t lastAddr = pc + operandBytes(info.mode);
+    if ((lastAddr & 0xE000) != (pc & 0xE000))
+        return;
+
+    DecodedInstruction& decoded = mp_decodeCache[pc & (DECODE_CACHE_SIZE - 1)];
+    decoded.handler = s_opHandlers[opCode];
+    decoded.opCode = opCode;
+    decoded.pc = pc;
+    decoded.bank = m_bus->mp_cartridge->prgBank(pc);
+    decoded.operand = m_operand;
+    decoded.cycles = info.cycles;
+#else
+    (void)pc; (void)opCode;
+#endif
+}
+
+// Switch based dispatch engine
+inline bool Cpu6502::dispatchSwitch(uint8_t opCode) {
     switch (opCode) {
         // Loads instructions
         //
@@ -657,27 +1041,13 @@ size_t Cpu6502::step(Interrupt6502 interrupt) {
         // JAM instructions (Stop execution and halt the CPU)
         case 0x02: case 0x12: case 0x22: case 0x32: case 0x42: case 0x52: 
         case 0x62: case 0x72: case 0x92: case 0xB2: case 0xD2: case 0xF2: 
-            std::cout << "CPU: Halted at instruction: " << utility::paddedHex(opCode, 2);
-            std::cout << std::endl;
-            m_pc--; return 0;
+            this->JAM(); return false;
 
         default:
-            std::cout << "CPU: Unknow instruction: " << utility::paddedHex(opCode, 2);
-            std::cout << std::endl;
-            return 0;
+            this->UNK(); return false;
     }
 
-    // Execute interrupt if one was received during the last instruction
-    // and increment the cycle counter
-    executeInterrupt(interrupt);
-
-    // Check if the DMA was active
-    if (m_bus->dmaCycles())
-        // Add an aliment cycle on odd CPU cycles
-        m_cpuCycle += m_cpuCycle % 2 ? 514 : 513;
-
-    // Return the number of cycle and update CPU cycle counter
-    return m_cpuCycle - startCycles;
+    return true;
 }
 
 /*
@@ -698,14 +1068,14 @@ inline uint16_t Cpu6502::getImmediateAddr() {
 // Zero page addressing
 inline uint16_t Cpu6502::getZeroPageAddr() {
     // Get address and update program counter
-    uint16_t address = static_cast<uint16_t>(m_bus->read(m_pc));
+    uint16_t address = m_operand & 0x00FF;
     m_pc++;
 
     return address;
 }
 inline uint16_t Cpu6502::getZeroPageXAddr() {
     // Get address and update program counter
-    uint16_t address = static_cast<uint16_t>(m_bus->read(m_pc));
+    uint16_t address = m_operand & 0x00FF;
     address = (address + m_regX) & 0xFF;
     m_pc++;
 
@@ -713,7 +1083,7 @@ inline uint16_t Cpu6502::getZeroPageXAddr() {
 }
 inline uint16_t Cpu6502::getZeroPageYAddr() {
     // Get address and update program counter
-    uint16_t address = static_cast<uint16_t>(m_bus->read(m_pc));
+    uint16_t address = m_operand & 0x00FF;
     address = (address + m_regY) & 0xFF;
     m_pc++;
 
@@ -723,14 +1093,14 @@ inline uint16_t Cpu6502::getZeroPageYAddr() {
 // Absolute addressing
 inline uint16_t Cpu6502::getAbsoluteAddr() {
     // Get value and update program counter
-    uint16_t address = m_bus->read16(m_pc);
+    uint16_t address = m_operand;
     m_pc += 2;
 
     return address;
 }
 inline uint16_t Cpu6502::getAbsoluteXAddr(bool pageCrossAddCycle) {
     // Get value and update program counter
-    uint16_t address = m_bus->read16(m_pc);
+    uint16_t address = m_operand;
     m_pc += 2;
 
     // Branch less page crossing check 
@@ -741,7 +1111,7 @@ inline uint16_t Cpu6502::getAbsoluteXAddr(bool pageCrossAddCycle) {
 }
 inline uint16_t Cpu6502::getAbsoluteYAddr(bool pageCrossAddCycle) {
     // Get value and update program counter
-    uint16_t address = m_bus->read16(m_pc);
+    uint16_t address = m_operand;
     m_pc += 2;
 
     // Branch less page crossing check 
@@ -754,7 +1124,7 @@ inline uint16_t Cpu6502::getAbsoluteYAddr(bool pageCrossAddCycle) {
 // Indirect addressing
 inline uint16_t Cpu6502::getIndirectAddr() {
     // Get address and update program counter
-    uint16_t address = m_bus->read16(m_pc);
+    uint16_t address = m_operand;
     m_pc += 2;
 
     return m_bus->read16PageWrap(address);
@@ -762,7 +1132,7 @@ inline uint16_t Cpu6502::getIndirectAddr() {
 }
 inline uint16_t Cpu6502::getIndexedIndirectAddr() {
     // Get address and update program counter
-    uint16_t address = static_cast<uint16_t>(m_bus->read(m_pc));
+    uint16_t address = m_operand & 0x00FF;
     address = (address + m_regX) & 0x00FF;
     m_pc++;
 
@@ -770,7 +1140,7 @@ inline uint16_t Cpu6502::getIndexedIndirectAddr() {
 }
 inline uint16_t Cpu6502::getIndirectIndexedAddr(bool pageCrossAddCycle) {
     // Get address and update program counter
-    uint16_t address = static_cast<uint16_t>(m_bus->read(m_pc));
+    uint16_t address = m_operand & 0x00FF;
     address = m_bus->read16PageWrap(address);
     m_pc++;
 
@@ -784,7 +1154,7 @@ inline uint16_t Cpu6502::getIndirectIndexedAddr(bool pageCrossAddCycle) {
 // Relative addressing for branch operations
 inline int8_t Cpu6502::getRelative() {
     // Get value and update program counter
-    int8_t result = static_cast<int8_t>(m_bus->read(m_pc));
+    int8_t result = static_cast<int8_t>(m_operand & 0x00FF);
     m_pc++;
 
     return result;
@@ -847,20 +1217,14 @@ inline void Cpu6502::PLA() {
     m_accumulator = this->stackPop();
     
     // Update status registers
-    m_zeroFlag = m_accumulator == 0x00;
-    m_negativeFlag = (m_accumulator & 0b10000000) != 0;
+    m_nzResult = m_accumulator;
 }
 // Pull the processor status from the stack
 inline void Cpu6502::PLP() {
     uint8_t status = this->stackPop();
 
     // Update the status register
-    m_carryFlag = static_cast<bool>(status & 0b00000001);
-    m_zeroFlag = static_cast<bool>(status & 0b00000010);
-    m_interruptDisable = static_cast<bool>(status & 0b00000100);
-    m_decimalMode = static_cast<bool>(status & 0b00001000);
-    m_overflowFlag = static_cast<bool>(status & 0b01000000);
-    m_negativeFlag = static_cast<bool>(status & 0b10000000);
+    this->setStatusByte(status);
 }
 
 /*
@@ -877,8 +1241,7 @@ inline void Cpu6502::AND(uint16_t addr) {
     m_accumulator &= memValue;
 
     // Update status registers
-    m_zeroFlag = m_accumulator == 0x00;
-    m_negativeFlag = (m_accumulator & 0b10000000) != 0;
+    m_nzResult = m_accumulator;
 }
  
 // Perform an EOR operation on the accumulator with a byte from memory
@@ -889,8 +1252,7 @@ inline void Cpu6502::EOR(uint16_t addr) {
     m_accumulator ^= memValue;
 
     // Update status registers
-    m_zeroFlag = m_accumulator == 0x00;
-    m_negativeFlag = (m_accumulator & 0b10000000) != 0;
+    m_nzResult = m_accumulator;
 }
  
 // Perform an ORA operation on the accumulator with a byte from memory
@@ -901,8 +1263,7 @@ inline void Cpu6502::ORA(uint16_t addr) {
     m_accumulator |= memValue;
 
     // Update status registers
-    m_zeroFlag = m_accumulator == 0x00;
-    m_negativeFlag = (m_accumulator & 0b10000000) != 0;
+    m_nzResult = m_accumulator;
 }
 
 // Get a number from the bus and mask it with the accumulator 
@@ -912,9 +1273,8 @@ inline void Cpu6502::BIT(uint16_t addr) {
     uint8_t memValue = m_bus->read(addr);
 
     // Update status registers
-    m_zeroFlag = (memValue & m_accumulator) == 0x00;
-    m_negativeFlag = (memValue & 0b10000000) != 0;
-    m_overflowFlag = (memValue & 0b01000000) != 0;
+    this->setNegativeZero((memValue & 0b10000000) != 0, (memValue & m_accumulator) == 0x00);
+    this->setFlag(FLAG_OVERFLOW, (memValue & 0b01000000) != 0);
 }
 
 /*
@@ -928,15 +1288,16 @@ inline void Cpu6502::ADC(uint16_t addr) {
     // Add memory data, accumulator and carry
     uint8_t memValue = m_bus->read(addr);
     uint16_t result = static_cast<uint16_t>(memValue) + m_accumulator;
-    result += static_cast<uint16_t>(m_carryFlag);
+    result += static_cast<uint16_t>(this->getFlag(FLAG_CARRY));
 
     // Save result to the accumulator and update the status flags 
-    m_zeroFlag = (result & 0x00FF) == 0x00;
-    m_carryFlag = (result & 0xFF00) != 0;
-    m_negativeFlag = (result & 0b10000000) != 0; 
-    m_overflowFlag = ((memValue ^ result) & (m_accumulator ^ result) & 0b10000000) != 0;
+    this->setCarryOverflow(
+        (result & 0xFF00) != 0,
+        ((memValue ^ result) & (m_accumulator ^ result) & 0b10000000) != 0
+    );
 
     m_accumulator = result & 0x00FF;
+    m_nzResult = m_accumulator;
 }
 
 // Add with carry operation
@@ -945,14 +1306,15 @@ inline void Cpu6502::SBC(uint16_t addr) {
     uint8_t memValue = m_bus->read(addr);
     uint8_t accumulatorInput = m_accumulator;
     uint16_t result = m_accumulator - static_cast<uint16_t>(memValue);
-    result -= static_cast<uint16_t>(!m_carryFlag);
+    result -= static_cast<uint16_t>(!this->getFlag(FLAG_CARRY));
 
     // Save result to the accumulator and update the status flags 
     m_accumulator = result & 0x00FF;
-    m_zeroFlag = m_accumulator == 0x00;
-    m_carryFlag = (result & 0xFF00) == 0;
-    m_negativeFlag = (result & 0b10000000) != 0; 
-    m_overflowFlag = (((0xFF - memValue) ^ result) & (accumulatorInput ^ result) & 0b10000000) != 0;
+    m_nzResult = m_accumulator;
+    this->setCarryOverflow(
+        (result & 0xFF00) == 0,
+        (((0xFF - memValue) ^ result) & (accumulatorInput ^ result) & 0b10000000) != 0
+    );
 }
 
 // Compare the accumulator value with a memory value
@@ -960,30 +1322,27 @@ inline void Cpu6502::CMP(uint16_t addr) {
     uint8_t memValue = m_bus->read(addr);
     uint8_t result = m_accumulator - static_cast<uint16_t>(memValue);
 
-    // Update the flags
-    m_negativeFlag = (result & 0b10000000) != 0; 
-    m_carryFlag = m_accumulator >= memValue;
-    m_zeroFlag = m_accumulator == memValue;
+    // Update the flags, the result is zero only if the values are equal
+    m_nzResult = result;
+    this->setFlag(FLAG_CARRY, m_accumulator >= memValue);
 }
 // Compare the accumulator value with a memory value
 inline void Cpu6502::CPX(uint16_t addr) {
     uint8_t memValue = m_bus->read(addr);
     uint8_t result = m_regX - static_cast<uint16_t>(memValue);
 
-    // Update the flags
-    m_negativeFlag = (result & 0b10000000) != 0; 
-    m_carryFlag = m_regX >= memValue;
-    m_zeroFlag = m_regX == memValue;
+    // Update the flags, the result is zero only if the values are equal
+    m_nzResult = result;
+    this->setFlag(FLAG_CARRY, m_regX >= memValue);
 }
 // Compare the accumulator value with a memory value
 inline void Cpu6502::CPY(uint16_t addr) {
     uint8_t memValue = m_bus->read(addr);
     uint8_t result = m_regY - static_cast<uint16_t>(memValue);
 
-    // Update the flags
-    m_negativeFlag = (result & 0b10000000) != 0; 
-    m_carryFlag = m_regY >= memValue;
-    m_zeroFlag = m_regY == memValue;
+    // Update the flags, the result is zero only if the values are equal
+    m_nzResult = result;
+    this->setFlag(FLAG_CARRY, m_regY >= memValue);
 }
 
 /*
@@ -1000,9 +1359,8 @@ inline void Cpu6502::ASL(uint16_t addr) {
     m_bus->write(addr, result);
 
     // Update CPU status 
-    m_carryFlag = (value & 0b10000000) != 0;
-    m_negativeFlag = (result & 0b10000000) != 0;
-    m_zeroFlag = result == 0x00;
+    this->setFlag(FLAG_CARRY, (value & 0b10000000) != 0);
+    m_nzResult = result;
 }
 // Shift left a byte of memory in the accumulator 
 inline void Cpu6502::ASL() {
@@ -1011,9 +1369,8 @@ inline void Cpu6502::ASL() {
     m_accumulator = value << 1;
 
     // Update CPU status 
-    m_carryFlag = (value & 0b10000000) != 0;
-    m_negativeFlag = (m_accumulator & 0b10000000) != 0;
-    m_zeroFlag = m_accumulator == 0x00;
+    this->setFlag(FLAG_CARRY, (value & 0b10000000) != 0);
+    m_nzResult = m_accumulator;
 }
 
 // Shift right a byte of memory on the bus 
@@ -1024,9 +1381,8 @@ inline void Cpu6502::LSR(uint16_t addr) {
     m_bus->write(addr, result);
 
     // Update CPU status 
-    m_carryFlag = (value & 0b00000001) != 0;
-    m_negativeFlag = (result & 0b10000000) != 0;
-    m_zeroFlag = result == 0x00;
+    this->setFlag(FLAG_CARRY, (value & 0b00000001) != 0);
+    m_nzResult = result;
 }
 // Shift right a byte of memory in the accumulator 
 inline void Cpu6502::LSR() {
@@ -1035,57 +1391,52 @@ inline void Cpu6502::LSR() {
     m_accumulator = value >> 1;
 
     // Update CPU status 
-    m_carryFlag = (value & 0b00000001) != 0;
-    m_negativeFlag = (m_accumulator & 0b10000000) != 0;
-    m_zeroFlag = m_accumulator == 0x00;
+    this->setFlag(FLAG_CARRY, (value & 0b00000001) != 0);
+    m_nzResult = m_accumulator;
 }
 
 // Roll left a byte of memory on the bus 
 inline void Cpu6502::ROL(uint16_t addr) {
     // Perform the shift
     uint8_t value = m_bus->read(addr);
-    uint8_t result = (value << 1) | static_cast<uint8_t>(m_carryFlag);
+    uint8_t result = (value << 1) | (m_status & FLAG_CARRY);
     m_bus->write(addr, result);
 
     // Update CPU status 
-    m_carryFlag = (value & 0b10000000) != 0;
-    m_negativeFlag = (result & 0b10000000) != 0;
-    m_zeroFlag = result == 0x00;
+    this->setFlag(FLAG_CARRY, (value & 0b10000000) != 0);
+    m_nzResult = result;
 }
 // Roll left a byte of memory in the accumulator 
 inline void Cpu6502::ROL() {
     // Perform the shift
     uint8_t value = m_accumulator;
-    m_accumulator = (value << 1) | static_cast<uint8_t>(m_carryFlag);
+    m_accumulator = (value << 1) | (m_status & FLAG_CARRY);
 
     // Update CPU status 
-    m_carryFlag = (value & 0b10000000) != 0;
-    m_negativeFlag = (m_accumulator & 0b10000000) != 0;
-    m_zeroFlag = m_accumulator == 0x00;
+    this->setFlag(FLAG_CARRY, (value & 0b10000000) != 0);
+    m_nzResult = m_accumulator;
 }
 
 // Roll right a byte of memory on the bus 
 inline void Cpu6502::ROR(uint16_t addr) {
     // Perform the shift
     uint8_t value = m_bus->read(addr);
-    uint8_t result = (value >> 1) | (static_cast<uint8_t>(m_carryFlag) << 7);
+    uint8_t result = (value >> 1) | ((m_status & FLAG_CARRY) << 7);
     m_bus->write(addr, result);
 
     // Update CPU status 
-    m_carryFlag = (value & 0b00000001) != 0;
-    m_negativeFlag = (result & 0b10000000) != 0;
-    m_zeroFlag = result == 0x00;
+    this->setFlag(FLAG_CARRY, (value & 0b00000001) != 0);
+    m_nzResult = result;
 }
 // Roll right a byte of memory in the accumulator 
 inline void Cpu6502::ROR() {
     // Perform the shift
     uint8_t value = m_accumulator;
-    m_accumulator = (value >> 1) | (static_cast<uint8_t>(m_carryFlag) << 7);
+    m_accumulator = (value >> 1) | ((m_status & FLAG_CARRY) << 7);
 
     // Update CPU status 
-    m_carryFlag = (value & 0b00000001) != 0;
-    m_negativeFlag = (m_accumulator & 0b10000000) != 0;
-    m_zeroFlag = m_accumulator == 0x00;
+    this->setFlag(FLAG_CARRY, (value & 0b00000001) != 0);
+    m_nzResult = m_accumulator;
 }
 
 /*
@@ -1099,24 +1450,21 @@ inline void Cpu6502::LDA(uint16_t addr) {
     m_accumulator = m_bus->read(addr);
 
     // Update status registers
-    m_zeroFlag = m_accumulator == 0x00;
-    m_negativeFlag = (m_accumulator & 0b10000000) != 0;
+    m_nzResult = m_accumulator;
 }
 // Load a byte of memory into the X register and update the status flags
 inline void Cpu6502::LDX(uint16_t addr) {
     m_regX = m_bus->read(addr);
 
     // Update status registers
-    m_zeroFlag = m_regX == 0x00;
-    m_negativeFlag = (m_regX & 0b10000000) != 0;
+    m_nzResult = m_regX;
 }
 // Load a byte of memory into the Y register and update the status flags
 inline void Cpu6502::LDY(uint16_t addr) {
     m_regY = m_bus->read(addr);
 
     // Update status registers
-    m_zeroFlag = m_regY == 0x00;
-    m_negativeFlag = (m_regY & 0b10000000) != 0;
+    m_nzResult = m_regY;
 }
 
 // Save the value byte stored in the accumulator to an address of the bus
@@ -1140,7 +1488,7 @@ inline void Cpu6502::STY(uint16_t addr) {
 
 // Branch if carry flag is clear
 inline void Cpu6502::BCC(int8_t offset) {
-    if (!m_carryFlag) {
+    if (!this->getFlag(FLAG_CARRY)) {
         uint16_t address = m_pc;
         m_cpuCycle++;
         
@@ -1153,7 +1501,7 @@ inline void Cpu6502::BCC(int8_t offset) {
 }
 // Branch if carry flag is set
 inline void Cpu6502::BCS(int8_t offset) {
-    if (m_carryFlag) {
+    if (this->getFlag(FLAG_CARRY)) {
         uint16_t address = m_pc;
         m_cpuCycle++;
         
@@ -1167,7 +1515,7 @@ inline void Cpu6502::BCS(int8_t offset) {
 
 // Branch if negative flags is clear
 inline void Cpu6502::BPL(int8_t offset) {
-    if (!m_negativeFlag) {
+    if (!this->negativeFlag()) {
         uint16_t address = m_pc;
         m_cpuCycle++;
         
@@ -1180,7 +1528,7 @@ inline void Cpu6502::BPL(int8_t offset) {
 }
 // Branch if negative flags is set
 inline void Cpu6502::BMI(int8_t offset) {
-    if (m_negativeFlag) {
+    if (this->negativeFlag()) {
         uint16_t address = m_pc;
         m_cpuCycle++;
         
@@ -1194,7 +1542,7 @@ inline void Cpu6502::BMI(int8_t offset) {
 
 // Branch if zero flags is clear
 inline void Cpu6502::BNE(int8_t offset) {
-    if (!m_zeroFlag) {
+    if (!this->zeroFlag()) {
         uint16_t address = m_pc;
         m_cpuCycle++;
         
@@ -1207,7 +1555,7 @@ inline void Cpu6502::BNE(int8_t offset) {
 }
 // Branch if zero flags is set
 inline void Cpu6502::BEQ(int8_t offset) {
-    if (m_zeroFlag) {
+    if (this->zeroFlag()) {
         uint16_t address = m_pc;
         m_cpuCycle++;
         
@@ -1221,7 +1569,7 @@ inline void Cpu6502::BEQ(int8_t offset) {
 
 // Branch if overflow flags is clear
 inline void Cpu6502::BVC(int8_t offset) {
-    if (!m_overflowFlag) {
+    if (!this->getFlag(FLAG_OVERFLOW)) {
         uint16_t address = m_pc;
         m_cpuCycle++;
         
@@ -1234,7 +1582,7 @@ inline void Cpu6502::BVC(int8_t offset) {
 }
 // Branch if overflow flags is set
 inline void Cpu6502::BVS(int8_t offset) {
-    if (m_overflowFlag) {
+    if (this->getFlag(FLAG_OVERFLOW)) {
         uint16_t address = m_pc;
         m_cpuCycle++;
         
@@ -1257,32 +1605,28 @@ inline void Cpu6502::TAX() {
     m_regX = m_accumulator;
 
     // Update status registers
-    m_zeroFlag = m_regX == 0x00;
-    m_negativeFlag = (m_regX & 0b10000000) != 0;
+    m_nzResult = m_regX;
 }
 // Copy the value in the accumulator to the register Y
 inline void Cpu6502::TAY() {
     m_regY = m_accumulator;
 
     // Update status registers
-    m_zeroFlag = m_regY == 0x00;
-    m_negativeFlag = (m_regY & 0b10000000) != 0;
+    m_nzResult = m_regY;
 }
 // Copy the value in the register X in the accumulator
 inline void Cpu6502::TXA() {
     m_accumulator = m_regX;
 
     // Update status registers
-    m_zeroFlag = m_accumulator == 0x00;
-    m_negativeFlag = (m_accumulator & 0b10000000) != 0;
+    m_nzResult = m_accumulator;
 }
 // Copy the value in the register Y in the accumulator
 inline void Cpu6502::TYA() {
     m_accumulator = m_regY;
 
     // Update status registers
-    m_zeroFlag = m_accumulator == 0x00;
-    m_negativeFlag = (m_accumulator & 0b10000000) != 0;
+    m_nzResult = m_accumulator;
 }
 
 // Copy the value in the stack pointer to the register X
@@ -1290,8 +1634,7 @@ inline void Cpu6502::TSX() {
     m_regX = m_stackPointer;
 
     // Update status registers
-    m_zeroFlag = m_regX == 0x00;
-    m_negativeFlag = (m_regX & 0b10000000) != 0;
+    m_nzResult = m_regX;
 }
 // Copy the value in the register X to the stack pointer
 inline void Cpu6502::TXS() {
@@ -1311,8 +1654,7 @@ inline void Cpu6502::INC(uint16_t addr) {
     m_bus->write(addr, result);
 
     // Update status register
-    m_zeroFlag = result == 0x00;
-    m_negativeFlag = (result & 0b10000000) != 0;
+    m_nzResult = result;
 }
 // Decrements the value to the given memory address
 // and update the status register
@@ -1321,8 +1663,7 @@ inline void Cpu6502::DEC(uint16_t addr) {
     m_bus->write(addr, result);
 
     // Update status register
-    m_zeroFlag = result == 0x00;
-    m_negativeFlag = (result & 0b10000000) != 0;
+    m_nzResult = result;
 }
 
 // Increment the value in the X register
@@ -1331,8 +1672,7 @@ inline void Cpu6502::INX() {
     m_regX += 1;
 
     // Update status register
-    m_zeroFlag = m_regX == 0x00;
-    m_negativeFlag = (m_regX & 0b10000000) != 0;
+    m_nzResult = m_regX;
 }
 // Decrements the value in the X register
 // and update the status register
@@ -1340,8 +1680,7 @@ inline void Cpu6502::DEX() {
     m_regX -= 1;
 
     // Update status register
-    m_zeroFlag = m_regX == 0x00;
-    m_negativeFlag = (m_regX & 0b10000000) != 0;
+    m_nzResult = m_regX;
 }
 
 // Increment the value in the Y register
@@ -1350,8 +1689,7 @@ inline void Cpu6502::INY() {
     m_regY += 1;
 
     // Update status register
-    m_zeroFlag = m_regY == 0x00;
-    m_negativeFlag = (m_regY & 0b10000000) != 0;
+    m_nzResult = m_regY;
 }
 // Decrements the value in the Y register
 // and update the status register
@@ -1359,8 +1697,7 @@ inline void Cpu6502::DEY() {
     m_regY -= 1;
 
     // Update status register
-    m_zeroFlag = m_regY == 0x00;
-    m_negativeFlag = (m_regY & 0b10000000) != 0;
+    m_nzResult = m_regY;
 }
 
 /*
@@ -1371,32 +1708,32 @@ inline void Cpu6502::DEY() {
 
 // Clear the carry flag
 inline void Cpu6502::CLC() {
-    m_carryFlag = false;
+    this->setFlag(FLAG_CARRY, false);
 }
 // Clear the decimal mode flag
 inline void Cpu6502::CLD() {
-    m_decimalMode = false;
+    this->setFlag(FLAG_DECIMAL, false);
 }
 // Clear the interrupt disable flag
 inline void Cpu6502::CLI() {
-    m_interruptDisable = false;
+    this->setFlag(FLAG_INTERRUPT, false);
 }
 // Clear the overflow flag
 inline void Cpu6502::CLV() {
-    m_overflowFlag = false;
+    this->setFlag(FLAG_OVERFLOW, false);
 }
 
 // Set the carry flag
 inline void Cpu6502::SEC() {
-    m_carryFlag = true;
+    this->setFlag(FLAG_CARRY, true);
 }
 // Set the decimal mode flag
 inline void Cpu6502::SED() {
-    m_decimalMode = true;
+    this->setFlag(FLAG_DECIMAL, true);
 }
 // Set the interrupt disable flag
 inline void Cpu6502::SEI() {
-    m_interruptDisable = true;
+    this->setFlag(FLAG_INTERRUPT, true);
 }
 
 /*
@@ -1412,7 +1749,7 @@ inline void Cpu6502::BRK() {
     this->stackPush(this->getStatusByte(true));
 
     // Set the interrupt disable flag 
-    m_interruptDisable = true;
+    this->setFlag(FLAG_INTERRUPT, true);
 
     m_pc = m_bus->read16(IRQ_BRK_VECTOR_ADDR);
 }
@@ -1462,8 +1799,7 @@ inline void Cpu6502::LAX(uint16_t addr) {
 
     // Update status registers
     // WRONG
-    m_zeroFlag = value == 0x00;
-    m_negativeFlag = (value & 0b10000000) != 0;
+    m_nzResult = value;
 }
 
 // Perform an AND operation between the accumulator and X register and store the result in memory
@@ -1481,9 +1817,8 @@ inline void Cpu6502::DCP(uint16_t addr) {
     uint8_t cmpResult = m_accumulator - static_cast<uint16_t>(memValue);
 
     // Update the flags
-    m_negativeFlag = (cmpResult & 0b10000000) != 0; 
-    m_carryFlag = m_accumulator >= memValue;
-    m_zeroFlag = m_accumulator == memValue;
+    m_nzResult = cmpResult;
+    this->setFlag(FLAG_CARRY, m_accumulator >= memValue);
 }
 
 // Perform an increment and then subtract the value in memory to the accumulator
@@ -1495,14 +1830,15 @@ inline void Cpu6502::ISC(uint16_t addr) {
 
     uint8_t accumulatorInput = m_accumulator;
     uint16_t result = m_accumulator - static_cast<uint16_t>(memValue);
-    result -= static_cast<uint16_t>(!m_carryFlag);
+    result -= static_cast<uint16_t>(!this->getFlag(FLAG_CARRY));
 
     // Save result to the accumulator and update the status flags 
     m_accumulator = result & 0x00FF;
-    m_zeroFlag = m_accumulator == 0x00;
-    m_carryFlag = (result & 0xFF00) == 0;
-    m_negativeFlag = (result & 0b10000000) != 0; 
-    m_overflowFlag = (((0xFF - memValue) ^ result) & (accumulatorInput ^ result) & 0b10000000) != 0;
+    m_nzResult = m_accumulator;
+    this->setCarryOverflow(
+        (result & 0xFF00) == 0,
+        (((0xFF - memValue) ^ result) & (accumulatorInput ^ result) & 0b10000000) != 0
+    );
 }
 
 // Shift left one bit in memory, then OR accumulator with memory
@@ -1516,28 +1852,26 @@ inline void Cpu6502::SLO(uint16_t addr) {
     m_accumulator = m_accumulator | result;
 
     // Update CPU status 
-    m_carryFlag = (value & 0b10000000) != 0;
-    m_negativeFlag = (m_accumulator & 0b10000000) != 0;
-    m_zeroFlag = m_accumulator == 0x00;
+    this->setFlag(FLAG_CARRY, (value & 0b10000000) != 0);
+    m_nzResult = m_accumulator;
 }
 
 // Roll left one bit in memory, then AND accumulator with memory
 inline void Cpu6502::RLA(uint16_t addr) {
     // Perform the shift
     uint8_t value = m_bus->read(addr);
-    uint8_t result = (value << 1) | static_cast<uint8_t>(m_carryFlag);
+    uint8_t result = (value << 1) | (m_status & FLAG_CARRY);
     m_bus->write(addr, result);
 
     // AND between result and accumulator
     m_accumulator = m_accumulator & result;
 
     // Update CPU status 
-    m_carryFlag = (value & 0b10000000) != 0;
-    m_negativeFlag = (m_accumulator & 0b10000000) != 0;
-    m_zeroFlag = m_accumulator == 0x00;
+    this->setFlag(FLAG_CARRY, (value & 0b10000000) != 0);
+    m_nzResult = m_accumulator;
 
     // Update CPU status 
-    m_carryFlag = (value & 0b10000000) != 0;
+    this->setFlag(FLAG_CARRY, (value & 0b10000000) != 0);
 }
 
 // Shift right one bit in memory, then XOR accumulator with memory
@@ -1551,30 +1885,236 @@ inline void Cpu6502::SRE(uint16_t addr) {
     m_accumulator = m_accumulator ^ result;
 
     // Update CPU status 
-    m_carryFlag = (value & 0b00000001) != 0;
-    m_negativeFlag = (m_accumulator & 0b10000000) != 0;
-    m_zeroFlag = m_accumulator == 0x00;
+    this->setFlag(FLAG_CARRY, (value & 0b00000001) != 0);
+    m_nzResult = m_accumulator;
 }
 
 // Roll right one bit in memory, then XOR accumulator with memory
 inline void Cpu6502::RRA(uint16_t addr) {
     // Perform the shift
     uint8_t value = m_bus->read(addr);
-    uint8_t rollResult = (value >> 1) | (static_cast<uint8_t>(m_carryFlag) << 7);
+    uint8_t rollResult = (value >> 1) | ((m_status & FLAG_CARRY) << 7);
     m_bus->write(addr, rollResult);
 
     // ADD between result and accumulator
-    m_carryFlag = (value & 0b00000001) != 0;
+    this->setFlag(FLAG_CARRY, (value & 0b00000001) != 0);
     uint16_t result = static_cast<uint16_t>(rollResult) + m_accumulator;
-    result += static_cast<uint16_t>(m_carryFlag);
+    result += static_cast<uint16_t>(this->getFlag(FLAG_CARRY));
 
     // Save result to the accumulator and update the status flags 
-    m_zeroFlag = (result & 0x00FF) == 0x00;
-    m_carryFlag = (result & 0xFF00) != 0;
-    m_negativeFlag = (result & 0b10000000) != 0; 
-    m_overflowFlag = ((rollResult ^ result) & (m_accumulator ^ result) & 0b10000000) != 0;
+    this->setCarryOverflow(
+        (result & 0xFF00) != 0,
+        ((rollResult ^ result) & (m_accumulator ^ result) & 0b10000000) != 0
+    );
 
     m_accumulator = result & 0x00FF;
+    m_nzResult = m_accumulator;
+}
+
+// No operation
+inline void Cpu6502::NOP() {}
+// No operation, the operand is fetched by the addressing mode
+inline void Cpu6502::NOP(uint16_t) {}
+
+// Halt the CPU by keeping the program counter on the current instruction
+inline void Cpu6502::JAM() {
+    m_pc--;
+
+    std::cout << "CPU: Halted at instruction: ";
+    std::cout << utility::paddedHex(m_bus->read(m_pc, true), 2) << std::endl;
+}
+
+// Unsupported op code, skip it
+inline void Cpu6502::UNK() {
+    std::cout << "CPU: Unknow instruction: ";
+    std::cout << utility::paddedHex(m_bus->read(m_pc - 1, true), 2) << std::endl;
 }
 }
 
+// Implement the dispatch engines
+namespace nesCore {
+/*
+ *
+ *  Opcode handlers
+ *
+*/
+
+// Fetch the operand for each addressing mode and execute the instruction
+#define CPU6502_OPERAND_IMP(instruction, pageCross) cpu->instruction()
+#define CPU6502_OPERAND_ACC(instruction, pageCross) cpu->instruction()
+#define CPU6502_OPERAND_IMM(instruction, pageCross) cpu->instruction(cpu->getImmediateAddr())
+#define CPU6502_OPERAND_ZP0(instruction, pageCross) cpu->instruction(cpu->getZeroPageAddr())
+#define CPU6502_OPERAND_ZPX(instruction, pageCross) cpu->instruction(cpu->getZeroPageXAddr())
+#define CPU6502_OPERAND_ZPY(instruction, pageCross) cpu->instruction(cpu->getZeroPageYAddr())
+#define CPU6502_OPERAND_ABS(instruction, pageCross) cpu->instruction(cpu->getAbsoluteAddr())
+#define CPU6502_OPERAND_ABX(instruction, pageCross) cpu->instruction(cpu->getAbsoluteXAddr(pageCross))
+#define CPU6502_OPERAND_ABY(instruction, pageCross) cpu->instruction(cpu->getAbsoluteYAddr(pageCross))
+#define CPU6502_OPERAND_IND(instruction, pageCross) cpu->instruction(cpu->getIndirectAddr())
+#define CPU6502_OPERAND_IZX(instruction, pageCross) cpu->instruction(cpu->getIndexedIndirectAddr())
+#define CPU6502_OPERAND_IZY(instruction, pageCross) cpu->instruction(cpu->getIndirectIndexedAddr(pageCross))
+#define CPU6502_OPERAND_REL(instruction, pageCross) cpu->instruction(cpu->getRelative())
+
+// Generate one handler for each op code
+#define CPU6502_HANDLER(code, mnemonic, instruction, mode, cycles, pageCross) \
+    template <> inline void Cpu6502::execute<code>(Cpu6502* cpu) { \
+        CPU6502_OPERAND_##mode(instruction, pageCross); \
+    }
+
+CPU6502_OPCODE_TABLE(CPU6502_HANDLER)
+
+// Opcode handlers table, generated at compile time
+#define CPU6502_HANDLER_ADDR(code, ...) &Cpu6502::execute<code>,
+
+const Cpu6502::OpHandler Cpu6502::s_opHandlers[256] = {
+    CPU6502_OPCODE_TABLE(CPU6502_HANDLER_ADDR)
+};
+
+/*
+ *
+ *  Dispatch engines
+ *
+*/
+
+// Table based dispatch engine
+// op codes without a cycle count stop the CPU
+inline bool Cpu6502::dispatchTable(uint8_t opCode) {
+    s_opHandlers[opCode](this);
+
+    uint8_t cycles = OPCODE_INFO_6502[opCode].cycles;
+    m_cpuCycle += cycles;
+
+    return cycles != 0;
+}
+
+#if defined(NES_CPU_DISPATCH_THREADED)
+// Fetch the instruction at the program counter and return its op code,
+// the operand is loaded and the program counter point after the op code
+inline uint8_t Cpu6502::fetchInstruction() {
+    if (this->decodedHit()) {
+        const DecodedInstruction& decoded = mp_decodeCache[m_pc & (DECODE_CACHE_SIZE - 1)];
+
+        m_operand = decoded.operand;
+        m_pc++;
+
+        return decoded.opCode;
+    }
+
+    // Read OP code and operand from the bus and increment the program counter
+    uint16_t pc = m_pc;
+    uint8_t opCode = m_bus->read(m_pc);
+    this->fetchOperand(opCode);
+    m_pc++;
+
+    this->storeDecoded(pc, opCode);
+    return opCode;
+}
+
+// Return true if the instruction just fetched can be chained
+template <uint8_t opCode> inline bool Cpu6502::chainable() {
+    constexpr OpcodeInfo6502 info = OPCODE_INFO_6502[opCode];
+    const CpuPageTable& pages = m_bus->m_pageTable;
+
+    // Op codes stopping the CPU, BRK and the instructions
+    // that can clear the interrupt disable flag get their own step
+    if (info.cycles == 0 || opCode == 0x00 || opCode == 0x28 || opCode == 0x40 || opCode == 0x58)
+        return false;
+
+    uint16_t addr = m_operand;
+    switch (info.mode) {
+        // Registers, stack and zero page only, the immediate
+        // operands are read next to the op code
+        case ADDR_IMP: case ADDR_ACC: case ADDR_IMM: case ADDR_REL:
+        case ADDR_ZP0: case ADDR_ZPX: case ADDR_ZPY:
+            return true;
+
+        // The pointer is read from the page of the operand
+        case ADDR_IND:
+            return pages.read[addr >> 8] != nullptr;
+
+        case ADDR_ABS:
+            break;
+        case ADDR_ABX:
+            addr += m_regX; break;
+        case ADDR_ABY:
+            addr += m_regY; break;
+
+        // The pointers are read from the zero page
+        case ADDR_IZX: {
+            uint8_t pointer = static_cast<uint8_t>(addr + m_regX);
+            addr = m_bus->mp_ram[pointer] | (m_bus->mp_ram[static_cast<uint8_t>(pointer + 1)] << 8);
+            break;
+        }
+        case ADDR_IZY: {
+            uint8_t pointer = static_cast<uint8_t>(addr);
+            addr = m_bus->mp_ram[pointer] | (m_bus->mp_ram[static_cast<uint8_t>(pointer + 1)] << 8);
+            addr += m_regY;
+            break;
+        }
+    }
+
+    switch (info.access) {
+        case ACCESS_READ:
+            return pages.read[addr >> 8] != nullptr;
+        case ACCESS_WRITE:
+            return pages.write[addr >> 8] != nullptr;
+        default:
+            return true;
+    }
+}
+
+// Computed goto dispatch engine
+//
+// Each handler fetch the next instruction and jump to its handler, so every
+// op code has its own indirect jump and the branch predictor learn the
+// sequences of instructions. The instructions following the first one are
+// only executed if they can't touch an I/O register, the mapper or an interrupt,
+// then the PPU and the APU catching up after the step see the same bus accesses
+// as with one step per instruction. The op code bytes are fetched from the
+// page table, an instruction that can't be chained is left to the next step.
+// A backward jump end the run, so the steps of a loop start at the same
+// address and the idle loop detection still recognize it
+bool Cpu6502::runThreaded(uint64_t cycleLimit) {
+    const CpuPageTable& pages = m_bus->m_pageTable;
+
+    // Operand of the last executed instruction, restored with the
+    // program counter when a fetched instruction is left to the next step
+    uint16_t lastOperand = m_operand;
+    bool first = true;
+
+    #define CPU6502_LABEL_ADDR(code, ...) &&op_##code,
+    #define CPU6502_LABEL(code, mnemonic, instruction, mode, cycles, pageCross) \
+        op_##code: { \
+            bool chained = this->chainable<code>(); \
+            if (!chained && !first) { \
+                m_pc--; \
+                m_operand = lastOperand; \
+                return true; \
+            } \
+            uint16_t pc = m_pc; \
+            execute<code>(this); \
+            m_cpuCycle += cycles; \
+            if (cycles == 0) \
+                return false; \
+            if (!chained || m_cpuCycle >= cycleLimit) \
+                return true; \
+            if ((ADDR_##mode == ADDR_REL || code == 0x4C || code == 0x6C) && m_pc < pc) \
+                return true; \
+            if (pages.read[m_pc >> 8] == nullptr || pages.read[static_cast<uint16_t>(m_pc + 2) >> 8] == nullptr) \
+                return true; \
+            first = false; \
+            lastOperand = m_operand; \
+            goto *s_labels[this->fetchInstruction()]; \
+        }
+
+    static const void* const s_labels[256] = {
+        CPU6502_OPCODE_TABLE(CPU6502_LABEL_ADDR)
+    };
+
+    goto *s_labels[this->fetchInstruction()];
+    CPU6502_OPCODE_TABLE(CPU6502_LABEL)
+
+    #undef CPU6502_LABEL
+    #undef CPU6502_LABEL_ADDR
+}
+#endif
+}
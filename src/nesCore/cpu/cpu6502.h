@@ -7,11 +7,30 @@
 #define NMI_VECTOR_ADDR 0xFFFA
 #define IRQ_BRK_VECTOR_ADDR 0xFFFE
 
+// Number of entries of the decoded instructions cache, must be a power of two
+#define DECODE_CACHE_SIZE 4096
+
+// Size in bytes of the dynarec code cache
+#define DYNAREC_CACHE_SIZE (1024 * 1024)
+
+// Maximum number of steps between two visits of an idle loop head
+#define IDLE_LOOP_MAX_STEPS 16
+
+// The dynarec generate x86-64 code in memory mapped pages
+#if defined(NES_CPU_DYNAREC) && !(defined(__x86_64__) && defined(__unix__))
+#undef NES_CPU_DYNAREC
+#endif
+
 namespace nesCore {
 namespace debug {
 struct Cpu6502Debug;
 }
+namespace utility {
+class StateWriter;
+class StateReader;
+}
 class Bus;
+class Dynarec6502;
 
 // Interrupt emum
 enum Interrupt6502 {
@@ -21,24 +40,70 @@ enum Interrupt6502 {
     ALLINT= 0b011,
 };
 
+// Status register bits
+enum StatusFlag6502 {
+    FLAG_CARRY =     0b00000001,
+    FLAG_ZERO =      0b00000010,
+    FLAG_INTERRUPT = 0b00000100,
+    FLAG_DECIMAL =   0b00001000,
+    FLAG_BREAK =     0b00010000,
+    FLAG_UNUSED =    0b00100000,
+    FLAG_OVERFLOW =  0b01000000,
+    FLAG_NEGATIVE =  0b10000000,
+};
+
 // 6502 based CPU powering the nes
 class Cpu6502 {
 // Public methods
 public:
     // Construct the CPU on a given bus
     Cpu6502(Bus*);
+    ~Cpu6502();
+
+    // The CPU own the decoded instructions cache
+    Cpu6502(const Cpu6502&) = delete;
+    Cpu6502& operator=(const Cpu6502&) = delete;
 
     // Reset all the CPU registers
     void reset();
     void setProgramCounter(uint16_t addr);
 
     // Execute the next instruction and return
-    // the number of cycle required
-    size_t step(Interrupt6502 interrupt = NOINT);
+    // the number of cycle required.
+    // When the dynarec is enabled a whole block can be executed, new
+    // instructions are started until sync cycles have been executed
+    size_t step(Interrupt6502 interrupt = NOINT, size_t syncCycles = 0);
 
     // Return a debug struct with the current CPU status
     debug::Cpu6502Debug getDebugInfo();
 
+    // Save and restore the registers and the idle loop snapshot. The decoded
+    // instructions and the dynarec blocks are tagged with their PRG bank,
+    // so they stay valid for any state of the same cartridge
+    void saveState(utility::StateWriter& state);
+    void loadState(utility::StateReader& state);
+
+    // Drop all the instructions in the decoded instructions cache
+    // and the dynarec blocks, must be called when a new cartridge
+    // is attached to the bus
+    void flushDecodeCache();
+
+    // Enable or disable the dynarec, return false
+    // if the dynarec is not available
+    bool enableDynarec(bool enable);
+
+    // Skip the iterations of the idle loop at the program counter, if any.
+    // An idle loop come back to the same address with the same registers
+    // without writing to the bus or reading I/O registers other than the PPU status.
+    // Only whole iterations fitting in max cycles are skipped, max status cycles
+    // also bound the loops reading the PPU status. Return the skipped cycles
+    size_t skipIdleLoop(size_t maxCycles, size_t maxStatusCycles);
+    // Enable or disable the idle loop skipping
+    void enableIdleLoopSkip(bool enable);
+    // Drop the idle loop snapshot, must be called when
+    // the memory is written without going through the bus
+    void resetIdleLoop();
+
 // Private methods
 private:
     // Get the interrupt and return the interrupt to execute
@@ -48,8 +113,60 @@ private:
     // This functions update the CPU cycles counter
     void executeInterrupt(Interrupt6502 interrupt);
 
-    // Convert the status booleans to a byte
+    // Convert the status register to a byte and back
     uint8_t getStatusByte(bool bFlag = false);
+    void setStatusByte(uint8_t status);
+
+    // Status flags operations
+    //
+    // Read and write the C, I, D and V flags
+    inline bool getFlag(uint8_t flag);
+    inline void setFlag(uint8_t flag, bool value);
+    // Update carry and overflow with a single store
+    inline void setCarryOverflow(bool carry, bool overflow);
+    // Evaluate Z and N from the last result
+    inline bool zeroFlag();
+    inline bool negativeFlag();
+    // Set Z and N independently of each other
+    inline void setNegativeZero(bool negative, bool zero);
+
+    // Read the operand of the given op code at the program counter
+    // and store it in the operand register
+    inline void fetchOperand(uint8_t opCode);
+
+    // Decoded instructions cache operations
+    //
+    // Return true if the instruction at the program counter is in the cache
+    inline bool decodedHit();
+    // Execute the instruction at the program counter if it's in the cache,
+    // return false on a cache miss
+    inline bool executeDecoded();
+
+    // Store the registers and bus counters at the program counter
+    // as the head of a possible idle loop, the PPU status doesn't
+    // change for the given number of cycles
+    void takeIdleSnapshot(size_t statusCycles);
+    // Store the instruction just fetched at the given address in the cache
+    inline void storeDecoded(uint16_t pc, uint8_t opCode);
+
+    // Opcode dispatch engines, only the one selected at build time is used
+    // Execute the instruction and return false if the op code stopped the CPU
+    inline bool dispatchSwitch(uint8_t opCode);
+    inline bool dispatchTable(uint8_t opCode);
+    // Fetch and execute instructions up to the cycle limit, the first
+    // instruction is always executed. Return false if it stopped the CPU
+    bool runThreaded(uint64_t cycleLimit);
+
+    // Fetch the instruction at the program counter from the decoded
+    // instructions cache or from the bus and return its op code
+    inline uint8_t fetchInstruction();
+    // Return true if the instruction just fetched can't stop the CPU
+    // or touch the memory outside the page table
+    template <uint8_t opCode> inline bool chainable();
+
+    // Opcode handler generated from the op codes table,
+    // the base cycles are added by the dispatch engine
+    template <uint8_t opCode> static inline void execute(Cpu6502* cpu);
 
     // Stack operations
     inline void stackPush(uint8_t data);
@@ -59,8 +176,8 @@ private:
     inline uint16_t stackPop16();
 
     // Addressing mode functions
-    // these functions use the current position of the 
-    // program counter as their input address
+    // these functions use the operand register and the current
+    // position of the program counter as their input
     // and return the address of the parameter for the instruction
     // !!! These functions update the program counter !!!
     inline uint16_t getImmediateAddr();
@@ -122,6 +239,53 @@ private:
     inline void DCP(uint16_t addr); inline void ISC(uint16_t addr);
     inline void SLO(uint16_t addr); inline void RLA(uint16_t addr);
     inline void SRE(uint16_t addr); inline void RRA(uint16_t addr);
+    // No operation with and without an operand
+    inline void NOP(); inline void NOP(uint16_t addr);
+    // Halt the CPU and unsupported op codes
+    inline void JAM(); inline void UNK();
+
+// The dynarec call the opcode handlers and update the registers
+friend class Dynarec6502;
+
+// Private types and static member variable
+private:
+    typedef void (*OpHandler)(Cpu6502*);
+
+    // Opcode handlers table indexed by op code
+    static const OpHandler s_opHandlers[256];
+
+    // Instruction decoded from PRG ROM
+    struct DecodedInstruction {
+        OpHandler handler;
+        uint8_t opCode;
+
+        // Cache tag, address of the instruction and
+        // PRG bank mapped at this address when it was decoded
+        uint16_t pc;
+        uint16_t bank;
+
+        // Resolved operand and base cycles count
+        uint16_t operand;
+        uint8_t cycles;
+    };
+
+    // CPU state at the head of a possible idle loop
+    struct IdleLoopSnapshot {
+        uint64_t cpuCycle;
+        uint64_t writeCount;
+        uint64_t ioReadCount;
+        uint64_t statusReadCount;
+        // Last CPU cycle reading the PPU status of the snapshot
+        uint64_t statusDeadline;
+
+        uint16_t pc;
+        uint8_t stackPointer;
+        uint8_t regX, regY, accumulator;
+        uint8_t statusByte;
+
+        // Steps executed since the snapshot
+        size_t steps;
+    };
 
 // Private member variable
 private:
@@ -135,17 +299,35 @@ private:
     // CPU registers
     uint8_t m_regX, m_regY, m_accumulator;
     
+    // Operand of the current instruction, fetched with the op code
+    uint16_t m_operand;
+    
     // Pointer to the nes CPU bus
     Bus* m_bus;
 
-    // Status registers
-    bool m_carryFlag;
-    bool m_zeroFlag;
-    bool m_interruptDisable;
-    bool m_decimalMode; 
+    // Decoded instructions cache, direct mapped by address
+    DecodedInstruction* mp_decodeCache;
+
+    // Decoded instructions cache statistics
+    uint64_t m_decodeCacheHits;
+    uint64_t m_decodeCacheLookups;
 
-    bool m_overflowFlag;
-    bool m_negativeFlag;
+    // Dynamic recompiler, nullptr if it's not available
+    Dynarec6502* mp_dynarec;
+    bool m_dynarecEnabled;
+
+    // Idle loop detection
+    IdleLoopSnapshot m_idleSnapshot;
+    bool m_idleSkipEnabled;
+    uint64_t m_idleCyclesSkipped;
+
+    // Status registers
+    //
+    // C, I, D and V flags stored at their position in the status byte
+    uint8_t m_status;
+    // Result of the last instruction updating N and Z, Z is set
+    // if the low byte is zero and N if bit 7 or bit 8 is set
+    uint16_t m_nzResult;
 };
 }
 
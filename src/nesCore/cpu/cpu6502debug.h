@@ -36,11 +36,26 @@ struct Cpu6502Debug {
     bool decimalMode; 
     bool breakCommand;
 
+    // Decoded instructions cache statistics
+    uint64_t decodeCacheHits;
+    uint64_t decodeCacheLookups;
+
+    // Dynarec statistics
+    bool dynarecEnabled;
+    uint64_t dynarecBlocksRun;
+    uint64_t dynarecBlocksTranslated;
+
+    // Cycles skipped in idle loops
+    uint64_t idleCyclesSkipped;
+
     // Formatting methods
     std::string formatStatusRegister();
     std::string formatGeneralRegisters();
     std::string fomratProgramRegisters();
     std::string formatCycles();
+    std::string formatDecodeCache();
+    std::string formatDynarec();
+    std::string formatIdleLoops();
 
     // Format expended information 
     std::string format();
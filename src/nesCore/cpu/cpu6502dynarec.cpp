@@ -0,0 +1,308 @@
+#include "nesPch.h"
+
+#include "cpu6502dynarec.h"
+#include "cpu6502opcodes.h"
+#include "nesCore/cpuBus.h"
+
+#if defined(NES_CPU_DYNAREC)
+
+#include <sys/mman.h>
+
+// Upper bound of the size of a translated block in bytes
+#define DYNAREC_MAX_BLOCK_SIZE (16 + DYNAREC_BLOCK_INSTRUCTIONS * 64)
+
+namespace nesCore {
+// Return true if the address range can be accessed without side effects,
+// RAM and PRG RAM can be written, PRG ROM can only be read
+static bool accessible(uint32_t from, uint32_t to, MemoryAccess6502 access) {
+    if (to > 0xFFFF)
+        return false;
+
+    // RAM and its mirrors
+    if (to <= 0x1FFF)
+        return true;
+
+    // PRG RAM
+    if (from >= 0x6000 && to <= 0x7FFF)
+        return true;
+
+    // PRG ROM, writes go to the mapper registers
+    return from >= 0x6000 && access == ACCESS_READ;
+}
+
+// Construct the dynarec and allocate the code cache
+Dynarec6502::Dynarec6502(Cpu6502* cpu, size_t codeCacheSize) :
+    mp_cpu(cpu), m_codeSize(codeCacheSize), m_codeUsed(0)
+{
+    // Offset of the registers used by the generated code
+    uint8_t* base = reinterpret_cast<uint8_t*>(cpu);
+    m_pcOffset = static_cast<int32_t>(reinterpret_cast<uint8_t*>(&cpu->m_pc) - base);
+    m_operandOffset = static_cast<int32_t>(reinterpret_cast<uint8_t*>(&cpu->m_operand) - base);
+    m_cycleOffset = static_cast<int32_t>(reinterpret_cast<uint8_t*>(&cpu->m_cpuCycle) - base);
+
+    m_blocksRun = 0;
+    m_blocksTranslated = 0;
+    m_cacheFlushes = 0;
+
+    // Allocate the executable code buffer
+    void* code = mmap(
+        nullptr, m_codeSize, PROT_READ | PROT_WRITE | PROT_EXEC,
+        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0
+    );
+
+    if (code == MAP_FAILED || m_codeSize < DYNAREC_MAX_BLOCK_SIZE) {
+        std::cerr << "Dynarec: Failed to allocate the code cache, ";
+        std::cerr << "using the interpreter" << std::endl;
+
+        if (code != MAP_FAILED)
+            munmap(code, m_codeSize);
+
+        mp_code = nullptr;
+        return;
+    }
+
+    mp_code = static_cast<uint8_t*>(code);
+}
+Dynarec6502::~Dynarec6502() {
+    if (mp_code != nullptr)
+        munmap(mp_code, m_codeSize);
+}
+
+// Return true if the code cache was allocated
+bool Dynarec6502::available() {
+    return mp_code != nullptr;
+}
+
+// Drop all the translated blocks
+void Dynarec6502::flush() {
+    m_blocks.clear();
+    m_codeUsed = 0;
+}
+
+// Run the block at the program counter
+bool Dynarec6502::run(uint64_t cycleLimit) {
+    if (mp_code == nullptr)
+        return false;
+
+    // Only PRG ROM is translated, code in RAM is run by the interpreter
+    Bus* bus = mp_cpu->m_bus;
+    uint16_t pc = mp_cpu->m_pc;
+
+    if (pc < 0x8000 || bus->mp_cartridge == nullptr)
+        return false;
+
+    // Blocks are tagged with the PRG bank mapped at their address,
+    // so a block is never run after its bank is switched out
+    uint32_t key = (static_cast<uint32_t>(bus->mp_cartridge->prgBank(pc)) << 16) | pc;
+
+    uint8_t* block;
+    auto entry = m_blocks.find(key);
+    if (entry != m_blocks.end()) {
+        block = entry->second;
+    } else {
+        block = this->translate(pc);
+        m_blocks[key] = block;
+    }
+
+    if (block == nullptr)
+        return false;
+
+    reinterpret_cast<BlockCode>(block)(mp_cpu, cycleLimit);
+    m_blocksRun++;
+
+    return true;
+}
+
+// Translate the block at the given address
+uint8_t* Dynarec6502::translate(uint16_t pc) {
+    Bus* bus = mp_cpu->m_bus;
+
+    // Flush the whole cache when the next block may not fit
+    if (m_codeUsed + DYNAREC_MAX_BLOCK_SIZE > m_codeSize) {
+        this->flush();
+        m_cacheFlushes++;
+    }
+
+    size_t blockStart = m_codeUsed;
+    this->emitPrologue();
+
+    // Translate the instructions until the end of the basic block
+    uint16_t addr = pc;
+    size_t count = 0;
+
+    while (count < DYNAREC_BLOCK_INSTRUCTIONS) {
+        uint8_t opCode = bus->read(addr, true);
+        uint8_t bytes = operandBytes(OPCODE_INFO_6502[opCode].mode);
+
+        // The whole instruction must be in the PRG bank of the block
+        uint32_t lastAddr = static_cast<uint32_t>(addr) + bytes;
+        if (lastAddr > 0xFFFF || (lastAddr & 0xE000) != (pc & 0xE000u))
+            break;
+
+        uint16_t operand = 0x0000;
+        if (bytes == 1)
+            operand = bus->read(addr + 1, true);
+        else if (bytes == 2)
+            operand = bus->read16(addr + 1, true);
+
+        if (!this->translatable(opCode, operand))
+            break;
+
+        // The first instruction is always executed
+        if (count != 0)
+            this->emitCycleCheck();
+
+        this->emitInstruction(addr, opCode, operand);
+
+        count++;
+        addr += 1 + bytes;
+
+        if (this->endsBlock(opCode))
+            break;
+    }
+
+    // Let the interpreter execute the instruction
+    if (count == 0) {
+        m_codeUsed = blockStart;
+        return nullptr;
+    }
+
+    this->emitEpilogue();
+    m_blocksTranslated++;
+
+    return mp_code + blockStart;
+}
+
+// Return true if the instruction can be executed by a block
+bool Dynarec6502::translatable(uint8_t opCode, uint16_t operand) {
+    const OpcodeInfo6502& info = OPCODE_INFO_6502[opCode];
+    MemoryAccess6502 access = info.access;
+
+    // Op codes that stop the CPU are left to the interpreter
+    if (info.cycles == 0)
+        return false;
+
+    switch (info.mode) {
+        // Registers, stack and zero page only
+        case ADDR_IMP: case ADDR_ACC: case ADDR_IMM: case ADDR_REL:
+        case ADDR_ZP0: case ADDR_ZPX: case ADDR_ZPY:
+            return true;
+
+        case ADDR_ABS:
+            return access == ACCESS_NONE || accessible(operand, operand, access);
+        // Any address reachable with the index register must be accessible
+        case ADDR_ABX: case ADDR_ABY:
+            return access == ACCESS_NONE || accessible(operand, operand + 0xFF, access);
+        // The pointer is read from the page of the operand
+        case ADDR_IND:
+            return accessible(operand & 0xFF00, operand | 0x00FF, ACCESS_READ);
+
+        // The address is only known at run time
+        case ADDR_IZX: case ADDR_IZY:
+            return false;
+    }
+
+    return false;
+}
+
+// Return true if the block must end after the instruction
+bool Dynarec6502::endsBlock(uint8_t opCode) {
+    // Branches
+    if (OPCODE_INFO_6502[opCode].mode == ADDR_REL)
+        return true;
+
+    switch (opCode) {
+        // Jumps, calls and returns
+        case 0x00: case 0x20: case 0x40: case 0x4C: case 0x60: case 0x6C:
+            return true;
+        // The interrupts are polled again when the disable flag change
+        case 0x28: case 0x58: case 0x78:
+            return true;
+    }
+
+    return false;
+}
+
+/*
+ *
+ *  x86-64 code emission
+ *
+ *  The block are called with the System V calling convention,
+ *  rbx hold the CPU pointer and r12 the cycle limit
+ *
+*/
+
+void Dynarec6502::emit8(uint8_t value) {
+    mp_code[m_codeUsed++] = value;
+}
+void Dynarec6502::emit16(uint16_t value) {
+    emit8(value & 0xFF); emit8(value >> 8);
+}
+void Dynarec6502::emit32(uint32_t value) {
+    emit16(value & 0xFFFF); emit16(value >> 16);
+}
+void Dynarec6502::emit64(uint64_t value) {
+    emit32(value & 0xFFFFFFFF); emit32(value >> 32);
+}
+
+// Save the callee saved registers and load the block arguments,
+// three pushes keep the stack aligned for the handler calls
+void Dynarec6502::emitPrologue() {
+    // push rbx; push r12; push r13
+    emit8(0x53);
+    emit8(0x41); emit8(0x54);
+    emit8(0x41); emit8(0x55);
+
+    // mov rbx, rdi; mov r12, rsi
+    emit8(0x48); emit8(0x89); emit8(0xFB);
+    emit8(0x49); emit8(0x89); emit8(0xF4);
+}
+
+// Restore the callee saved registers and return to the CPU
+void Dynarec6502::emitEpilogue() {
+    // pop r13; pop r12; pop rbx; ret
+    emit8(0x41); emit8(0x5D);
+    emit8(0x41); emit8(0x5C);
+    emit8(0x5B);
+    emit8(0xC3);
+}
+
+// Return to the CPU if the cycle limit was reached
+void Dynarec6502::emitCycleCheck() {
+    // cmp qword [rbx + cycle], r12
+    emit8(0x4C); emit8(0x39); emit8(0xA3); emit32(m_cycleOffset);
+
+    // jb over the epilogue
+    emit8(0x72); emit8(0x06);
+    this->emitEpilogue();
+}
+
+// Execute one instruction with its handler
+void Dynarec6502::emitInstruction(uint16_t pc, uint8_t opCode, uint16_t operand) {
+    const OpcodeInfo6502& info = OPCODE_INFO_6502[opCode];
+
+    // mov word [rbx + pc], pc + 1
+    emit8(0x66); emit8(0xC7); emit8(0x83); emit32(m_pcOffset);
+    emit16(pc + 1);
+
+    // Immediate instructions read their operand from the bus
+    if (operandBytes(info.mode) != 0 && info.mode != ADDR_IMM) {
+        // mov word [rbx + operand], operand
+        emit8(0x66); emit8(0xC7); emit8(0x83); emit32(m_operandOffset);
+        emit16(operand);
+    }
+
+    // mov rdi, rbx
+    emit8(0x48); emit8(0x89); emit8(0xDF);
+    // mov rax, handler; call rax
+    emit8(0x48); emit8(0xB8);
+    emit64(reinterpret_cast<uint64_t>(Cpu6502::s_opHandlers[opCode]));
+    emit8(0xFF); emit8(0xD0);
+
+    // add qword [rbx + cycle], cycles
+    emit8(0x48); emit8(0x83); emit8(0x83); emit32(m_cycleOffset);
+    emit8(info.cycles);
+}
+}
+
+#endif
@@ -0,0 +1,109 @@
+#ifndef CPU6502_DYNAREC_H_
+#define CPU6502_DYNAREC_H_
+
+#include "nesPch.h"
+
+#include "cpu6502.h"
+
+#include <unordered_map>
+
+#if defined(NES_CPU_DYNAREC)
+
+// Maximum number of 6502 instructions translated in one block
+#define DYNAREC_BLOCK_INSTRUCTIONS 32
+
+namespace nesCore {
+// Translate the 6502 basic blocks stored in PRG ROM to x86-64 code
+//
+// The generated code keep the program counter, the operand register
+// and the cycle counter of the CPU up to date and call the opcode handlers
+// directly, without fetching, decoding or dispatching the instructions.
+//
+// Only instructions that can't touch an I/O register are translated,
+// the interpreter execute everything else, so a block can run many
+// instructions before the PPU is synchronised without any visible effect
+class Dynarec6502 {
+public:
+    // Construct the dynarec for the given CPU, the generated code
+    // is stored in a buffer of the given size
+    Dynarec6502(Cpu6502* cpu, size_t codeCacheSize = DYNAREC_CACHE_SIZE);
+    ~Dynarec6502();
+
+    // The dynarec own the code cache
+    Dynarec6502(const Dynarec6502&) = delete;
+    Dynarec6502& operator=(const Dynarec6502&) = delete;
+
+    // Return true if the code cache was allocated
+    bool available();
+
+    // Run the block at the program counter, translating it if required.
+    // New instructions are not started once the CPU cycle counter reach the
+    // cycle limit, the first instruction of the block is always executed.
+    // Return false if the interpreter must execute the next instruction
+    bool run(uint64_t cycleLimit);
+
+    // Drop all the translated blocks
+    void flush();
+
+    // Statistics
+    uint64_t blocksRun() { return m_blocksRun; }
+    uint64_t blocksTranslated() { return m_blocksTranslated; }
+    uint64_t cacheFlushes() { return m_cacheFlushes; }
+
+// Private methods
+private:
+    // Translate the block at the given address,
+    // return nullptr if its first instruction can't be translated
+    uint8_t* translate(uint16_t pc);
+
+    // Return true if the instruction can be executed by a block
+    bool translatable(uint8_t opCode, uint16_t operand);
+    // Return true if the block must end after the instruction
+    bool endsBlock(uint8_t opCode);
+
+    // Code emission
+    void emit8(uint8_t value);
+    void emit16(uint16_t value);
+    void emit32(uint32_t value);
+    void emit64(uint64_t value);
+
+    void emitPrologue();
+    void emitEpilogue();
+    // Return to the CPU if the cycle limit was reached
+    void emitCycleCheck();
+    // Execute one instruction
+    void emitInstruction(uint16_t pc, uint8_t opCode, uint16_t operand);
+
+// Private types
+private:
+    // Translated block entry point, take the CPU and the cycle limit
+    typedef void (*BlockCode)(Cpu6502*, uint64_t);
+
+// Private member variable
+private:
+    Cpu6502* mp_cpu;
+
+    // Executable code buffer, blocks are appended until it's full
+    // and then the whole cache is flushed
+    uint8_t* mp_code;
+    size_t m_codeSize;
+    size_t m_codeUsed;
+
+    // Translated blocks indexed by PRG bank and address,
+    // blocks that can't be translated are stored as nullptr
+    std::unordered_map<uint32_t, uint8_t*> m_blocks;
+
+    // Offset of the CPU registers used by the generated code
+    int32_t m_pcOffset;
+    int32_t m_operandOffset;
+    int32_t m_cycleOffset;
+
+    // Statistics
+    uint64_t m_blocksRun;
+    uint64_t m_blocksTranslated;
+    uint64_t m_cacheFlushes;
+};
+}
+
+#endif
+#endif
@@ -0,0 +1,373 @@
+#ifndef CPU6502_OPCODES_H_
+#define CPU6502_OPCODES_H_
+
+#include "nesPch.h"
+
+namespace nesCore {
+// 6502 addressing modes
+enum AddressingMode6502 {
+    ADDR_IMP, // Implied
+    ADDR_ACC, // Accumulator
+    ADDR_IMM, // Immediate
+    ADDR_ZP0, // Zero page
+    ADDR_ZPX, // Zero page X indexed
+    ADDR_ZPY, // Zero page Y indexed
+    ADDR_ABS, // Absolute
+    ADDR_ABX, // Absolute X indexed
+    ADDR_ABY, // Absolute Y indexed
+    ADDR_IND, // Indirect
+    ADDR_IZX, // Indexed indirect
+    ADDR_IZY, // Indirect indexed
+    ADDR_REL, // Relative
+};
+
+// Return the number of operand bytes following the op code
+constexpr uint8_t operandBytes(AddressingMode6502 mode) {
+    switch (mode) {
+        case ADDR_IMP: case ADDR_ACC:
+            return 0;
+        case ADDR_ABS: case ADDR_ABX: case ADDR_ABY: case ADDR_IND:
+            return 2;
+        default:
+            return 1;
+    }
+}
+
+// Memory access done by an instruction through its operand
+enum MemoryAccess6502 {
+    ACCESS_NONE,
+    ACCESS_READ,
+    ACCESS_WRITE,
+};
+
+// Compare two strings at compile time
+constexpr bool sameName(const char* a, const char* b) {
+    return *a == *b && (*a == '\0' || sameName(a + 1, b + 1));
+}
+
+// Return the memory access of the given instruction
+constexpr MemoryAccess6502 instructionAccess(const char* instruction, AddressingMode6502 mode) {
+    // Implied and accumulator instructions only touch registers and the stack
+    if (mode == ADDR_IMP || mode == ADDR_ACC)
+        return ACCESS_NONE;
+
+    // Jumps and no operations only use the address
+    if (sameName(instruction, "JMP") || sameName(instruction, "JSR") || sameName(instruction, "NOP"))
+        return ACCESS_NONE;
+
+    const char* const writers[] = {
+        "STA", "STX", "STY", "SAX", "INC", "DEC", "ASL", "LSR",
+        "ROL", "ROR", "DCP", "ISC", "SLO", "RLA", "SRE", "RRA",
+    };
+    for (const char* writer : writers)
+        if (sameName(instruction, writer))
+            return ACCESS_WRITE;
+
+    return ACCESS_READ;
+}
+
+// Opcode metadata
+struct OpcodeInfo6502 {
+    uint8_t opCode;
+    const char* mnemonic;
+    AddressingMode6502 mode;
+    // Memory access through the operand, the pointer
+    // read by the indirect jump is not included
+    MemoryAccess6502 access;
+
+    // Base number of cycles of the instruction,
+    // zero for op codes that stop the CPU
+    uint8_t cycles;
+    // True if crossing a page boundary adds one cycle
+    bool pageCross;
+};
+
+// 6502 op codes table, the single description of the instruction set
+// used by the CPU dispatch engines and by the decompiler
+//
+// Entry format:
+//  OP(op code, mnemonic, instruction, addressing mode, cycles, page cross cycle)
+//
+// The entries must be sorted by op code and cover all the 256 op codes,
+// illegal instructions mnemonics start with a '*'
+#define CPU6502_OPCODE_TABLE(OP) \
+    OP(0x00, "BRK",      BRK, IMP, 7, false) \
+    OP(0x01, "ORA",      ORA, IZX, 6, false) \
+    OP(0x02, "*JAM",     JAM, IMP, 0, false) \
+    OP(0x03, "*SLO",     SLO, IZX, 8, false) \
+    OP(0x04, "*NOP",     NOP, ZP0, 3, false) \
+    OP(0x05, "ORA",      ORA, ZP0, 3, false) \
+    OP(0x06, "ASL",      ASL, ZP0, 5, false) \
+    OP(0x07, "*SLO",     SLO, ZP0, 5, false) \
+    OP(0x08, "PHP",      PHP, IMP, 3, false) \
+    OP(0x09, "ORA",      ORA, IMM, 2, false) \
+    OP(0x0A, "ASL",      ASL, ACC, 2, false) \
+    OP(0x0B, "*UNKNOW*", UNK, IMP, 0, false) \
+    OP(0x0C, "*NOP",     NOP, ABS, 4, false) \
+    OP(0x0D, "ORA",      ORA, ABS, 4, false) \
+    OP(0x0E, "ASL",      ASL, ABS, 6, false) \
+    OP(0x0F, "*SLO",     SLO, ABS, 6, false) \
+    OP(0x10, "BPL",      BPL, REL, 2, false) \
+    OP(0x11, "ORA",      ORA, IZY, 5, true) \
+    OP(0x12, "*JAM",     JAM, IMP, 0, false) \
+    OP(0x13, "*SLO",     SLO, IZY, 8, false) \
+    OP(0x14, "*NOP",     NOP, ZPX, 4, false) \
+    OP(0x15, "ORA",      ORA, ZPX, 4, false) \
+    OP(0x16, "ASL",      ASL, ZPX, 6, false) \
+    OP(0x17, "*SLO",     SLO, ZPX, 6, false) \
+    OP(0x18, "CLC",      CLC, IMP, 2, false) \
+    OP(0x19, "ORA",      ORA, ABY, 4, true) \
+    OP(0x1A, "*NOP",     NOP, IMP, 2, false) \
+    OP(0x1B, "*SLO",     SLO, ABY, 7, false) \
+    OP(0x1C, "*NOP",     NOP, ABX, 4, true) \
+    OP(0x1D, "ORA",      ORA, ABX, 4, true) \
+    OP(0x1E, "ASL",      ASL, ABX, 7, false) \
+    OP(0x1F, "*SLO",     SLO, ABX, 7, false) \
+    OP(0x20, "JSR",      JSR, ABS, 6, false) \
+    OP(0x21, "AND",      AND, IZX, 6, false) \
+    OP(0x22, "*JAM",     JAM, IMP, 0, false) \
+    OP(0x23, "*RLA",     RLA, IZX, 8, false) \
+    OP(0x24, "BIT",      BIT, ZP0, 3, false) \
+    OP(0x25, "AND",      AND, ZP0, 3, false) \
+    OP(0x26, "ROL",      ROL, ZP0, 5, false) \
+    OP(0x27, "*RLA",     RLA, ZP0, 5, false) \
+    OP(0x28, "PLP",      PLP, IMP, 4, false) \
+    OP(0x29, "AND",      AND, IMM, 2, false) \
+    OP(0x2A, "ROL",      ROL, ACC, 2, false) \
+    OP(0x2B, "*UNKNOW*", UNK, IMP, 0, false) \
+    OP(0x2C, "BIT",      BIT, ABS, 4, false) \
+    OP(0x2D, "AND",      AND, ABS, 4, false) \
+    OP(0x2E, "ROL",      ROL, ABS, 6, false) \
+    OP(0x2F, "*RLA",     RLA, ABS, 6, false) \
+    OP(0x30, "BMI",      BMI, REL, 2, false) \
+    OP(0x31, "AND",      AND, IZY, 5, true) \
+    OP(0x32, "*JAM",     JAM, IMP, 0, false) \
+    OP(0x33, "*RLA",     RLA, IZY, 8, false) \
+    OP(0x34, "*NOP",     NOP, ZPX, 4, false) \
+    OP(0x35, "AND",      AND, ZPX, 4, false) \
+    OP(0x36, "ROL",      ROL, ZPX, 6, false) \
+    OP(0x37, "*RLA",     RLA, ZPX, 6, false) \
+    OP(0x38, "SEC",      SEC, IMP, 2, false) \
+    OP(0x39, "AND",      AND, ABY, 4, true) \
+    OP(0x3A, "*NOP",     NOP, IMP, 2, false) \
+    OP(0x3B, "*RLA",     RLA, ABY, 7, false) \
+    OP(0x3C, "*NOP",     NOP, ABX, 4, true) \
+    OP(0x3D, "AND",      AND, ABX, 4, true) \
+    OP(0x3E, "ROL",      ROL, ABX, 7, false) \
+    OP(0x3F, "*RLA",     RLA, ABX, 7, false) \
+    OP(0x40, "RTI",      RTI, IMP, 6, false) \
+    OP(0x41, "EOR",      EOR, IZX, 6, false) \
+    OP(0x42, "*JAM",     JAM, IMP, 0, false) \
+    OP(0x43, "*SRE",     SRE, IZX, 8, false) \
+    OP(0x44, "*NOP",     NOP, ZP0, 3, false) \
+    OP(0x45, "EOR",      EOR, ZP0, 3, false) \
+    OP(0x46, "LSR",      LSR, ZP0, 5, false) \
+    OP(0x47, "*SRE",     SRE, ZP0, 5, false) \
+    OP(0x48, "PHA",      PHA, IMP, 3, false) \
+    OP(0x49, "EOR",      EOR, IMM, 2, false) \
+    OP(0x4A, "LSR",      LSR, ACC, 2, false) \
+    OP(0x4B, "*UNKNOW*", UNK, IMP, 0, false) \
+    OP(0x4C, "JMP",      JMP, ABS, 3, false) \
+    OP(0x4D, "EOR",      EOR, ABS, 4, false) \
+    OP(0x4E, "LSR",      LSR, ABS, 6, false) \
+    OP(0x4F, "*SRE",     SRE, ABS, 6, false) \
+    OP(0x50, "BVC",      BVC, REL, 2, false) \
+    OP(0x51, "EOR",      EOR, IZY, 5, true) \
+    OP(0x52, "*JAM",     JAM, IMP, 0, false) \
+    OP(0x53, "*SRE",     SRE, IZY, 8, false) \
+    OP(0x54, "*NOP",     NOP, ZPX, 4, false) \
+    OP(0x55, "EOR",      EOR, ZPX, 4, false) \
+    OP(0x56, "LSR",      LSR, ZPX, 6, false) \
+    OP(0x57, "*SRE",     SRE, ZPX, 6, false) \
+    OP(0x58, "CLI",      CLI, IMP, 2, false) \
+    OP(0x59, "EOR",      EOR, ABY, 4, true) \
+    OP(0x5A, "*NOP",     NOP, IMP, 2, false) \
+    OP(0x5B, "*SRE",     SRE, ABY, 7, false) \
+    OP(0x5C, "*NOP",     NOP, ABX, 4, true) \
+    OP(0x5D, "EOR",      EOR, ABX, 4, true) \
+    OP(0x5E, "LSR",      LSR, ABX, 7, false) \
+    OP(0x5F, "*SRE",     SRE, ABX, 7, false) \
+    OP(0x60, "RTS",      RTS, IMP, 6, false) \
+    OP(0x61, "ADC",      ADC, IZX, 6, false) \
+    OP(0x62, "*JAM",     JAM, IMP, 0, false) \
+    OP(0x63, "*RRA",     RRA, IZX, 8, false) \
+    OP(0x64, "*NOP",     NOP, ZP0, 3, false) \
+    OP(0x65, "ADC",      ADC, ZP0, 3, false) \
+    OP(0x66, "ROR",      ROR, ZP0, 5, false) \
+    OP(0x67, "*RRA",     RRA, ZP0, 5, false) \
+    OP(0x68, "PLA",      PLA, IMP, 4, false) \
+    OP(0x69, "ADC",      ADC, IMM, 2, false) \
+    OP(0x6A, "ROR",      ROR, ACC, 2, false) \
+    OP(0x6B, "*UNKNOW*", UNK, IMP, 0, false) \
+    OP(0x6C, "JMP",      JMP, IND, 5, false) \
+    OP(0x6D, "ADC",      ADC, ABS, 4, false) \
+    OP(0x6E, "ROR",      ROR, ABS, 6, false) \
+    OP(0x6F, "*RRA",     RRA, ABS, 6, false) \
+    OP(0x70, "BVS",      BVS, REL, 2, false) \
+    OP(0x71, "ADC",      ADC, IZY, 5, true) \
+    OP(0x72, "*JAM",     JAM, IMP, 0, false) \
+    OP(0x73, "*RRA",     RRA, IZY, 8, false) \
+    OP(0x74, "*NOP",     NOP, ZPX, 4, false) \
+    OP(0x75, "ADC",      ADC, ZPX, 4, false) \
+    OP(0x76, "ROR",      ROR, ZPX, 6, false) \
+    OP(0x77, "*RRA",     RRA, ZPX, 6, false) \
+    OP(0x78, "SEI",      SEI, IMP, 2, false) \
+    OP(0x79, "ADC",      ADC, ABY, 4, true) \
+    OP(0x7A, "*NOP",     NOP, IMP, 2, false) \
+    OP(0x7B, "*RRA",     RRA, ABY, 7, false) \
+    OP(0x7C, "*NOP",     NOP, ABX, 4, true) \
+    OP(0x7D, "ADC",      ADC, ABX, 4, true) \
+    OP(0x7E, "ROR",      ROR, ABX, 7, false) \
+    OP(0x7F, "*RRA",     RRA, ABX, 7, false) \
+    OP(0x80, "*NOP",     NOP, IMM, 2, false) \
+    OP(0x81, "STA",      STA, IZX, 6, false) \
+    OP(0x82, "*NOP",     NOP, IMM, 2, false) \
+    OP(0x83, "*SAX",     SAX, IZX, 6, false) \
+    OP(0x84, "STY",      STY, ZP0, 3, false) \
+    OP(0x85, "STA",      STA, ZP0, 3, false) \
+    OP(0x86, "STX",      STX, ZP0, 3, false) \
+    OP(0x87, "*SAX",     SAX, ZP0, 3, false) \
+    OP(0x88, "DEY",      DEY, IMP, 2, false) \
+    OP(0x89, "*NOP",     NOP, IMM, 2, false) \
+    OP(0x8A, "TXA",      TXA, IMP, 2, false) \
+    OP(0x8B, "*UNKNOW*", UNK, IMP, 0, false) \
+    OP(0x8C, "STY",      STY, ABS, 4, false) \
+    OP(0x8D, "STA",      STA, ABS, 4, false) \
+    OP(0x8E, "STX",      STX, ABS, 4, false) \
+    OP(0x8F, "*SAX",     SAX, ABS, 4, false) \
+    OP(0x90, "BCC",      BCC, REL, 2, false) \
+    OP(0x91, "STA",      STA, IZY, 6, false) \
+    OP(0x92, "*JAM",     JAM, IMP, 0, false) \
+    OP(0x93, "*UNKNOW*", UNK, IMP, 0, false) \
+    OP(0x94, "STY",      STY, ZPX, 4, false) \
+    OP(0x95, "STA",      STA, ZPX, 4, false) \
+    OP(0x96, "STX",      STX, ZPY, 4, false) \
+    OP(0x97, "*SAX",     SAX, ZPY, 4, false) \
+    OP(0x98, "TYA",      TYA, IMP, 2, false) \
+    OP(0x99, "STA",      STA, ABY, 5, false) \
+    OP(0x9A, "TXS",      TXS, IMP, 2, false) \
+    OP(0x9B, "*UNKNOW*", UNK, IMP, 0, false) \
+    OP(0x9C, "*UNKNOW*", UNK, IMP, 0, false) \
+    OP(0x9D, "STA",      STA, ABX, 5, false) \
+    OP(0x9E, "*UNKNOW*", UNK, IMP, 0, false) \
+    OP(0x9F, "*UNKNOW*", UNK, IMP, 0, false) \
+    OP(0xA0, "LDY",      LDY, IMM, 2, false) \
+    OP(0xA1, "LDA",      LDA, IZX, 6, false) \
+    OP(0xA2, "LDX",      LDX, IMM, 2, false) \
+    OP(0xA3, "*LAX",     LAX, IZX, 6, false) \
+    OP(0xA4, "LDY",      LDY, ZP0, 3, false) \
+    OP(0xA5, "LDA",      LDA, ZP0, 3, false) \
+    OP(0xA6, "LDX",      LDX, ZP0, 3, false) \
+    OP(0xA7, "*LAX",     LAX, ZP0, 3, false) \
+    OP(0xA8, "TAY",      TAY, IMP, 2, false) \
+    OP(0xA9, "LDA",      LDA, IMM, 2, false) \
+    OP(0xAA, "TAX",      TAX, IMP, 2, false) \
+    OP(0xAB, "*UNKNOW*", UNK, IMP, 0, false) \
+    OP(0xAC, "LDY",      LDY, ABS, 4, false) \
+    OP(0xAD, "LDA",      LDA, ABS, 4, false) \
+    OP(0xAE, "LDX",      LDX, ABS, 4, false) \
+    OP(0xAF, "*LAX",     LAX, ABS, 4, false) \
+    OP(0xB0, "BCS",      BCS, REL, 2, false) \
+    OP(0xB1, "LDA",      LDA, IZY, 5, true) \
+    OP(0xB2, "*JAM",     JAM, IMP, 0, false) \
+    OP(0xB3, "*LAX",     LAX, IZY, 5, true) \
+    OP(0xB4, "LDY",      LDY, ZPX, 4, false) \
+    OP(0xB5, "LDA",      LDA, ZPX, 4, false) \
+    OP(0xB6, "LDX",      LDX, ZPY, 4, false) \
+    OP(0xB7, "*LAX",     LAX, ZPY, 4, false) \
+    OP(0xB8, "CLV",      CLV, IMP, 2, false) \
+    OP(0xB9, "LDA",      LDA, ABY, 4, true) \
+    OP(0xBA, "TSX",      TSX, IMP, 2, false) \
+    OP(0xBB, "*UNKNOW*", UNK, IMP, 0, false) \
+    OP(0xBC, "LDY",      LDY, ABX, 4, true) \
+    OP(0xBD, "LDA",      LDA, ABX, 4, true) \
+    OP(0xBE, "LDX",      LDX, ABY, 4, true) \
+    OP(0xBF, "*LAX",     LAX, ABY, 4, true) \
+    OP(0xC0, "CPY",      CPY, IMM, 2, false) \
+    OP(0xC1, "CMP",      CMP, IZX, 6, false) \
+    OP(0xC2, "*NOP",     NOP, IMM, 2, false) \
+    OP(0xC3, "*DCP",     DCP, IZX, 8, false) \
+    OP(0xC4, "CPY",      CPY, ZP0, 3, false) \
+    OP(0xC5, "CMP",      CMP, ZP0, 3, false) \
+    OP(0xC6, "DEC",      DEC, ZP0, 5, false) \
+    OP(0xC7, "*DCP",     DCP, ZP0, 5, false) \
+    OP(0xC8, "INY",      INY, IMP, 2, false) \
+    OP(0xC9, "CMP",      CMP, IMM, 2, false) \
+    OP(0xCA, "DEX",      DEX, IMP, 2, false) \
+    OP(0xCB, "*UNKNOW*", UNK, IMP, 0, false) \
+    OP(0xCC, "CPY",      CPY, ABS, 4, false) \
+    OP(0xCD, "CMP",      CMP, ABS, 4, false) \
+    OP(0xCE, "DEC",      DEC, ABS, 6, false) \
+    OP(0xCF, "*DCP",     DCP, ABS, 6, false) \
+    OP(0xD0, "BNE",      BNE, REL, 2, false) \
+    OP(0xD1, "CMP",      CMP, IZY, 5, true) \
+    OP(0xD2, "*JAM",     JAM, IMP, 0, false) \
+    OP(0xD3, "*DCP",     DCP, IZY, 8, false) \
+    OP(0xD4, "*NOP",     NOP, ZPX, 4, false) \
+    OP(0xD5, "CMP",      CMP, ZPX, 4, false) \
+    OP(0xD6, "DEC",      DEC, ZPX, 6, false) \
+    OP(0xD7, "*DCP",     DCP, ZPX, 6, false) \
+    OP(0xD8, "CLD",      CLD, IMP, 2, false) \
+    OP(0xD9, "CMP",      CMP, ABY, 4, true) \
+    OP(0xDA, "*NOP",     NOP, IMP, 2, false) \
+    OP(0xDB, "*DCP",     DCP, ABY, 7, false) \
+    OP(0xDC, "*NOP",     NOP, ABX, 4, true) \
+    OP(0xDD, "CMP",      CMP, ABX, 4, true) \
+    OP(0xDE, "DEC",      DEC, ABX, 7, false) \
+    OP(0xDF, "*DCP",     DCP, ABX, 7, false) \
+    OP(0xE0, "CPX",      CPX, IMM, 2, false) \
+    OP(0xE1, "SBC",      SBC, IZX, 6, false) \
+    OP(0xE2, "*NOP",     NOP, IMM, 2, false) \
+    OP(0xE3, "*ISC",     ISC, IZX, 8, false) \
+    OP(0xE4, "CPX",      CPX, ZP0, 3, false) \
+    OP(0xE5, "SBC",      SBC, ZP0, 3, false) \
+    OP(0xE6, "INC",      INC, ZP0, 5, false) \
+    OP(0xE7, "*ISC",     ISC, ZP0, 5, false) \
+    OP(0xE8, "INX",      INX, IMP, 2, false) \
+    OP(0xE9, "SBC",      SBC, IMM, 2, false) \
+    OP(0xEA, "NOP",      NOP, IMP, 2, false) \
+    OP(0xEB, "*SBC",     SBC, IMM, 2, false) \
+    OP(0xEC, "CPX",      CPX, ABS, 4, false) \
+    OP(0xED, "SBC",      SBC, ABS, 4, false) \
+    OP(0xEE, "INC",      INC, ABS, 6, false) \
+    OP(0xEF, "*ISC",     ISC, ABS, 6, false) \
+    OP(0xF0, "BEQ",      BEQ, REL, 2, false) \
+    OP(0xF1, "SBC",      SBC, IZY, 5, true) \
+    OP(0xF2, "*JAM",     JAM, IMP, 0, false) \
+    OP(0xF3, "*ISC",     ISC, IZY, 8, false) \
+    OP(0xF4, "*NOP",     NOP, ZPX, 4, false) \
+    OP(0xF5, "SBC",      SBC, ZPX, 4, false) \
+    OP(0xF6, "INC",      INC, ZPX, 6, false) \
+    OP(0xF7, "*ISC",     ISC, ZPX, 6, false) \
+    OP(0xF8, "SED",      SED, IMP, 2, false) \
+    OP(0xF9, "SBC",      SBC, ABY, 4, true) \
+    OP(0xFA, "*NOP",     NOP, IMP, 2, false) \
+    OP(0xFB, "*ISC",     ISC, ABY, 7, false) \
+    OP(0xFC, "*NOP",     NOP, ABX, 4, true) \
+    OP(0xFD, "SBC",      SBC, ABX, 4, true) \
+    OP(0xFE, "INC",      INC, ABX, 7, false) \
+    OP(0xFF, "*ISC",     ISC, ABX, 7, false)
+
+// Build the opcode metadata array from the table
+#define CPU6502_OPCODE_INFO(code, mnemonic, instruction, mode, cycles, pageCross) \
+    { code, mnemonic, ADDR_##mode, instructionAccess(#instruction, ADDR_##mode), cycles, pageCross },
+
+constexpr OpcodeInfo6502 OPCODE_INFO_6502[256] = {
+    CPU6502_OPCODE_TABLE(CPU6502_OPCODE_INFO)
+};
+
+#undef CPU6502_OPCODE_INFO
+
+// Check at compile time that every op code is at its own index
+constexpr bool opcodeTableSorted() {
+    for (int i = 0; i < 256; i++) {
+        if (OPCODE_INFO_6502[i].opCode != i)
+            return false;
+    }
+
+    return true;
+}
+static_assert(opcodeTableSorted(), "6502 op codes table must be sorted by op code");
+}
+
+#endif
@@ -4,6 +4,7 @@
 #include "cpuBus.h"
 #include "cpu/cpu6502.h"
 #include "utility/utilityFunctions.h"
+#include "utility/stateBuffer.h"
 #include <cstdint>
 
 namespace nesCore {
@@ -12,6 +13,17 @@ Bus::Bus() : m_cpu(Cpu6502(this)), mp_ppu(nullptr), m_apu(APU()), mp_cartridge(n
     // Initializing RAM to zero
     std::fill(mp_ram, mp_ram + sizeof(mp_ram), 0x00);
     m_dmaCycles = false;
+
+    // Map the RAM and its mirrors, every other page is handled by the bus
+    m_pageTable.unmap(0x0000, 0xFFFF);
+    m_pageTable.map(0x0000, 0x1FFF, mp_ram, sizeof(mp_ram), true);
+
+    m_writeCount = 0;
+    m_ioReadCount = 0;
+    m_statusReadCount = 0;
+
+    // The DMC read its samples from the bus
+    m_apu.attachBus(this);
 }
 
 // Return true if the CPU should be halted for DMA execution 
@@ -25,6 +37,14 @@ bool Bus::dmaCycles() {
 // Attach a cartridge to the bus
 void Bus::attachCartriadge(Cartridge* cartridge) {
     this->mp_cartridge = cartridge;
+
+    // Let the cartridge map its memory in place of the old one
+    m_pageTable.unmap(0x6000, 0xFFFF);
+    if (cartridge != nullptr)
+        cartridge->attachPageTable(&m_pageTable);
+
+    // Instructions decoded from the old cartridge are invalid
+    m_cpu.flushDecodeCache();
 }
 // Attach ppu to the bus 
 void Bus::attachPpu(PPU* ppu) {
@@ -37,23 +57,40 @@ void Bus::attachIO(IOInterface* interface) {
 
 // Read a byte from the bus at the given address
 uint8_t Bus::read(uint16_t addr, bool debugRead) {
-    // RAM address range
-    if (addr >= 0x0000 && addr <= 0x07FF) 
-        return mp_ram[addr];
+    // Memory pages are read directly
+    uint8_t* page = m_pageTable.read[addr >> 8];
+    if (page != nullptr)
+        return page[addr & 0x00FF];
+
+    return this->readIO(addr, debugRead);
+}
 
+// Read a byte from the registers mapped at the given address
+uint8_t Bus::readIO(uint16_t addr, bool debugRead) {
     // PPU address range
-    else if (addr >= 0x2000 && addr <= 0x3FFF && mp_ppu != nullptr && !debugRead)
+    if (addr >= 0x2000 && addr <= 0x3FFF && mp_ppu != nullptr && !debugRead) {
+        m_ioReadCount++;
+        if ((addr & 0x0007) == 0x0002)
+            m_statusReadCount++;
+
         return mp_ppu->readRegister(addr);
+    }
 
     // APU Register range (0x4014 excluded)
-    else if (addr >= 0x4000 && addr <= 0x4015 && !debugRead)
+    else if (addr >= 0x4000 && addr <= 0x4015 && !debugRead) {
+        m_ioReadCount++;
         return m_apu.readRegister(addr);
+    }
 
     // IO address range
-    else if (addr == 0x4016 && mp_ioInterface != nullptr && !debugRead)
+    else if (addr == 0x4016 && mp_ioInterface != nullptr && !debugRead) {
+        m_ioReadCount++;
         return mp_ioInterface->readInputOne();
-    else if (addr == 0x4017 && mp_ioInterface != nullptr && !debugRead)
+    }
+    else if (addr == 0x4017 && mp_ioInterface != nullptr && !debugRead) {
+        m_ioReadCount++;
         return mp_ioInterface->readInputTwo();
+    }
 
     // PRG ROM address range
     else if (addr >= 0x6000 && addr <= 0xFFFF && mp_cartridge != nullptr)
@@ -85,12 +122,22 @@ uint16_t Bus::read16PageWrap(uint16_t addr, bool debugRead) {
 
 // Write a byte to the bus at the given address
 void Bus::write(uint16_t addr, uint8_t data) {
-    // RAM address range
-    if (addr >= 0x0000 && addr <= 0x07FF) 
-        mp_ram[addr] = data;
-    
+    m_writeCount++;
+
+    // Memory pages are written directly
+    uint8_t* page = m_pageTable.write[addr >> 8];
+    if (page != nullptr) {
+        page[addr & 0x00FF] = data;
+        return;
+    }
+
+    this->writeIO(addr, data);
+}
+
+// Write a byte to the registers mapped at the given address
+void Bus::writeIO(uint16_t addr, uint8_t data) {
     // PPU address range
-    else if (addr >= 0x2000 && addr <= 0x3FFF && mp_ppu != nullptr) 
+    if (addr >= 0x2000 && addr <= 0x3FFF && mp_ppu != nullptr) 
         mp_ppu->writeRegister(addr, data);
 
     // APU Register range 
@@ -109,9 +156,14 @@ void Bus::write(uint16_t addr, uint8_t data) {
     else if (addr == 0x4016 && mp_ioInterface != nullptr)
         mp_ioInterface->writeOutput(data);
 
-    // PRG ROM address range
-    else if (addr >= 0x6000 && addr <= 0xFFFF && mp_cartridge != nullptr)
+    // PRG ROM address range, the PPU must render
+    // with the old CHR banks up to this cycle
+    else if (addr >= 0x6000 && addr <= 0xFFFF && mp_cartridge != nullptr) {
+        if (mp_ppu != nullptr)
+            mp_ppu->sync();
+
         mp_cartridge->cpuWrite(addr, data);
+    }
 }
 
 // Write a 16 bit integer to the bus in little endian format
@@ -152,6 +204,32 @@ void Bus::OAMDMAtransfer(uint8_t pageNumber) {
     }
 }
 
+// Save the RAM, the bus counters, the CPU and the APU
+void Bus::saveState(utility::StateWriter& state) {
+    state.writeArray(mp_ram, sizeof(mp_ram));
+    state.write(m_dmaCycles);
+
+    state.write(m_writeCount);
+    state.write(m_ioReadCount);
+    state.write(m_statusReadCount);
+
+    m_cpu.saveState(state);
+    m_apu.saveState(state);
+}
+// Restore the RAM, the bus counters, the CPU and the APU,
+// the page table is kept up to date by the cartridge
+void Bus::loadState(utility::StateReader& state) {
+    state.readArray(mp_ram, sizeof(mp_ram));
+    state.read(m_dmaCycles);
+
+    state.read(m_writeCount);
+    state.read(m_ioReadCount);
+    state.read(m_statusReadCount);
+
+    m_cpu.loadState(state);
+    m_apu.loadState(state);
+}
+
 // Return a sting with a formatted region of the bus
 std::string Bus::formatRange(uint16_t from, uint16_t to, size_t width) {
     std::stringstream s;
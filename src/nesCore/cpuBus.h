@@ -3,6 +3,7 @@
 
 #include "nesPch.h"
 
+#include "cpuPageTable.h"
 #include "cpu/cpu6502.h"
 #include "cartridge/cartridge.h"
 #include "inputOutput/IOInterface.h"
@@ -15,6 +16,10 @@ class Bus {
 public:
     Bus();
 
+    // The CPU, the APU and the page table point in the bus
+    Bus(const Bus&) = delete;
+    Bus& operator=(const Bus&) = delete;
+
     // Attach a cartridge to the bus 
     void attachCartriadge(Cartridge* cartridge);
     // Attach an IO interface to the bus
@@ -34,12 +39,20 @@ public:
     // Return true if the CPU should be halted for DMA execution 
     bool dmaCycles();
 
+    // Save and restore the RAM, the CPU and the APU
+    void saveState(utility::StateWriter& state);
+    void loadState(utility::StateReader& state);
+
     // Return a sting with a formatted region of the bus
     // Take a memory range as input (both extreme are included)
     std::string formatRange(uint16_t from, uint16_t to, size_t width);
 
 // Private methods
 private:
+    // Access the registers of the pages without memory
+    uint8_t readIO(uint16_t addr, bool debugRead);
+    void writeIO(uint16_t addr, uint8_t data);
+
     // Run the OAM DMA transfer routine
     void OAMDMAtransfer(uint8_t pageNumber);
 
@@ -57,6 +70,15 @@ public:
     IOInterface* mp_ioInterface;
 
     bool m_dmaCycles;
+
+    // RAM, PRG RAM and PRG ROM pages are accessed directly
+    CpuPageTable m_pageTable;
+
+    // Side effects counters used by the CPU idle loop detection,
+    // I/O reads include the PPU status register reads
+    uint64_t m_writeCount;
+    uint64_t m_ioReadCount;
+    uint64_t m_statusReadCount;
 };
 }
 
@@ -0,0 +1,39 @@
+#ifndef CPU_PAGE_TABLE_H_
+#define CPU_PAGE_TABLE_H_
+
+#include "nesPch.h"
+
+// Number of 256 bytes pages in the CPU address space
+#define CPU_PAGES_COUNT 256
+
+namespace nesCore {
+// Host memory mapped in each 256 bytes page of the CPU address space.
+// Pages without memory are handled by the bus, a page can be
+// mapped for reading only so that writes reach the mapper registers
+struct CpuPageTable {
+    uint8_t* read[CPU_PAGES_COUNT];
+    uint8_t* write[CPU_PAGES_COUNT];
+
+    // Map the host memory of the given size to the address range
+    // (both extreme are included), the memory is mirrored
+    // if it's smaller than the address range
+    void map(uint16_t from, uint16_t to, uint8_t* memory, size_t size, bool writable) {
+        for (size_t page = from >> 8; page <= static_cast<size_t>(to >> 8); page++) {
+            uint8_t* pageMemory = memory + (((page << 8) - from) % size);
+
+            read[page] = pageMemory;
+            write[page] = writable ? pageMemory : nullptr;
+        }
+    }
+
+    // Send the accesses to the address range to the bus handlers
+    void unmap(uint16_t from, uint16_t to) {
+        for (size_t page = from >> 8; page <= static_cast<size_t>(to >> 8); page++) {
+            read[page] = nullptr;
+            write[page] = nullptr;
+        }
+    }
+};
+}
+
+#endif
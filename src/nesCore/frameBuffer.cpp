@@ -2,18 +2,19 @@
 
 #include "frameBuffer.h"
 #include "utility/utilityFunctions.h"
+#include "utility/pixelKernels.h"
 
 namespace nesCore {
-FrameBuffer::FrameBuffer() {
-    // Construct the raw frame buffer
-    mp_frameData = new uint8_t[SCREEN_WIDTH * SCREEN_HEIGHT * 3];
-    std::fill(mp_frameData, mp_frameData + (SCREEN_WIDTH * SCREEN_HEIGHT), 0);
+FrameBuffer::FrameBuffer() : m_format(FRAME_RGB), m_sequence(0) {
+    // Construct the three frames, cleared to black
+    mp_buffers = new utility::TripleBuffer<Buffer>();
+    mp_backIndices = mp_buffers->back().indices;
 
     // Fill the color palette with white
     std::fill(mp_colorPalette, mp_colorPalette + 64, 0xFFFFFFFF);
 }
 FrameBuffer::~FrameBuffer() {
-    delete [] mp_frameData;
+    delete mp_buffers;
 }
 
 // Load frame palette from file
@@ -33,35 +34,79 @@ int FrameBuffer::loadPalette(const std::string& filename) {
         return 2;
 
     // Parse the palette file
-    char color[3 * 64];
-    file.read(color, 3 * 64);
+    uint8_t color[3 * 64];
+    file.read(reinterpret_cast<char*>(color), 3 * 64);
 
-    // Load the all palette
-    uint32_t color32bits;
+    return this->setPalette(color, sizeof(color));
+}
+
+// Set the palette from the colors of a palette file
+int FrameBuffer::setPalette(const uint8_t* color, size_t size) {
+    if (size != 192)
+        return 2;
+
+    // Load the all palette in the byte order of the conversion kernels
+    utility::buildPixelPalette(color, utility::PIXEL_RGBA32, mp_colorPalette);
+
+    return 0;
+}
+// Write the palette back to the RGB colors of a palette file
+void FrameBuffer::getPalette(uint8_t* colors) {
     for (int i = 0; i < 64; i++) {
-        color32bits = 0xFF;
-        color32bits |= (color[(i*3) + 2] & 0xFF) << 8;
-        color32bits |= (color[(i*3) + 1] & 0xFF) << 8*2;
-        color32bits |= (color[(i*3) + 0] & 0xFF) << 8*3;
+        const uint8_t* pixel = reinterpret_cast<const uint8_t*>(&mp_colorPalette[i]);
 
-        mp_colorPalette[i] = color32bits;
+        colors[(i*3) + 0] = pixel[0];
+        colors[(i*3) + 1] = pixel[1];
+        colors[(i*3) + 2] = pixel[2];
     }
+}
 
-    return 0;
+void FrameBuffer::setFormat(FrameFormat format) {
+    m_format = format;
+}
+FrameFormat FrameBuffer::format() {
+    return m_format;
 }
 
-// Get the raw data pointer
+// Get the raw data pointer of the last completed frame
 uint8_t* FrameBuffer::data() {
-    return mp_frameData;
+    return const_cast<uint8_t*>(mp_buffers->published().pixels);
+}
+// Get the palette indices of the last completed frame
+const uint8_t* FrameBuffer::indices() {
+    return mp_buffers->published().indices;
+}
+// Get the number of completed frames
+uint64_t FrameBuffer::sequence() {
+    return m_sequence;
 }
 
 // Set a pixel color
 void FrameBuffer::setPixel(size_t x, size_t y, uint8_t color) {
-    size_t pixelAddress = (SCREEN_WIDTH * y) + x;
-    uint32_t rgbColor = mp_colorPalette[color & 0b00111111];
+    mp_backIndices[(SCREEN_WIDTH * y) + x] = color & 0b00111111;
+}
+// Publish the back buffer and continue in the free one, every pixel
+// is drawn again during the next frame
+void FrameBuffer::swapBuffers() {
+    Buffer& back = mp_buffers->back();
+    if (m_format == FRAME_RGB)
+        this->convertFrame(back.indices, back.pixels);
+
+    back.sequence = ++m_sequence;
+    mp_buffers->publish();
+    mp_backIndices = mp_buffers->back().indices;
+}
+
+// Convert the whole frame with the SIMD kernels selected for the host
+void FrameBuffer::convertFrame(const uint8_t* indices, uint8_t* pixels) {
+    utility::pixelKernels().indexToRgb24(indices, SCREEN_WIDTH * SCREEN_HEIGHT, mp_colorPalette, pixels);
+}
+
+// Take the latest completed frame, keep the current one if none was published
+FrameView FrameBuffer::latestFrame() {
+    mp_buffers->update();
 
-    mp_frameData[pixelAddress * 3]     = (rgbColor & 0xFF000000) >> 8*3;
-    mp_frameData[pixelAddress * 3 + 1] = (rgbColor & 0x00FF0000) >> 8*2;
-    mp_frameData[pixelAddress * 3 + 2] = (rgbColor & 0x0000FF00) >> 8;
+    const Buffer& front = mp_buffers->front();
+    return { front.pixels, front.indices, front.sequence };
 }
 }
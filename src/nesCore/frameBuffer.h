@@ -3,35 +3,100 @@
 
 #include "nesPch.h"
 
+#include "utility/tripleBuffer.h"
+
 namespace nesCore {
 
 const int SCREEN_WIDTH = 256;
 const int SCREEN_HEIGHT = 240;
 
+// Output of the completed frames
+enum FrameFormat {
+    // Palette index and RGB color of each pixel
+    FRAME_RGB = 0,
+    // Only the palette index, the RGB conversion is skipped
+    FRAME_INDEXED = 1,
+};
+
+// Completed frame seen by a consumer, the sequence is the number
+// of the frame since the start, 0 if no frame was completed yet.
+// The RGB data is not updated in the indexed format
+struct FrameView {
+    const uint8_t* data;
+    const uint8_t* indices;
+    uint64_t sequence;
+};
+
+// Triple-buffered frame buffer
+//
+// The PPU draws the 6 bits palette index of each pixel, one byte per pixel,
+// in the back buffer and swap it at the vblank. The completed frame is
+// converted to RGB in one pass, unless the format is indexed, then published
+// by an atomic index exchange. A consumer on another
+// thread takes the latest completed frame without copy and without ever
+// seeing a frame being drawn, the frames it doesn't take are dropped
 class FrameBuffer {
 public:
     FrameBuffer();
     ~FrameBuffer();
     
+    // The consumer points to the buffers
+    FrameBuffer(const FrameBuffer&) = delete;
+    FrameBuffer& operator=(const FrameBuffer&) = delete;
+
     // Load palette from file
     // Return 0 on success, 1 if the file doesn't exit
     // and 2 if it has the wrong format
     int loadPalette(const std::string& filename);
+    // Set the palette from the 64 RGB colors of a palette file
+    // Return 0 on success and 2 if it has the wrong size
+    int setPalette(const uint8_t* colors, size_t size);
+    // Write the 64 RGB colors of the palette, 192 bytes
+    void getPalette(uint8_t* colors);
+
+    // Set the format of the next completed frames
+    void setFormat(FrameFormat format);
+    FrameFormat format();
     
-    // Get a pointer to the raw frame data
+    // Get a pointer to the raw data of the last completed frame,
+    // only valid on the emulation side
     uint8_t* data();
+    // Get the palette indices of the last completed frame, emulation side
+    const uint8_t* indices();
+    // Number of completed frames, emulation side
+    uint64_t sequence();
 
-    // Set a pixel value to the given color;
-    // this function use the frame buffer color palette to 
-    // convert the 8 bits color value to a 32 bits RGBA value
+    // Set a pixel value to the given color, only the palette
+    // index is stored, the RGB color is set at the swap
     void setPixel(size_t x, size_t y, uint8_t color);
+    // Publish the frame being drawn as the last completed frame
+    void swapBuffers();
+
+    // Consumer side, get the latest completed frame, the view stays
+    // valid until the next call. A sequence equal to the one of the
+    // previous view means that no frame was completed since
+    FrameView latestFrame();
 
 private:
-    // RGBA frame buffer
-    uint8_t* mp_frameData;
+    struct Buffer {
+        uint8_t indices[SCREEN_WIDTH * SCREEN_HEIGHT];
+        uint8_t pixels[SCREEN_WIDTH * SCREEN_HEIGHT * 3];
+        uint64_t sequence;
+    };
+
+    // Convert the palette indices of a frame to RGB colors
+    void convertFrame(const uint8_t* indices, uint8_t* pixels);
+
+    // Frames, allocated on the heap with their 720 KB
+    utility::TripleBuffer<Buffer>* mp_buffers;
+    FrameFormat m_format;
+
+    // Indices of the back buffer and number of completed frames
+    uint8_t* mp_backIndices;
+    uint64_t m_sequence;
 
-    // Color palette use to convert the NES
-    // output color to RGB colors
+    // Color palette use to convert the NES output
+    // color to RGB colors, RGBA bytes in memory
     uint32_t mp_colorPalette[64];
 };
 }
@@ -6,6 +6,8 @@
 namespace nesCore {
 class IOInterface {
 public:
+    virtual ~IOInterface() {};
+
     // Write on the output port
     virtual void writeOutput(uint8_t data) = 0;
 
@@ -0,0 +1,66 @@
+#include "nesPch.h"
+
+#include "controllerIO.h"
+
+namespace nesCore {
+ControllerIO::ControllerIO() : m_strobe(0) {
+    m_buttons[0] = m_buttons[1] = 0x00;
+    m_shiftRegister[0] = m_shiftRegister[1] = 0x00;
+}
+
+// Set the buttons pressed on the controller of the given port
+void ControllerIO::setButtons(int port, uint8_t buttons) {
+    if (port == 0 || port == 1)
+        m_buttons[port] = buttons;
+}
+uint8_t ControllerIO::buttons(int port) {
+    return (port == 0 || port == 1) ? m_buttons[port] : 0x00;
+}
+
+// Convert a RLDUTSBA buttons field to the controller byte
+uint8_t ControllerIO::parseButtons(const std::string& buttons) {
+    uint8_t data = 0x00;
+
+    for (size_t i = 0; i < 8 && i < buttons.size(); i++) {
+        if (buttons[i] != '.' && buttons[i] != ' ')
+            data |= 0x80 >> i;
+    }
+
+    return data;
+}
+// Convert the controller byte to a RLDUTSBA buttons field
+std::string ControllerIO::formatButtons(uint8_t buttons) {
+    std::string field = "RLDUTSBA";
+
+    for (size_t i = 0; i < 8; i++) {
+        if ((buttons & (0x80 >> i)) == 0)
+            field[i] = '.';
+    }
+
+    return field;
+}
+
+// The strobe reload the shift registers with the buttons
+void ControllerIO::writeOutput(uint8_t data) {
+    m_strobe = data & 0x01;
+
+    if (m_strobe) {
+        m_shiftRegister[0] = m_buttons[0];
+        m_shiftRegister[1] = m_buttons[1];
+    }
+}
+
+// Shift out the buttons, A first
+uint8_t ControllerIO::readInputOne() {
+    uint8_t outputBit = m_shiftRegister[0] & 0x01;
+    m_shiftRegister[0] = m_strobe ? m_buttons[0] : m_shiftRegister[0] >> 1;
+
+    return outputBit;
+}
+uint8_t ControllerIO::readInputTwo() {
+    uint8_t outputBit = m_shiftRegister[1] & 0x01;
+    m_shiftRegister[1] = m_strobe ? m_buttons[1] : m_shiftRegister[1] >> 1;
+
+    return outputBit;
+}
+}
@@ -0,0 +1,53 @@
+#ifndef CONTROLLER_IO_H_
+#define CONTROLLER_IO_H_
+
+#include "nesPch.h"
+
+#include "IOInterface.h"
+
+namespace nesCore {
+// Buttons of the standard controller byte, shifted out A first
+enum ControllerButton {
+    BUTTON_A = 0b00000001,
+    BUTTON_B = 0b00000010,
+    BUTTON_SELECT = 0b00000100,
+    BUTTON_START = 0b00001000,
+    BUTTON_UP = 0b00010000,
+    BUTTON_DOWN = 0b00100000,
+    BUTTON_LEFT = 0b01000000,
+    BUTTON_RIGHT = 0b10000000,
+};
+
+// Two standard controllers with the buttons set by the host
+class ControllerIO: public IOInterface {
+public:
+    ControllerIO();
+
+    // Set the buttons pressed on the controller of the given port, 0 or 1
+    void setButtons(int port, uint8_t buttons);
+    // Return the buttons set on the controller of the given port
+    uint8_t buttons(int port);
+
+    // Convert a RLDUTSBA buttons field to the controller byte, any
+    // character other than '.' or ' ' is a pressed button
+    static uint8_t parseButtons(const std::string& buttons);
+    // Convert the controller byte to a RLDUTSBA buttons field,
+    // the released buttons are written as '.'
+    static std::string formatButtons(uint8_t buttons);
+
+    // Write on the output port
+    void writeOutput(uint8_t data) override;
+
+    // Read data on the input port
+    uint8_t readInputOne() override;
+    uint8_t readInputTwo() override;
+
+private:
+    // Buttons loaded in the shift registers while the strobe is set
+    uint8_t m_buttons[2];
+    uint8_t m_shiftRegister[2];
+    uint8_t m_strobe;
+};
+}
+
+#endif
@@ -0,0 +1,57 @@
+#include "nesPch.h"
+
+#include "recordingIO.h"
+
+namespace nesCore {
+RecordingIO::RecordingIO() : mp_ioInterface(nullptr) {}
+
+// Attach the interface the operations are forwarded to
+void RecordingIO::attachIO(IOInterface* interface) {
+    mp_ioInterface = interface;
+}
+
+// Forward the write to the attached interface
+void RecordingIO::writeOutput(uint8_t data) {
+    if (mp_ioInterface != nullptr)
+        mp_ioInterface->writeOutput(data);
+}
+
+// Read from the attached interface and record the value
+uint8_t RecordingIO::readInputOne() {
+    uint8_t data = mp_ioInterface != nullptr ? mp_ioInterface->readInputOne() : 0x00;
+    m_inputOne.push_back(data);
+
+    return data;
+}
+uint8_t RecordingIO::readInputTwo() {
+    uint8_t data = mp_ioInterface != nullptr ? mp_ioInterface->readInputTwo() : 0x00;
+    m_inputTwo.push_back(data);
+
+    return data;
+}
+
+ReplayIO::ReplayIO(RecordingIO* recording) : mp_recording(recording) {}
+
+// The writes were already forwarded by the recording
+void ReplayIO::writeOutput(uint8_t) {}
+
+// Return the oldest recorded value
+uint8_t ReplayIO::readInputOne() {
+    if (mp_recording->m_inputOne.empty())
+        return 0x00;
+
+    uint8_t data = mp_recording->m_inputOne.front();
+    mp_recording->m_inputOne.pop_front();
+
+    return data;
+}
+uint8_t ReplayIO::readInputTwo() {
+    if (mp_recording->m_inputTwo.empty())
+        return 0x00;
+
+    uint8_t data = mp_recording->m_inputTwo.front();
+    mp_recording->m_inputTwo.pop_front();
+
+    return data;
+}
+}
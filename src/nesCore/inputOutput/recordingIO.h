@@ -0,0 +1,54 @@
+#ifndef RECORDING_IO_H_
+#define RECORDING_IO_H_
+
+#include "nesPch.h"
+
+#include "IOInterface.h"
+
+#include <deque>
+
+namespace nesCore {
+// Forward the IO operations to the attached interface
+// and record the values read from the input ports
+class RecordingIO: public IOInterface {
+public:
+    RecordingIO();
+
+    // Attach the interface the operations are forwarded to
+    void attachIO(IOInterface* interface);
+
+    // Write on the output port
+    void writeOutput(uint8_t data) override;
+
+    // Read data on the input port
+    uint8_t readInputOne() override;
+    uint8_t readInputTwo() override;
+
+private:
+    friend class ReplayIO;
+
+    IOInterface* mp_ioInterface;
+
+    // Values read and not replayed yet
+    std::deque<uint8_t> m_inputOne;
+    std::deque<uint8_t> m_inputTwo;
+};
+
+// Replay the input values recorded by a RecordingIO in the same order
+class ReplayIO: public IOInterface {
+public:
+    ReplayIO(RecordingIO* recording);
+
+    // Write on the output port
+    void writeOutput(uint8_t data) override;
+
+    // Read data on the input port, return 0 if no value is left
+    uint8_t readInputOne() override;
+    uint8_t readInputTwo() override;
+
+private:
+    RecordingIO* mp_recording;
+};
+}
+
+#endif
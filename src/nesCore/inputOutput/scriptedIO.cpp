@@ -0,0 +1,51 @@
+#include "nesPch.h"
+
+#include "scriptedIO.h"
+
+namespace nesCore {
+ScriptedIO::ScriptedIO() : m_nextEvent(0) {}
+
+// Load the script from a file
+int ScriptedIO::loadScript(const std::string& filename) {
+    std::ifstream file(filename);
+    if (!file.good())
+        return 1;
+
+    m_events.clear();
+    m_nextEvent = 0;
+
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#')
+            continue;
+
+        // Frame number followed by one or two 8 characters fields
+        std::stringstream s(line);
+        Event event;
+        std::string padOne, padTwo;
+
+        if (!(s >> event.frame >> padOne) || padOne.size() != 8)
+            return 2;
+        if (s >> padTwo && padTwo.size() != 8)
+            return 2;
+
+        if (!m_events.empty() && event.frame <= m_events.back().frame)
+            return 2;
+
+        event.buttons[0] = parseButtons(padOne);
+        event.buttons[1] = padTwo.empty() ? 0x00 : parseButtons(padTwo);
+        m_events.push_back(event);
+    }
+
+    return 0;
+}
+
+// Set the buttons pressed in the given frame
+void ScriptedIO::setFrame(uint64_t frame) {
+    while (m_nextEvent < m_events.size() && m_events[m_nextEvent].frame <= frame) {
+        this->setButtons(0, m_events[m_nextEvent].buttons[0]);
+        this->setButtons(1, m_events[m_nextEvent].buttons[1]);
+        m_nextEvent++;
+    }
+}
+}
@@ -0,0 +1,42 @@
+#ifndef SCRIPTED_IO_H_
+#define SCRIPTED_IO_H_
+
+#include "nesPch.h"
+
+#include "controllerIO.h"
+
+#include <vector>
+
+namespace nesCore {
+// Standard controllers pressed by a script of timed inputs
+//
+// Each line of the script holds a frame number and the buttons of the two
+// controllers from that frame on, written RLDUTSBA like the movie files:
+// any character other than '.' or ' ' is a pressed button, for example
+// "120 ....T..." press start on frame 120. Empty lines and lines starting
+// with '#' are ignored, the frames must be in increasing order
+class ScriptedIO: public ControllerIO {
+public:
+    ScriptedIO();
+
+    // Load the script from a file
+    // Return 0 on success, 1 if the file can't be opened
+    // and 2 if a line has the wrong format
+    int loadScript(const std::string& filename);
+
+    // Set the buttons pressed in the given frame, must be called
+    // with increasing frames before running each frame
+    void setFrame(uint64_t frame);
+
+private:
+    struct Event {
+        uint64_t frame;
+        uint8_t buttons[2];
+    };
+
+    std::vector<Event> m_events;
+    size_t m_nextEvent;
+};
+}
+
+#endif
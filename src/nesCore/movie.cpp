@@ -0,0 +1,216 @@
+#include "nesPch.h"
+
+#include "movie.h"
+#include "nesEmulator.h"
+#include "utility/utilityFunctions.h"
+
+namespace nesCore {
+Movie::Movie() :
+    m_mode(MOVIE_IDLE), m_frame(0), m_resetRequested(false),
+    m_desyncs(0), m_firstDesync(-1) {}
+
+// Start recording from power on
+void Movie::startRecording() {
+    m_mode = MOVIE_RECORDING;
+    m_frames.clear();
+    m_frame = 0;
+    m_resetRequested = false;
+}
+
+// Load a movie and start playing it
+int Movie::startPlayback(const std::string& filename) {
+    std::ifstream file(filename);
+    if (!file.good())
+        return 1;
+
+    std::vector<Frame> frames;
+    std::vector<std::pair<size_t, uint64_t>> hashes;
+
+    std::string line;
+    while (std::getline(file, line)) {
+        if (!line.empty() && line.back() == '\r')
+            line.pop_back();
+
+        if (line.empty())
+            continue;
+
+        // Header line, only the state hashes are used
+        if (line[0] != '|') {
+            std::stringstream s(line);
+            std::string key;
+            s >> key;
+
+            if (key == "stateHash") {
+                size_t frame;
+                uint64_t hash;
+                if (!(s >> frame >> std::hex >> hash))
+                    return 2;
+
+                hashes.emplace_back(frame, hash);
+            }
+            continue;
+        }
+
+        // Input line: |commands|port0|port1|port2|
+        std::vector<std::string> fields;
+        std::stringstream s(line.substr(1));
+        std::string field;
+        while (std::getline(s, field, '|'))
+            fields.push_back(field);
+
+        if (fields.size() < 2)
+            return 2;
+
+        Frame frame;
+        frame.commands = static_cast<uint8_t>(std::atoi(fields[0].c_str()));
+        frame.buttons[0] = parseButtons(fields[1]);
+        frame.buttons[1] = fields.size() > 2 ? parseButtons(fields[2]) : 0x00;
+        frame.stateHash = 0;
+        frame.hasHash = false;
+
+        frames.push_back(frame);
+    }
+
+    for (const auto& hash : hashes) {
+        if (hash.first < frames.size()) {
+            frames[hash.first].stateHash = hash.second;
+            frames[hash.first].hasHash = true;
+        }
+    }
+
+    m_mode = MOVIE_PLAYBACK;
+    m_frames = frames;
+    m_frame = 0;
+    m_desyncs = 0;
+    m_firstDesync = -1;
+
+    return 0;
+}
+
+// Save the recorded frames as a FM2 movie
+int Movie::save(const std::string& filename, const std::string& romName) {
+    std::ofstream file(filename);
+    if (!file.good())
+        return 1;
+
+    // Header of a movie starting at power on with a controller on both ports
+    file << "version 3\n";
+    file << "emuVersion 22020\n";
+    file << "rerecordCount 0\n";
+    file << "palFlag 0\n";
+    file << "romFilename " << romName << "\n";
+    file << "guid 00000000-0000-0000-0000-000000000000\n";
+    file << "fourscore 0\n";
+    file << "microphone 0\n";
+    file << "port0 1\n";
+    file << "port1 1\n";
+    file << "port2 0\n";
+    file << "FDS 0\n";
+    file << "NewPPU 0\n";
+
+    for (size_t i = 0; i < m_frames.size(); i++) {
+        if (m_frames[i].hasHash) {
+            file << "stateHash " << i << " " << std::hex << std::setw(16) << std::setfill('0');
+            file << m_frames[i].stateHash << std::dec << "\n";
+        }
+    }
+
+    for (const Frame& frame : m_frames) {
+        file << "|" << static_cast<int>(frame.commands);
+        file << "|" << formatButtons(frame.buttons[0]);
+        file << "|" << formatButtons(frame.buttons[1]) << "||\n";
+    }
+
+    return file.good() ? 0 : 1;
+}
+
+// Press the reset button at the start of the next recorded frame
+void Movie::requestReset() {
+    m_resetRequested = true;
+}
+
+// Set the buttons of the next frame
+void Movie::beginFrame(NesEmulator& emulator, uint8_t liveOne, uint8_t liveTwo) {
+    if (m_mode == MOVIE_RECORDING) {
+        Frame frame;
+        frame.commands = m_resetRequested ? COMMAND_RESET : 0x00;
+        frame.buttons[0] = liveOne;
+        frame.buttons[1] = liveTwo;
+        frame.stateHash = 0;
+        frame.hasHash = false;
+
+        m_frames.push_back(frame);
+        m_resetRequested = false;
+    }
+
+    // Released controllers after the end of the movie
+    if (m_mode == MOVIE_IDLE || m_frame >= m_frames.size()) {
+        this->setButtons(0, m_mode == MOVIE_IDLE ? liveOne : 0x00);
+        this->setButtons(1, m_mode == MOVIE_IDLE ? liveTwo : 0x00);
+        return;
+    }
+
+    const Frame& frame = m_frames[m_frame];
+    if (frame.commands & (COMMAND_RESET | COMMAND_POWER))
+        emulator.reset();
+
+    this->setButtons(0, frame.buttons[0]);
+    this->setButtons(1, frame.buttons[1]);
+}
+
+// Record or check the state hash after the frame
+bool Movie::endFrame(NesEmulator& emulator) {
+    if (m_mode == MOVIE_IDLE || m_frame >= m_frames.size())
+        return true;
+
+    Frame& frame = m_frames[m_frame++];
+    uint64_t hash = stateHash(emulator);
+
+    if (m_mode == MOVIE_RECORDING) {
+        frame.stateHash = hash;
+        frame.hasHash = true;
+        return true;
+    }
+
+    if (!frame.hasHash || frame.stateHash == hash)
+        return true;
+
+    if (m_firstDesync < 0)
+        m_firstDesync = static_cast<int64_t>(m_frame - 1);
+    m_desyncs++;
+
+    return false;
+}
+
+MovieMode Movie::mode() {
+    return m_mode;
+}
+bool Movie::finished() {
+    return m_mode == MOVIE_PLAYBACK && m_frame >= m_frames.size();
+}
+size_t Movie::frames() {
+    return m_frames.size();
+}
+size_t Movie::frame() {
+    return m_frame;
+}
+size_t Movie::desyncs() {
+    return m_desyncs;
+}
+int64_t Movie::firstDesync() {
+    return m_firstDesync;
+}
+
+// Hash of the CPU RAM and registers, unlike the save states it
+// doesn't depend on the layout of the components
+uint64_t Movie::stateHash(NesEmulator& emulator) {
+    debug::Cpu6502Debug cpu = emulator.cpuDebugInfo();
+    uint64_t registers[] = {
+        cpu.cpuCycle, cpu.pc, cpu.stackPointer,
+        cpu.accumulator, cpu.regX, cpu.regY, cpu.statusByte
+    };
+
+    uint64_t hash = utility::hashBytes(emulator.getRam(), 2048);
+    return utility::hashBytes(reinterpret_cast<const uint8_t*>(registers), sizeof(registers), hash);
+}
+}
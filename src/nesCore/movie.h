@@ -0,0 +1,94 @@
+#ifndef MOVIE_H_
+#define MOVIE_H_
+
+#include "nesPch.h"
+
+#include "inputOutput/controllerIO.h"
+
+#include <vector>
+
+namespace nesCore {
+class NesEmulator;
+
+enum MovieMode {
+    MOVIE_IDLE = 0,
+    MOVIE_RECORDING = 1,
+    MOVIE_PLAYBACK = 2,
+};
+
+// Controller inputs of every frame from power on, recorded from the live
+// inputs of the frontend or played back in place of them
+//
+// The movie is the IO interface of the emulator, the buttons of a frame are
+// set before the frame and stay the same during the frame. After each frame
+// a hash of the CPU RAM and registers is recorded, or compared with the
+// recorded one to report the first frame of a desync. The movies are saved
+// in the FM2 format, the hashes are stored in header lines ignored by the
+// other emulators
+class Movie: public ControllerIO {
+public:
+    Movie();
+
+    // Start recording, the emulator must be at power on
+    void startRecording();
+    // Load a movie and start playing it, the emulator must be at power on
+    // Return 0 on success, 1 if the file can't be opened
+    // and 2 if it has the wrong format
+    int startPlayback(const std::string& filename);
+    // Save the recorded frames as a FM2 movie
+    // Return 0 on success, 1 if the file can't be written
+    int save(const std::string& filename, const std::string& romName);
+
+    // Press the reset button at the start of the next recorded frame
+    void requestReset();
+
+    // Set the buttons of the next frame, the live buttons are recorded
+    // while recording and replaced by the movie ones during the playback
+    void beginFrame(NesEmulator& emulator, uint8_t liveOne, uint8_t liveTwo);
+    // Record or check the state hash after the frame
+    // Return false if the playback desynced on this frame
+    bool endFrame(NesEmulator& emulator);
+
+    MovieMode mode();
+    // Return true when the playback reached the end of the movie
+    bool finished();
+    // Number of frames of the movie and current frame
+    size_t frames();
+    size_t frame();
+    // Number of desynced frames and first desynced frame, -1 if none
+    size_t desyncs();
+    int64_t firstDesync();
+
+    // Hash of the CPU RAM and registers
+    static uint64_t stateHash(NesEmulator& emulator);
+
+// Private types
+private:
+    // FM2 commands of a frame
+    enum Command {
+        COMMAND_RESET = 0x01,
+        COMMAND_POWER = 0x02,
+    };
+
+    struct Frame {
+        uint8_t commands;
+        uint8_t buttons[2];
+
+        uint64_t stateHash;
+        bool hasHash;
+    };
+
+// Private member variables
+private:
+    MovieMode m_mode;
+    std::vector<Frame> m_frames;
+    size_t m_frame;
+
+    bool m_resetRequested;
+
+    size_t m_desyncs;
+    int64_t m_firstDesync;
+};
+}
+
+#endif
@@ -0,0 +1,105 @@
+#include "nesPch.h"
+
+#include "nesCoreApi.h"
+#include "nesEmulator.h"
+#include "apu/audioSink.h"
+#include "inputOutput/controllerIO.h"
+
+#include <new>
+#include <vector>
+
+// Audio sink keeping the samples of the current frame
+class FrameAudioSink: public nesCore::AudioSink {
+public:
+    void pushSamples(const int16_t* samples, size_t count) override {
+        m_samples.insert(m_samples.end(), samples, samples + count);
+    }
+
+    std::vector<int16_t> m_samples;
+};
+
+// Emulator instance and the buffers given to the caller,
+// the emulator is destroyed before its IO and audio sink
+struct NesCore {
+    nesCore::ControllerIO controllers;
+    FrameAudioSink audio;
+    nesCore::NesEmulator emulator;
+
+    std::vector<uint8_t> state;
+};
+
+int nescore_api_version(void) {
+    return NESCORE_API_VERSION;
+}
+
+// Create an emulator instance with the controllers and the audio attached
+NesCore* nescore_create(void) {
+    NesCore* core = new (std::nothrow) NesCore();
+    if (core == nullptr)
+        return nullptr;
+
+    core->emulator.attachIO(&core->controllers);
+    core->emulator.attachAudioSink(&core->audio);
+
+    return core;
+}
+void nescore_destroy(NesCore* core) {
+    delete core;
+}
+
+int nescore_load_rom(NesCore* core, const uint8_t* data, size_t size) {
+    return core->emulator.loadCartridgeFromMemory(data, size) == 0 ? 0 : 1;
+}
+int nescore_load_palette(NesCore* core, const uint8_t* data, size_t size) {
+    return core->emulator.getFrameBuffer()->setPalette(data, size);
+}
+void nescore_set_sample_rate(NesCore* core, uint32_t sampleRate) {
+    core->emulator.setAudioSampleRate(sampleRate);
+}
+
+void nescore_reset(NesCore* core) {
+    core->emulator.reset();
+}
+// Run a frame, only its samples are kept
+void nescore_run_frame(NesCore* core) {
+    core->audio.m_samples.clear();
+
+    // The RAM may have been written since the last frame
+    core->emulator.ramWritten();
+    core->emulator.runFrame();
+}
+
+void nescore_set_input(NesCore* core, int port, uint8_t buttons) {
+    core->controllers.setButtons(port, buttons);
+}
+
+const uint8_t* nescore_frame(NesCore* core) {
+    return core->emulator.getFrameBuffer()->data();
+}
+const uint8_t* nescore_frame_indices(NesCore* core) {
+    return core->emulator.getFrameBuffer()->indices();
+}
+void nescore_set_indexed_output(NesCore* core, int indexed) {
+    core->emulator.getFrameBuffer()->setFormat(indexed != 0 ? nesCore::FRAME_INDEXED : nesCore::FRAME_RGB);
+}
+const int16_t* nescore_audio(NesCore* core, size_t* sampleCount) {
+    *sampleCount = core->audio.m_samples.size();
+    return core->audio.m_samples.data();
+}
+uint8_t* nescore_ram(NesCore* core) {
+    return core->emulator.getRam();
+}
+
+const uint8_t* nescore_save_state(NesCore* core, size_t* stateSize) {
+    if (core->emulator.saveState(core->state) != 0) {
+        *stateSize = 0;
+        return nullptr;
+    }
+
+    *stateSize = core->state.size();
+    return core->state.data();
+}
+int nescore_load_state(NesCore* core, const uint8_t* state, size_t stateSize) {
+    // The state is read in place, it can be the buffer of nescore_save_state
+    return core->emulator.loadState(state, stateSize);
+}
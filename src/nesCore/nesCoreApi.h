@@ -0,0 +1,96 @@
+#ifndef NES_CORE_API_H_
+#define NES_CORE_API_H_
+
+/*
+ *
+ *  nescore C API
+ *
+ *  Stable interface of the nescore library, usable from C and from other
+ *  languages through their C bindings. Every function take the instance it
+ *  works on, the instances share no state and can run in parallel threads.
+ *  The C++ classes of nesCore may change between versions, this API only
+ *  change with NESCORE_API_VERSION
+ *
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Incremented on every incompatible change of the API
+#define NESCORE_API_VERSION 1
+
+// Size of the RGB frame and of the CPU RAM
+#define NESCORE_FRAME_WIDTH 256
+#define NESCORE_FRAME_HEIGHT 240
+#define NESCORE_RAM_SIZE 2048
+
+// Buttons of the controller byte given to nescore_set_input
+#define NESCORE_BUTTON_A 0x01
+#define NESCORE_BUTTON_B 0x02
+#define NESCORE_BUTTON_SELECT 0x04
+#define NESCORE_BUTTON_START 0x08
+#define NESCORE_BUTTON_UP 0x10
+#define NESCORE_BUTTON_DOWN 0x20
+#define NESCORE_BUTTON_LEFT 0x40
+#define NESCORE_BUTTON_RIGHT 0x80
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Emulator instance
+typedef struct NesCore NesCore;
+
+// Return the NESCORE_API_VERSION the library was built with
+int nescore_api_version(void);
+
+// Create an emulator instance without cartridge, return NULL on failure
+NesCore* nescore_create(void);
+// Destroy an instance, NULL is ignored
+void nescore_destroy(NesCore* core);
+
+// Load a cartridge from the content of an iNES file, the data is copied
+// Return 0 on success, 1 on failure
+int nescore_load_rom(NesCore* core, const uint8_t* data, size_t size);
+// Set the 64 RGB colors of the frame from the content of a palette file,
+// the frame is white until a palette is set
+// Return 0 on success and 2 if the palette has the wrong size
+int nescore_load_palette(NesCore* core, const uint8_t* data, size_t size);
+// Set the sample rate of the audio samples, 44100 Hz by default
+void nescore_set_sample_rate(NesCore* core, uint32_t sampleRate);
+
+// Press the reset button
+void nescore_reset(NesCore* core);
+// Run the emulation up to the next frame, a cartridge must be loaded
+void nescore_run_frame(NesCore* core);
+
+// Set the buttons of the controller on port 0 or 1, used from the next read
+void nescore_set_input(NesCore* core, int port, uint8_t buttons);
+
+// RGB frame of NESCORE_FRAME_WIDTH * NESCORE_FRAME_HEIGHT pixels, last
+// completed frame valid until the next nescore_run_frame
+const uint8_t* nescore_frame(NesCore* core);
+// 6 bits palette index of each pixel of the same frame, one byte per pixel
+const uint8_t* nescore_frame_indices(NesCore* core);
+// Skip the RGB conversion of the next frames if indexed is not 0,
+// nescore_frame is then not updated
+void nescore_set_indexed_output(NesCore* core, int indexed);
+// Mono 16 bits samples produced by the last nescore_run_frame, the count
+// is written in sampleCount. Valid until the next nescore_run_frame
+const int16_t* nescore_audio(NesCore* core, size_t* sampleCount);
+// NESCORE_RAM_SIZE bytes of CPU RAM, can be written between two frames
+uint8_t* nescore_ram(NesCore* core);
+
+// Save the state of the instance, the size is written in stateSize.
+// Valid until the next save or load, return NULL if no cartridge is loaded
+const uint8_t* nescore_save_state(NesCore* core, size_t* stateSize);
+// Restore a state saved by an instance with the same cartridge
+// Return 0 on success, 1 if no cartridge is loaded, 2 if the
+// state has the wrong format and 3 if the cartridge is different
+int nescore_load_state(NesCore* core, const uint8_t* state, size_t stateSize);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
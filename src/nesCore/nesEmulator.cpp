@@ -10,10 +10,18 @@
 #include "frameBuffer.h"
 #include "inputOutput/IOInterface.h"
 #include "ppu/ppuDebug.h"
+#include "utility/stateBuffer.h"
+#include <chrono>
 #include <cstddef>
+#include <iterator>
 
 namespace nesCore {
-NesEmulator::NesEmulator() : m_cpuBus(), m_ppuBus(), mp_cartridge(nullptr) {
+NesEmulator::NesEmulator() : 
+    m_cpuBus(), m_ppuBus(), mp_cartridge(nullptr), mp_ioInterface(nullptr),
+    mp_reference(nullptr), mp_recordingIO(nullptr), mp_replayIO(nullptr),
+    m_runAheadFrames(0), mp_runAhead(nullptr),
+    m_runAheadFrameCount(0), m_runAheadMicroseconds(0.0)
+{
     // Setup CPU and CPU bus
     m_cpuBus.attachPpu(&m_ppuBus.m_ppu);
     m_cpuBus.m_cpu.reset();
@@ -21,10 +29,16 @@ NesEmulator::NesEmulator() : m_cpuBus(), m_ppuBus(), mp_cartridge(nullptr) {
     // Setup PPU
     m_ppuBus.m_ppu.attachFrameBuffer(&m_frameBuffer);
 
-    // Set the PPU interrupt to NOINT 
+    // Set the PPU and APU interrupts to NOINT 
     m_ppuInt = NOINT;
+    m_apuInt = NOINT;
+
+    m_dynarecDiverged = false;
 }
 NesEmulator::~NesEmulator() {
+    this->disableDifferentialMode();
+    this->disableRunAhead();
+
     if (mp_cartridge != nullptr) 
         delete mp_cartridge;
 }
@@ -57,32 +71,174 @@ int NesEmulator::setup(
 FrameBuffer* NesEmulator::getFrameBuffer() {
     return &m_frameBuffer;
 }
+// Get a pointer to the CPU RAM
+uint8_t* NesEmulator::getRam() {
+    return m_cpuBus.mp_ram;
+}
+// Forget the idle loop that may read the written RAM
+void NesEmulator::ramWritten() {
+    m_cpuBus.m_cpu.resetIdleLoop();
+}
 // Attach an IO interface to the cpu bus
 void NesEmulator::attachIO(IOInterface* interface) {
-    m_cpuBus.attachIO(interface);
+    mp_ioInterface = interface;
+
+    // In differential mode the inputs go through the recording
+    if (mp_recordingIO != nullptr)
+        mp_recordingIO->attachIO(interface);
+    else
+        m_cpuBus.attachIO(interface);
+
+    // The frames ahead read the same inputs
+    if (mp_runAhead != nullptr)
+        mp_runAhead->attachIO(interface);
+}
+
+// Attach the audio sink receiving the APU samples
+void NesEmulator::attachAudioSink(AudioSink* sink) {
+    m_cpuBus.m_apu.attachAudioSink(sink);
 }
+// Set the sample rate of the audio sink
+void NesEmulator::setAudioSampleRate(uint32_t sampleRate) {
+    m_cpuBus.m_apu.setSampleRate(sampleRate);
+}
+// Scale the sample rate by a ratio close to one
+void NesEmulator::setAudioRateRatio(double ratio) {
+    m_cpuBus.m_apu.setSampleRateRatio(ratio);
+}
+
+// Execute one CPU instruction, or one dynarec block or a run of
+// threaded instructions ending before the PPU or the APU can raise an interrupt
+void NesEmulator::step(size_t maxCycles) {
+    // The idle loop skipping is bounded by max cycles too
+    size_t syncCycles = std::min({
+        m_ppuBus.m_ppu.cpuCyclesToVblank(),
+        m_cpuBus.m_apu.cpuCyclesToDeadline(),
+        maxCycles
+    });
+
+    Interrupt6502 interrupt = static_cast<Interrupt6502>(m_ppuInt | m_apuInt);
+    size_t cpuCycle = m_cpuBus.m_cpu.step(interrupt, syncCycles);
+
+    // Fast forward the idle loops, the skipped iterations must end
+    // before the PPU reach the vblank or change its status register
+    // and before the APU deadline
+    if (cpuCycle != 0 && syncCycles > cpuCycle) {
+        size_t statusCycles = m_ppuBus.m_ppu.cpuCyclesToStatusChange();
+        size_t maxStatusCycles = statusCycles > cpuCycle ? statusCycles - cpuCycle - 1 : 0;
+
+        cpuCycle += m_cpuBus.m_cpu.skipIdleLoop(syncCycles - cpuCycle - 1, maxStatusCycles);
+    }
+
+    // The PPU and the APU only catch up with the CPU when required
+    m_ppuInt = m_ppuBus.m_ppu.run(cpuCycle);
+    m_apuInt = m_cpuBus.m_apu.run(cpuCycle);
 
-// Execute one CPU instruction
-void NesEmulator::step() {
-    size_t cpuCycle = m_cpuBus.m_cpu.step(m_ppuInt);
-    m_ppuInt = m_ppuBus.m_ppu.clock(cpuCycle);
+    if (mp_reference != nullptr)
+        this->checkReference(cpuCycle);
 }
 
 // Reset the emulator
 void NesEmulator::reset() {
+    // Finish the frame up to the reset
+    m_ppuBus.m_ppu.sync();
+    m_cpuBus.m_apu.sync();
+
     m_cpuBus.m_cpu.reset();
     m_ppuBus.m_ppu.reset();
+    m_cpuBus.m_apu.reset();
 
     if (mp_cartridge != nullptr)
         mp_cartridge->reset();
 
     m_ppuInt = NOINT;
+    m_apuInt = NOINT;
+
+    if (mp_reference != nullptr)
+        mp_reference->reset();
+}
+
+// Save the state of every component
+int NesEmulator::saveState(std::vector<uint8_t>& state) {
+    if (mp_cartridge == nullptr)
+        return 1;
+
+    utility::StateWriter writer(state);
+
+    // Header, the size is written once the state is complete
+    writer.write(static_cast<uint32_t>(NES_STATE_MAGIC));
+    writer.write(static_cast<uint32_t>(NES_STATE_VERSION));
+    writer.write(static_cast<uint32_t>(0));
+
+    mp_cartridge->saveState(writer);
+    m_cpuBus.saveState(writer);
+    m_ppuBus.saveState(writer);
+
+    writer.write(m_ppuInt);
+    writer.write(m_apuInt);
+
+    writer.patch(2 * sizeof(uint32_t), static_cast<uint32_t>(writer.size()));
+    return 0;
+}
+
+// Restore a state saved with the same cartridge
+int NesEmulator::loadState(const std::vector<uint8_t>& state) {
+    return this->loadState(state.data(), state.size());
+}
+// Restore a state from a buffer, the buffer is only read
+int NesEmulator::loadState(const uint8_t* data, size_t size) {
+    if (mp_cartridge == nullptr)
+        return 1;
+
+    utility::StateReader reader(data, size);
+
+    uint32_t magic = 0, version = 0, stateSize = 0;
+    reader.read(magic);
+    reader.read(version);
+    reader.read(stateSize);
+
+    if (magic != NES_STATE_MAGIC || version != NES_STATE_VERSION || stateSize != size)
+        return 2;
+
+    // The cartridge check its layout before changing anything
+    if (!mp_cartridge->loadState(reader))
+        return 3;
+
+    // The reference emulator can't follow the jump
+    this->disableDifferentialMode();
+
+    m_cpuBus.loadState(reader);
+    m_ppuBus.loadState(reader);
+
+    reader.read(m_ppuInt);
+    reader.read(m_apuInt);
+
+    return reader.failed() ? 2 : 0;
 }
 
 // Load a cartridge from a file
 int NesEmulator::loadCartridgeFromFile(const std::string& filename) {
     std::cout << "Attempting to load cartridge" << std::endl;
 
+    std::ifstream file(filename, std::ios_base::binary);
+    if (!file.good()) {
+        std::cerr << "Cartridge loading Failed" << std::endl;
+        return 1;
+    }
+
+    std::vector<uint8_t> data(
+        (std::istreambuf_iterator<char>(file)),
+        std::istreambuf_iterator<char>()
+    );
+
+    return this->loadCartridgeFromMemory(data.data(), data.size());
+}
+
+// Load a cartridge from the content of a ROM file
+int NesEmulator::loadCartridgeFromMemory(const uint8_t* data, size_t size) {
+    // The reference emulator run the old cartridge
+    this->disableDifferentialMode();
+
     // Deallocate old cartridge if attach
     if (mp_cartridge != nullptr) {
         delete mp_cartridge;
@@ -90,7 +246,7 @@ int NesEmulator::loadCartridgeFromFile(const std::string& filename) {
     }
 
     // Load the cartridge
-    mp_cartridge = Cartridge::loadCartridgeFromFile(filename);
+    mp_cartridge = Cartridge::loadCartridgeFromMemory(data, size);
     if (mp_cartridge == nullptr) {
         std::cerr << "Cartridge loading Failed" << std::endl;
         return 1;
@@ -101,6 +257,13 @@ int NesEmulator::loadCartridgeFromFile(const std::string& filename) {
     m_ppuBus.attachCartriadge(mp_cartridge);
     m_cpuBus.m_cpu.reset();
     m_ppuBus.m_ppu.reset();
+    m_cpuBus.m_apu.reset();
+
+    m_romData.assign(data, data + size);
+
+    // The second instance run the frames ahead of the new cartridge
+    if (mp_runAhead != nullptr && mp_runAhead->loadCartridgeFromMemory(data, size) != 0)
+        this->disableRunAhead();
 
     return 0;
 }
@@ -108,11 +271,229 @@ int NesEmulator::loadCartridgeFromFile(const std::string& filename) {
 bool NesEmulator::frameReady() {
     return m_ppuBus.m_ppu.frameReady();
 }
+// Execute the CPU instructions up to the next frame
+void NesEmulator::stepFrame() {
+    while (!this->frameReady())
+        this->step();
+}
 // Load the color palette from file
 int NesEmulator::loadPalette(const std::string& filename) {
     return m_frameBuffer.loadPalette(filename);
 }
 
+/*
+ *
+ *  Dynarec differential mode
+ *
+ */
+
+// Return true if the CPU registers and cycle counter are the same
+static bool sameCpuState(const debug::Cpu6502Debug& a, const debug::Cpu6502Debug& b) {
+    return a.cpuCycle == b.cpuCycle && a.pc == b.pc && a.stackPointer == b.stackPointer &&
+        a.accumulator == b.accumulator && a.regX == b.regX && a.regY == b.regY &&
+        a.statusByte == b.statusByte;
+}
+
+// Run a reference emulator using only the interpreter in lockstep
+int NesEmulator::enableDifferentialMode() {
+    if (mp_reference != nullptr)
+        return 0;
+
+    if (!m_cpuBus.m_cpu.getDebugInfo().dynarecEnabled) {
+        std::cerr << "Differential mode: the dynarec is not enabled" << std::endl;
+        return 1;
+    }
+
+    // Load the same cartridge in the reference emulator
+    mp_reference = new NesEmulator();
+    if (mp_reference->loadCartridgeFromMemory(m_romData.data(), m_romData.size()) != 0) {
+        std::cerr << "Differential mode: failed to load the reference cartridge" << std::endl;
+
+        delete mp_reference;
+        mp_reference = nullptr;
+        return 2;
+    }
+
+    mp_reference->m_cpuBus.m_cpu.enableDynarec(false);
+    mp_reference->m_cpuBus.m_cpu.enableIdleLoopSkip(false);
+
+    // Replay the inputs read by this emulator to the reference
+    mp_recordingIO = new RecordingIO();
+    mp_recordingIO->attachIO(mp_ioInterface);
+    m_cpuBus.attachIO(mp_recordingIO);
+
+    mp_replayIO = new ReplayIO(mp_recordingIO);
+    mp_reference->attachIO(mp_replayIO);
+
+    m_dynarecDiverged = false;
+    return 0;
+}
+
+// Delete the reference emulator and restore the IO interface
+void NesEmulator::disableDifferentialMode() {
+    if (mp_reference == nullptr)
+        return;
+
+    m_cpuBus.attachIO(mp_ioInterface);
+
+    delete mp_reference;
+    delete mp_replayIO;
+    delete mp_recordingIO;
+
+    mp_reference = nullptr;
+    mp_replayIO = nullptr;
+    mp_recordingIO = nullptr;
+}
+
+// Return true if a divergence was found
+bool NesEmulator::dynarecDiverged() {
+    return m_dynarecDiverged;
+}
+
+// Run the reference emulator up to the CPU cycle of this emulator
+void NesEmulator::checkReference(size_t cpuCycle) {
+    // Steps without cycles are always interpreted,
+    // execute the same instruction on the reference
+    if (cpuCycle == 0)
+        mp_reference->step();
+
+    debug::Cpu6502Debug state = m_cpuBus.m_cpu.getDebugInfo();
+    debug::Cpu6502Debug reference = mp_reference->cpuDebugInfo();
+
+    while (reference.cpuCycle < state.cpuCycle) {
+        mp_reference->step(state.cpuCycle - reference.cpuCycle);
+        debug::Cpu6502Debug next = mp_reference->cpuDebugInfo();
+
+        // Stop if the reference CPU halted
+        bool halted = next.cpuCycle == reference.cpuCycle;
+        reference = next;
+
+        if (halted)
+            break;
+    }
+
+    if (sameCpuState(state, reference))
+        return;
+
+    // Report the first divergence and stop comparing
+    std::cerr << "Dynarec divergence:" << std::endl;
+    std::cerr << "Dynarec:     " << state.log() << std::endl;
+    std::cerr << "Interpreter: " << reference.log() << std::endl;
+
+    m_dynarecDiverged = true;
+    this->disableDifferentialMode();
+}
+
+/*
+ *
+ *  Run-ahead
+ *
+ */
+
+// Run the emulation a number of frames ahead of the real one
+int NesEmulator::enableRunAhead(size_t frames, bool secondInstance) {
+    this->disableRunAhead();
+
+    if (frames == 0)
+        return 0;
+
+    // The reference emulator can't follow the state loads
+    if (mp_reference != nullptr) {
+        std::cerr << "Run-ahead: not available in differential mode" << std::endl;
+        return 1;
+    }
+
+    if (secondInstance) {
+        mp_runAhead = new NesEmulator();
+        if (mp_runAhead->loadCartridgeFromMemory(m_romData.data(), m_romData.size()) != 0) {
+            std::cerr << "Run-ahead: failed to load the second instance cartridge" << std::endl;
+
+            delete mp_runAhead;
+            mp_runAhead = nullptr;
+            return 2;
+        }
+
+        // The second instance draw in this emulator frame buffer
+        // and this emulator only produce the audio
+        mp_runAhead->m_ppuBus.m_ppu.attachFrameBuffer(&m_frameBuffer);
+        mp_runAhead->attachIO(mp_ioInterface);
+        mp_runAhead->enableOutputs(false, false);
+        this->enableOutputs(false, true);
+    }
+
+    m_runAheadFrames = frames;
+    m_runAheadFrameCount = 0;
+    m_runAheadMicroseconds = 0.0;
+
+    return 0;
+}
+
+// Delete the second instance and restore the outputs
+void NesEmulator::disableRunAhead() {
+    if (mp_runAhead != nullptr) {
+        delete mp_runAhead;
+        mp_runAhead = nullptr;
+    }
+
+    if (m_runAheadFrames != 0)
+        this->enableOutputs(true, true);
+
+    m_runAheadFrames = 0;
+}
+
+// Average host time added to each frame by the run-ahead
+double NesEmulator::runAheadFrameMicroseconds() {
+    return m_runAheadFrameCount != 0 ? m_runAheadMicroseconds / m_runAheadFrameCount : 0.0;
+}
+
+// Enable or disable the writes to the frame buffer and the audio samples
+void NesEmulator::enableOutputs(bool video, bool audio) {
+    m_ppuBus.m_ppu.enableOutput(video);
+    m_cpuBus.m_apu.enableOutput(audio);
+}
+
+// Execute the CPU instructions up to the next frame
+void NesEmulator::runFrame() {
+    if (m_runAheadFrames == 0) {
+        this->stepFrame();
+        return;
+    }
+
+    // The real frame, only its audio is used
+    if (mp_runAhead == nullptr)
+        this->enableOutputs(false, true);
+
+    this->stepFrame();
+
+    auto startTime = std::chrono::steady_clock::now();
+    this->saveState(m_runAheadState);
+
+    // Run the frames ahead with the current inputs, only the last one is drawn
+    NesEmulator* p_ahead = this;
+    if (mp_runAhead != nullptr) {
+        p_ahead = mp_runAhead;
+        p_ahead->loadState(m_runAheadState);
+    }
+
+    for (size_t i = 1; i <= m_runAheadFrames; i++) {
+        p_ahead->enableOutputs(i == m_runAheadFrames, false);
+        p_ahead->stepFrame();
+    }
+
+    // Go back to the real frame, the samples of the frames ahead are dropped
+    if (mp_runAhead == nullptr) {
+        this->loadState(m_runAheadState);
+        this->enableOutputs(true, true);
+    } else {
+        mp_runAhead->enableOutputs(false, false);
+    }
+
+    m_runAheadFrameCount++;
+    m_runAheadMicroseconds += std::chrono::duration<double, std::micro>(
+        std::chrono::steady_clock::now() - startTime
+    ).count();
+}
+
 /*
  *
  *  Debug functions
@@ -127,6 +508,10 @@ std::string NesEmulator::formatBusRange(uint16_t from, uint16_t to, size_t width
 std::string NesEmulator::decompileInstruction(uint16_t addr) {
     return debug::decompileInstruction(&m_cpuBus, addr);
 }
+// Read a byte of the CPU bus without side effects
+uint8_t NesEmulator::readMemory(uint16_t addr) {
+    return m_cpuBus.read(addr, true);
+}
 
 // return CPU debug info
 debug::Cpu6502Debug NesEmulator::cpuDebugInfo() {
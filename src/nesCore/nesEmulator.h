@@ -6,19 +6,32 @@
 #include "ppu/ppuDebug.h"
 
 #include "inputOutput/IOInterface.h"
+#include "inputOutput/recordingIO.h"
+#include "apu/audioSink.h"
 #include "cartridge/cartridge.h"
 #include "frameBuffer.h"
 #include "cpu/cpu6502.h"
 #include "cpuBus.h"
 #include "ppuBus.h"
 #include <cstddef>
+#include <vector>
+
+// Save state header, the version must change with the layout of any component
+#define NES_STATE_MAGIC 0x5353454E
+#define NES_STATE_VERSION 3
 
 namespace nesCore {
+// The emulator hold no global state, instances can be created and run
+// in parallel threads. The components point to each other so an instance
+// can't be copied or moved, it's passed between threads by pointer
 class NesEmulator {
 public:
     NesEmulator();
     ~NesEmulator();
 
+    NesEmulator(const NesEmulator&) = delete;
+    NesEmulator& operator=(const NesEmulator&) = delete;
+
 // Public methods
 public:
     // Setup the emulator, return 0 on success
@@ -29,26 +42,88 @@ public:
 
     // Get a pointer to the emulator frame buffer
     FrameBuffer* getFrameBuffer();
+    // Get a pointer to the 2 KB of CPU RAM
+    uint8_t* getRam();
+    // Must be called after writing the RAM through its pointer,
+    // the idle loop detection only see the writes of the CPU
+    void ramWritten();
     // Load a cartridge from a file
     // Return 0 on success, 1 on failure
     int loadCartridgeFromFile(const std::string& filename);
+    // Load a cartridge from the content of a ROM file
+    // Return 0 on success, 1 on failure
+    int loadCartridgeFromMemory(const uint8_t* data, size_t size);
     // Attach an IO interface to the emulator
     void attachIO(IOInterface* interface);
+    // Attach the audio sink receiving the APU samples, nullptr drop the samples
+    void attachAudioSink(AudioSink* sink);
+    // Set the sample rate of the audio sink
+    void setAudioSampleRate(uint32_t sampleRate);
+    // Scale the sample rate by a ratio close to one, used by the
+    // audio sink to keep its buffer level without audible pitch changes
+    void setAudioRateRatio(double ratio);
 
     // Load the color palette from file
     // Return 0 on success, 1 if the file doesn't exit
     // and 2 if it has the wrong format
     int loadPalette(const std::string& filename);
 
-    // Execute one CPU instruction
-    void step();
+    // Execute one CPU instruction, or a run of instructions ending before the
+    // PPU or the APU can raise an interrupt. No instruction is started
+    // after max cycles, the first one is always executed
+    void step(size_t maxCycles = SIZE_MAX);
     
     // Return true if the PPU finished a frame
     bool frameReady();
+    // Execute the CPU instructions up to the next frame, with
+    // run-ahead the frame buffer show a frame ahead of the emulation
+    void runFrame();
 
     // Reset the emulator
     void reset();
 
+    // Save states
+    //
+    // Copy the state of every component in a flat binary buffer, the
+    // buffer is reused so saving again in the same buffer doesn't allocate.
+    // The PPU and the APU are not synchronised, their pending cycles are
+    // part of the state. Return 0 on success, 1 if no cartridge is loaded
+    int saveState(std::vector<uint8_t>& state);
+    // Restore a state saved with the same cartridge. Return 0 on success,
+    // 1 if no cartridge is loaded, 2 if the state has the wrong format or
+    // version and 3 if it was saved with another cartridge layout
+    int loadState(const std::vector<uint8_t>& state);
+    // Restore a state from a buffer of the given size, same return values
+    int loadState(const uint8_t* data, size_t size);
+
+    // Dynarec differential mode
+    //
+    // Run a second emulator using only the interpreter in lockstep
+    // and report the first divergence of the CPU state, must be enabled
+    // after loading the cartridge and before the first step.
+    // Return 0 on success, 1 if the dynarec isn't enabled
+    // and 2 if the reference emulator can't load the cartridge
+    int enableDifferentialMode();
+    void disableDifferentialMode();
+    // Return true if a divergence was found
+    bool dynarecDiverged();
+
+    // Run-ahead
+    //
+    // Every frame the emulation runs the given number of frames ahead with
+    // the current inputs, the last one is shown and the emulation goes back,
+    // hiding the frames of lag between the inputs and the screen. Alone, the
+    // emulator saves and restores its own state and the audio of the frames
+    // ahead is dropped. The second instance runs the frames ahead on a copy
+    // of the state, this emulator only runs the real frames and keeps the
+    // audio continuous. The hidden frames don't write the frame buffer.
+    // Return 0 on success, 1 in differential mode
+    // and 2 if the second instance can't load the cartridge
+    int enableRunAhead(size_t frames, bool secondInstance);
+    void disableRunAhead();
+    // Average host time added to each frame by the run-ahead in microseconds
+    double runAheadFrameMicroseconds();
+
     // Debug info
     //
     // Return a sting with a formatted region of the bus
@@ -56,10 +131,23 @@ public:
     std::string formatBusRange(uint16_t from, uint16_t to, size_t width);
     // Decompile instruction
     std::string decompileInstruction(uint16_t addr);
+    // Read a byte of the CPU bus without side effects
+    uint8_t readMemory(uint16_t addr);
     // Return CPU or PPU debug info
     debug::Cpu6502Debug cpuDebugInfo();
     debug::PPUDebug ppuDebugInfo();
 
+// Private methods
+private:
+    // Run the reference emulator up to the CPU cycle of this emulator
+    // and compare the CPU state, take the cycles of the last step
+    void checkReference(size_t cpuCycle);
+
+    // Execute the CPU instructions up to the next frame
+    void stepFrame();
+    // Enable or disable the writes to the frame buffer and the audio samples
+    void enableOutputs(bool video, bool audio);
+
 // Private member variables
 private:
     Bus m_cpuBus;
@@ -67,11 +155,35 @@ private:
 
     // Interrupt Generated by the PPU
     Interrupt6502 m_ppuInt;
+    // State of the APU IRQ line
+    Interrupt6502 m_apuInt;
 
     // The emulator frame buffer
     FrameBuffer m_frameBuffer;
 
     Cartridge* mp_cartridge;
+    // Content of the ROM file, loaded again by the other instances
+    std::vector<uint8_t> m_romData;
+
+    IOInterface* mp_ioInterface;
+
+    // Differential mode reference emulator, the inputs read by this
+    // emulator are recorded and replayed to the reference one
+    NesEmulator* mp_reference;
+    RecordingIO* mp_recordingIO;
+    ReplayIO* mp_replayIO;
+
+    bool m_dynarecDiverged;
+
+    // Run-ahead frames, the state of the real frame
+    // and the second instance if used
+    size_t m_runAheadFrames;
+    std::vector<uint8_t> m_runAheadState;
+    NesEmulator* mp_runAhead;
+
+    // Run-ahead statistics
+    uint64_t m_runAheadFrameCount;
+    double m_runAheadMicroseconds;
 };
 }
 
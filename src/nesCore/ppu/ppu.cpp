@@ -4,9 +4,10 @@
 #include "ppuDebug.h"
 #include "nesCore/ppuBus.h"
 #include "ppu.h"
+#include "nesCore/utility/stateBuffer.h"
 
 namespace nesCore {
-PPU::PPU(PpuBus* ppuBus) : mp_ppuBus(ppuBus), mp_frameBuffer(nullptr) {
+PPU::PPU(PpuBus* ppuBus) : mp_ppuBus(ppuBus), mp_frameBuffer(nullptr), m_outputEnabled(true) {
     // Reset OAM memory
     uint8_t* p_OAM = reinterpret_cast<uint8_t*>(m_OAM);
     uint8_t* p_secondaryOAM = reinterpret_cast<uint8_t*>(m_secondaryOAM);
@@ -54,12 +55,35 @@ void PPU::reset() {
 
     m_spriteEvaCycle = 0;
     m_spriteZeroScanline = false;
+    m_spriteZeroNextScanline = false;
+
+    m_vblankStart = false;
+
+    // Reset the rendering shift registers
+    m_backgroundShiftH = 0x0000;
+    m_backgroundShiftL = 0x0000;
+    m_attributeShiftH = 0x0000;
+    m_attributeShiftL = 0x0000;
+
+    std::fill(m_spriteShiftH, m_spriteShiftH + 8, 0x00);
+    std::fill(m_spriteShiftL, m_spriteShiftL + 8, 0x00);
+    std::fill(m_spriteAttribute, m_spriteAttribute + 8, 0x00);
+    std::fill(m_spriteX, m_spriteX + 8, 0x00);
+    std::fill(&m_spritePixels[0][0], &m_spritePixels[0][0] + 64, 0x00);
+    m_spritePixelsValid = false;
+    m_busTileRow = ChrTileRow();
+
+    // Drop the pending cycles
+    m_pendingCycles = 0;
+    m_vblankDeadline = this->cpuCyclesToDot(241, 1);
 }
 
 // Get debug info
 debug::PPUDebug PPU::getDebugInfo() {
     debug::PPUDebug output;
 
+    this->sync();
+
     output.ppuCycles = m_ppuCycles;
 
     output.scanLine = m_scanLine;
@@ -77,13 +101,113 @@ debug::PPUDebug PPU::getDebugInfo() {
     return output;
 }
 
+// Save the PPU state, the frame buffer is an output and isn't saved,
+// the frame in progress is drawn again from the restored state
+void PPU::saveState(utility::StateWriter& state) {
+    // Timing and rendering registers
+    state.write(m_ppuCycles);
+    state.write(m_pendingCycles);
+    state.write(m_vblankDeadline);
+    state.write(m_scanLine);
+    state.write(m_scanCycle);
+    state.write(m_vblankStart);
+    state.write(m_oddFrame);
+
+    state.write(m_backgroundShiftH);
+    state.write(m_backgroundShiftL);
+    state.write(m_attributeShiftH);
+    state.write(m_attributeShiftL);
+    state.write(m_ppuAddrTmp);
+    state.write(m_ppuAddrCurrent);
+    state.write(m_xFineScrolling);
+
+    // Sprites
+    state.write(m_spritePosition);
+    state.writeArray(m_OAM, 64);
+    state.writeArray(m_secondaryOAM, 8);
+    state.write(m_primaryOAMpos);
+    state.write(m_secondaryOAMpos);
+    state.writeArray(m_spriteShiftH, 8);
+    state.writeArray(m_spriteShiftL, 8);
+    state.writeArray(m_spriteAttribute, 8);
+    state.writeArray(m_spriteX, 8);
+    state.writeArray(&m_spritePixels[0][0], 64);
+    state.write(m_spritePixelsValid);
+    state.write(m_busTileRow);
+    state.write(m_spriteZeroScanline);
+    state.write(m_spriteZeroNextScanline);
+    state.write(m_spriteEvaCycle);
+
+    // Registers
+    state.write(m_ppuCtrl);
+    state.write(m_ppuMask);
+    state.write(m_ppuStatus);
+    state.write(m_oamAddr);
+    state.write(m_oamData);
+    state.write(m_wLatch);
+    state.write(m_ppuData);
+    state.write(m_busLatch);
+}
+// Restore the PPU state
+void PPU::loadState(utility::StateReader& state) {
+    // Timing and rendering registers
+    state.read(m_ppuCycles);
+    state.read(m_pendingCycles);
+    state.read(m_vblankDeadline);
+    state.read(m_scanLine);
+    state.read(m_scanCycle);
+    state.read(m_vblankStart);
+    state.read(m_oddFrame);
+
+    state.read(m_backgroundShiftH);
+    state.read(m_backgroundShiftL);
+    state.read(m_attributeShiftH);
+    state.read(m_attributeShiftL);
+    state.read(m_ppuAddrTmp);
+    state.read(m_ppuAddrCurrent);
+    state.read(m_xFineScrolling);
+
+    // Sprites
+    state.read(m_spritePosition);
+    state.readArray(m_OAM, 64);
+    state.readArray(m_secondaryOAM, 8);
+    state.read(m_primaryOAMpos);
+    state.read(m_secondaryOAMpos);
+    state.readArray(m_spriteShiftH, 8);
+    state.readArray(m_spriteShiftL, 8);
+    state.readArray(m_spriteAttribute, 8);
+    state.readArray(m_spriteX, 8);
+    state.readArray(&m_spritePixels[0][0], 64);
+    state.read(m_spritePixelsValid);
+    state.read(m_busTileRow);
+    state.read(m_spriteZeroScanline);
+    state.read(m_spriteZeroNextScanline);
+    state.read(m_spriteEvaCycle);
+
+    // Registers
+    state.read(m_ppuCtrl);
+    state.read(m_ppuMask);
+    state.read(m_ppuStatus);
+    state.read(m_oamAddr);
+    state.read(m_oamData);
+    state.read(m_wLatch);
+    state.read(m_ppuData);
+    state.read(m_busLatch);
+}
+
 // Attach the frame buffer to the PPU
 void PPU::attachFrameBuffer(FrameBuffer* buffer) {
     mp_frameBuffer = buffer;
 }
+// Enable or disable the writes to the frame buffer
+void PPU::enableOutput(bool enable) {
+    m_outputEnabled = enable;
+}
 
 // Register read and write
 uint8_t PPU::readRegister(uint16_t addr) {
+    this->sync();
+
     addr = (addr - 0x2000) % 0x0008;
 
     switch (addr) {
@@ -140,6 +264,8 @@ uint8_t PPU::readRegister(uint16_t addr) {
     return 0x00;
 }
 void PPU::writeRegister(uint16_t addr, uint8_t data) {
+    this->sync();
+
     // Ignore all write operation before cycle 29658
     if (m_ppuCycles <= 29658)
         return;
@@ -252,6 +378,53 @@ inline void PPU::coarseResetY() {
     m_ppuAddrCurrent = (m_ppuAddrCurrent & 0x041F) | (m_ppuAddrTmp & 0x7BE0);
 }
 
+// Fetch the pattern row and the attribute bits of the next background tile
+inline const ChrTileRow& PPU::fetchTileRow(uint8_t& attribute) {
+    // Load the next tile attribute datas
+    uint16_t attributeAddr = 0x23C0;
+    attributeAddr |= (m_ppuAddrCurrent & 0x0C00) | ((m_ppuAddrCurrent >> 4) & 0x38) | ((m_ppuAddrCurrent >> 2) & 0x07);
+    
+    uint8_t attributeShift = (m_ppuAddrCurrent & 0x0002) ;
+    attributeShift |= (m_ppuAddrCurrent & 0x0040) >> 4;
+
+    attribute = mp_ppuBus->read(attributeAddr);
+    attribute = (attribute >> attributeShift) & 0x03;
+
+    // Load the tile pattern address
+    uint16_t patternTable = m_ppuCtrl & CTRL_BRG_PATTERN ? 0x1000: 0x0000;
+    uint8_t tile = mp_ppuBus->read(0x2000 | patternTable | (m_ppuAddrCurrent & 0x0FFF));
+
+    uint16_t patternAddr = (m_ppuAddrCurrent >> 12) | static_cast<uint16_t>(tile) << 4;
+    patternAddr |= ((m_ppuCtrl & CTRL_BRG_PATTERN) != 0) << 12;
+
+    // Increment X 
+    coarseIncX();
+
+    // With the address bit 15 set both planes are read from the same byte
+    if (patternAddr & 0x08) {
+        m_busTileRow.high = mp_ppuBus->read(patternAddr | 8);
+        m_busTileRow.low = mp_ppuBus->read(patternAddr);
+        decodeTileRow(m_busTileRow);
+
+        return m_busTileRow;
+    }
+
+    return mp_ppuBus->readTileRow(patternAddr);
+}
+
+// Load the next tile in the low byte of the background shift registers
+inline void PPU::fetchBackgroundTile() {
+    uint8_t attribute;
+    const ChrTileRow& row = fetchTileRow(attribute);
+
+    m_attributeShiftH |= attribute & 0x02 ? 0xFF : 0x00;
+    m_attributeShiftL |= attribute & 0x01 ? 0xFF : 0x00;
+
+    // Load new data in pattern table shift registers 
+    m_backgroundShiftH |= row.high;
+    m_backgroundShiftL |= row.low;
+}
+
 // Execute all the operation necessary for background rendering
 inline void PPU::backgroundEvaluation() {
     // Shift the pattern table and attribute register
@@ -267,33 +440,8 @@ inline void PPU::backgroundEvaluation() {
 
     // Address register Increment and updates
     if (m_scanLine < 240 || m_scanLine == 261) {
-        if ((m_scanCycle % 8 == 0) && ((m_scanCycle > 0 && m_scanCycle < 257) || (m_scanCycle > 320 && m_scanCycle < 337))) {
-            // Load the next tile attribute datas
-            uint16_t attributeAddr = 0x23C0;
-            attributeAddr |= (m_ppuAddrCurrent & 0x0C00) | ((m_ppuAddrCurrent >> 4) & 0x38) | ((m_ppuAddrCurrent >> 2) & 0x07);
-            
-            uint8_t attributeShift = (m_ppuAddrCurrent & 0x0002) ;
-            attributeShift |= (m_ppuAddrCurrent & 0x0040) >> 4;
-
-            uint8_t attribute = mp_ppuBus->read(attributeAddr);
-            attribute = attribute >> attributeShift;
-            
-            m_attributeShiftH |= attribute & 0x02 ? 0xFF : 0x00;
-            m_attributeShiftL |= attribute & 0x01 ? 0xFF : 0x00;
-
-            // Load new data in pattern table shift registers 
-            uint16_t patternTable = m_ppuCtrl & CTRL_BRG_PATTERN ? 0x1000: 0x0000;
-            uint8_t tile = mp_ppuBus->read(0x2000 | patternTable | (m_ppuAddrCurrent & 0x0FFF));
-
-            uint16_t patternAddr = (m_ppuAddrCurrent >> 12) | static_cast<uint16_t>(tile) << 4;
-            patternAddr |= ((m_ppuCtrl & CTRL_BRG_PATTERN) != 0) << 12;
-
-            m_backgroundShiftH |= mp_ppuBus->read(patternAddr | 8);
-            m_backgroundShiftL |= mp_ppuBus->read(patternAddr);
-
-            // Increment X 
-            coarseIncX();
-        }
+        if ((m_scanCycle % 8 == 0) && ((m_scanCycle > 0 && m_scanCycle < 257) || (m_scanCycle > 320 && m_scanCycle < 337)))
+            fetchBackgroundTile();
 
         // Increment Y
         if (m_scanCycle == 256) {
@@ -329,99 +477,130 @@ inline void PPU::spriteEvaluation() {
     uint8_t spriteSize = m_ppuCtrl & CTRL_SPRITE_SIZE ? 16 : 8;
 
     // Copy data to secondary OAM
-    if (m_scanCycle >= m_spriteEvaCycle && m_scanCycle <= 256) {
-        if (m_secondaryOAMpos < 8) {
-            // Copy the Y coordinate of the sprite at the current position 
-            // of the primary OAM to a free slot of the secondary OAM
-            // If the Y value is in range copy the remaining 3 sprite bytes
-            // and increment secondary OAM position
-            uint8_t valueY = m_OAM[m_primaryOAMpos].y;
-
-            // Copy if in range
-            if (m_scanLine >= valueY && m_scanLine < valueY + spriteSize) {
-                for (int i = 0; i < 4; i++)
-                    m_secondaryOAM[m_secondaryOAMpos] = m_OAM[m_primaryOAMpos];
-
-                if (m_primaryOAMpos == 0)
-                    m_spriteZeroNextScanline = true;
-
-                m_secondaryOAMpos += 1;
-                m_spriteEvaCycle += 6;
-            }
+    if (m_scanCycle >= m_spriteEvaCycle && m_scanCycle <= 256)
+        evaluateSprite(spriteSize);
+
+    // Copy data to rendering register for the next scanline
+    if (m_scanCycle  == 257)
+        loadSprites(spriteSize);
+}
+
+// Copy the sprite at the primary OAM position to the secondary OAM
+// if it's in range of the current scan line
+inline void PPU::evaluateSprite(uint8_t spriteSize) {
+    if (m_secondaryOAMpos < 8) {
+        // Copy the Y coordinate of the sprite at the current position 
+        // of the primary OAM to a free slot of the secondary OAM
+        // If the Y value is in range copy the remaining 3 sprite bytes
+        // and increment secondary OAM position
+        uint8_t valueY = m_OAM[m_primaryOAMpos].y;
+
+        // Copy if in range
+        if (m_scanLine >= valueY && m_scanLine < valueY + spriteSize) {
+            for (int i = 0; i < 4; i++)
+                m_secondaryOAM[m_secondaryOAMpos] = m_OAM[m_primaryOAMpos];
+
+            if (m_primaryOAMpos == 0)
+                m_spriteZeroNextScanline = true;
+
+            m_secondaryOAMpos += 1;
+            m_spriteEvaCycle += 6;
+        }
+    } else {
+        // Check if another sprite is on the same scanline and set the sprite overflow flag
+        uint8_t value = reinterpret_cast<uint8_t*>(m_OAM)[(m_primaryOAMpos * 4) + m_spritePosition];
+        if (m_scanLine >= value && m_scanLine < value + spriteSize) {
+            m_ppuStatus |= STATUS_SPR_OVERFLOW;
         } else {
-            // Check if another sprite is on the same scanline and set the sprite overflow flag
-            uint8_t value = reinterpret_cast<uint8_t*>(m_OAM)[(m_primaryOAMpos * 4) + m_spritePosition];
-            if (m_scanLine >= value && m_scanLine < value + spriteSize) {
-                m_ppuStatus |= STATUS_SPR_OVERFLOW;
-            } else {
-                // Increment the sprite read position,
-                // this is a PPU hardware bug
-                m_spritePosition += 1;
-                if (m_spritePosition >= 4)
-                    m_spritePosition = 0;
-            }
+            // Increment the sprite read position,
+            // this is a PPU hardware bug
+            m_spritePosition += 1;
+            if (m_spritePosition >= 4)
+                m_spritePosition = 0;
         }
-            
-        m_spriteEvaCycle += 2;
-
-        // Increment the primary OAM position
-        m_primaryOAMpos += 1;
-        if (m_primaryOAMpos >= 64)
-            m_spriteEvaCycle = 257;
     }
+        
+    m_spriteEvaCycle += 2;
 
-    // Copy data to rendering register for the next scanline
-    if (m_scanCycle  == 257) {
-        // Set sprite zero hit scanline for the incoming scanline
-        m_spriteZeroScanline = m_spriteZeroNextScanline;
+    // Increment the primary OAM position
+    m_primaryOAMpos += 1;
+    if (m_primaryOAMpos >= 64)
+        m_spriteEvaCycle = 257;
+}
 
-        int i = 0;
+// Load the sprites of the secondary OAM in the rendering registers
+inline void PPU::loadSprites(uint8_t spriteSize) {
+    // Set sprite zero hit scanline for the incoming scanline
+    m_spriteZeroScanline = m_spriteZeroNextScanline;
 
-        // Loop for not empty sprite slot
-        for (; i < 8; i++) {
-            uint8_t spriteY = m_secondaryOAM[i].y;
-            uint8_t attribute = m_secondaryOAM[i].attribute;
+    int i = 0;
 
-            if (spriteY == 0xFF)
-                break;
+    // Loop for not empty sprite slot
+    for (; i < 8; i++) {
+        uint8_t spriteY = m_secondaryOAM[i].y;
+        uint8_t attribute = m_secondaryOAM[i].attribute;
 
-            m_spriteAttribute[i] = attribute;
-            m_spriteX[i] = m_secondaryOAM[i].x;
+        if (spriteY == 0xFF)
+            break;
 
-            uint8_t tileNumber = m_secondaryOAM[i].tile;
-            bool vFlip = attribute & SPRITE_FLIP_V;
+        m_spriteAttribute[i] = attribute;
+        m_spriteX[i] = m_secondaryOAM[i].x;
 
-            uint8_t tileY;
-            if (vFlip)
-                tileY = (spriteSize - 1) - (m_scanLine - spriteY);
-            else 
-                tileY = m_scanLine - spriteY;
+        uint8_t tileNumber = m_secondaryOAM[i].tile;
+        bool vFlip = attribute & SPRITE_FLIP_V;
 
-            // Calculate the tile pattern address
-            uint16_t patternAddr;
-            if (spriteSize == 8) {
-                uint16_t patternTable = m_ppuCtrl & CTRL_SPR_PATTERN ? 0x1000 : 0x0000;
-                patternAddr = patternTable | (tileNumber << 4) | tileY;
-            } else {
-                uint16_t patternTable = tileNumber & 0x01 ? 0x1000 : 0x0000;
-                patternAddr = patternTable | ((tileNumber & 0xFE) << 4) | tileY;
-            }
+        uint8_t tileY;
+        if (vFlip)
+            tileY = (spriteSize - 1) - (m_scanLine - spriteY);
+        else 
+            tileY = m_scanLine - spriteY;
 
-            // Fetch the pattern data
-            m_spriteShiftL[i] = mp_ppuBus->read(patternAddr);
-            m_spriteShiftH[i] = mp_ppuBus->read(patternAddr | 0x08);
+        // Calculate the tile pattern address
+        uint16_t patternAddr;
+        if (spriteSize == 8) {
+            uint16_t patternTable = m_ppuCtrl & CTRL_SPR_PATTERN ? 0x1000 : 0x0000;
+            patternAddr = patternTable | (tileNumber << 4) | tileY;
+        } else {
+            uint16_t patternTable = tileNumber & 0x01 ? 0x1000 : 0x0000;
+            patternAddr = patternTable | ((tileNumber & 0xFE) << 4) | tileY;
         }
 
-        // Remaining empty sprite slot 
-        for (; i < 8; i++) {
-            // Fill the sprite shift register with 0
-            m_spriteShiftL[i] = 0x00;
-            m_spriteShiftH[i] = 0x00;
+        // Fetch the pattern data, rows of the bottom tile of
+        // 8x16 sprites read both planes from the same byte
+        if (tileY < 8) {
+            const ChrTileRow& row = mp_ppuBus->readTileRow(patternAddr);
 
-            m_spriteX[i] = 0xFF;
-            m_spriteAttribute[i] = 0xFF;
+            m_spriteShiftL[i] = row.low;
+            m_spriteShiftH[i] = row.high;
+
+            const uint8_t* pixels = attribute & SPRITE_FLIP_H ? row.flipped : row.pixels;
+            std::copy(pixels, pixels + 8, m_spritePixels[i]);
+        } else {
+            m_busTileRow.low = mp_ppuBus->read(patternAddr);
+            m_busTileRow.high = mp_ppuBus->read(patternAddr | 0x08);
+            decodeTileRow(m_busTileRow);
+
+            m_spriteShiftL[i] = m_busTileRow.low;
+            m_spriteShiftH[i] = m_busTileRow.high;
+
+            const uint8_t* pixels = attribute & SPRITE_FLIP_H ? m_busTileRow.flipped : m_busTileRow.pixels;
+            std::copy(pixels, pixels + 8, m_spritePixels[i]);
         }
     }
+
+    // Remaining empty sprite slot 
+    for (; i < 8; i++) {
+        // Fill the sprite shift register with 0
+        m_spriteShiftL[i] = 0x00;
+        m_spriteShiftH[i] = 0x00;
+
+        m_spriteX[i] = 0xFF;
+        m_spriteAttribute[i] = 0xFF;
+
+        std::fill(m_spritePixels[i], m_spritePixels[i] + 8, 0x00);
+    }
+
+    m_spritePixelsValid = true;
 }
 
 // Rendering function
@@ -448,6 +627,9 @@ inline void PPU::rendering() {
 
         // Handle sprite rendering and priority 
         if (m_ppuMask & MASK_SHOW_SPR) {
+            // The decoded pixels no longer match the shift registers
+            m_spritePixelsValid = false;
+
             uint8_t sprAttribute = 0x00;
             uint8_t sprPixel = 0x00;
             uint8_t sprNumber = 1;
@@ -499,22 +681,234 @@ inline void PPU::rendering() {
         }
 
         // Update pixel color
-        uint8_t outputColor;
-        if (outputPixel) 
-            outputColor = mp_ppuBus->read(outputPaletteAddr | outputPixel);
-        else
-            outputColor = mp_ppuBus->read(0x3F00);
+        if (m_outputEnabled) {
+            uint8_t outputColor;
+            if (outputPixel) 
+                outputColor = mp_ppuBus->read(outputPaletteAddr | outputPixel);
+            else
+                outputColor = mp_ppuBus->read(0x3F00);
 
-        mp_frameBuffer->setPixel(m_scanCycle - 1, m_scanLine, outputColor);
+            mp_frameBuffer->setPixel(m_scanCycle - 1, m_scanLine, outputColor);
+        }
     }
 }
 
+#if defined(NES_PPU_SCANLINE_RENDERER)
+// Execute the 341 dots of the current scan line in one pass.
+// Produce the same frame buffer and registers of the dot renderer,
+// the CPU can't access the PPU while the line is executed
+inline Interrupt6502 PPU::renderScanline() {
+    Interrupt6502 outputInterrupt = NOINT;
+
+    if (m_ppuMask & (MASK_SHOW_SPR | MASK_SHOW_BRG)) {
+        // Draw the sprites loaded on the previous scan line and the background
+        if (m_scanLine < 240)
+            this->renderScanlinePixels();
+
+        // Evaluate and load the sprites of the next scan line
+        uint8_t spriteSize = m_ppuCtrl & CTRL_SPRITE_SIZE ? 16 : 8;
+
+        m_primaryOAMpos = 0;
+        m_secondaryOAMpos = 0;
+        m_spritePosition = 0;
+
+        m_spriteEvaCycle = 65;
+        m_spriteZeroNextScanline = false;
+
+        uint8_t* p_secondaryOAM = reinterpret_cast<uint8_t*>(m_secondaryOAM);
+        std::fill(p_secondaryOAM, p_secondaryOAM + sizeof(m_secondaryOAM), 0xFF);
+
+        while (m_spriteEvaCycle <= 256)
+            evaluateSprite(spriteSize);
+
+        loadSprites(spriteSize);
+
+        // Copy address register horizontal components
+        if (m_scanLine < 240) {
+            coarseResetX();
+
+            // Prefetch the first two tiles of the next scan line
+            for (int dot = 321; dot <= 336; dot++) {
+                m_backgroundShiftH <<= 1;
+                m_backgroundShiftL <<= 1;
+                m_attributeShiftH <<= 1;
+                m_attributeShiftL <<= 1;
+
+                if (dot % 8 == 0)
+                    fetchBackgroundTile();
+            }
+        }
+    } else if (m_scanLine < 240 && m_outputEnabled) {
+        // If rendering is disable the background is used to fill the screen
+        uint8_t bgColor = mp_ppuBus->read(0x3F00);
+        for (int x = 0; x < 256; x++)
+            mp_frameBuffer->setPixel(x, m_scanLine, bgColor);
+    }
+
+    // Post rendering scan line
+    if (m_scanLine == 241) {
+        m_vblankStart = true;
+
+        // The frame is complete, the hidden frames are not published
+        if (m_outputEnabled)
+            mp_frameBuffer->swapBuffers();
+
+        if ((m_ppuCtrl & CTRL_VBLANK_NMI) != 0)
+            outputInterrupt = NMI;
+
+        m_ppuStatus |= STATUS_VBLACK;
+    }
+
+    // The odd frame flag is toggled once per dot
+    m_scanLine += 1;
+    m_scanCycle = 0;
+    m_oddFrame = !m_oddFrame;
+
+    return outputInterrupt;
+}
+
+// Draw the 256 pixels of a visible scan line
+inline void PPU::renderScanlinePixels() {
+    // Palette can't change during the line
+    uint8_t palette[32];
+    mp_ppuBus->readPalette(palette);
+
+    // Sprites line buffer, the sprite with the lowest
+    // slot number is drawn on top of the others
+    uint8_t sprPixels[256];
+    uint8_t sprAttributes[256];
+    uint8_t sprNumbers[256];
+    std::fill(sprPixels, sprPixels + 256, 0x00);
+
+    bool showSprites = m_ppuMask & MASK_SHOW_SPR;
+    bool showBackground = m_ppuMask & MASK_SHOW_BRG;
+
+    if (showSprites) {
+        for (int i = 7; i >= 0; i--) {
+            uint8_t attribute = m_spriteAttribute[i];
+
+            // The sprite is shifted out when its x counter reach zero
+            for (int bit = 0; bit < 8 && m_spriteX[i] + bit < 256; bit++) {
+                uint8_t pixel;
+                if (m_spritePixelsValid) {
+                    pixel = m_spritePixels[i][bit];
+                } else {
+                    uint8_t shift = attribute & SPRITE_FLIP_H ? bit : 7 - bit;
+
+                    pixel = (m_spriteShiftL[i] >> shift) & 0x01;
+                    pixel |= ((m_spriteShiftH[i] >> shift) & 0x01) << 1;
+                }
+
+                if (pixel != 0) {
+                    sprPixels[m_spriteX[i] + bit] = pixel;
+                    sprAttributes[m_spriteX[i] + bit] = attribute;
+                    sprNumbers[m_spriteX[i] + bit] = i;
+                }
+            }
+        }
+    }
+
+    // Background line buffer, the pixels are stored with their palette
+    // in bits 2 and 3. The first two tiles come from the shift registers
+    // and the 32 tiles fetched during the line follow
+    uint8_t bgPixels[16 + 256];
+
+    for (int bit = 0; bit < 16; bit++) {
+        uint8_t shift = 15 - bit;
+
+        uint8_t pixel = (m_backgroundShiftL >> shift) & 0x01;
+        pixel |= ((m_backgroundShiftH >> shift) & 0x01) << 1;
+        pixel |= ((m_attributeShiftL >> shift) & 0x01) << 2;
+        pixel |= ((m_attributeShiftH >> shift) & 0x01) << 3;
+
+        bgPixels[bit] = pixel;
+    }
+
+    // The last two tiles are left in the shift registers
+    uint8_t lastLow = 0x00, lastHigh = 0x00, lastAttribute = 0x00;
+
+    for (int tile = 0; tile < 32; tile++) {
+        uint8_t attribute;
+        const ChrTileRow& row = fetchTileRow(attribute);
+
+        uint8_t* p_tilePixels = bgPixels + 16 + tile * 8;
+        for (int x = 0; x < 8; x++)
+            p_tilePixels[x] = row.pixels[x] | (attribute << 2);
+
+        if (tile == 30) {
+            lastHigh = row.high;
+            lastLow = row.low;
+            lastAttribute = attribute;
+        } else if (tile == 31) {
+            m_backgroundShiftH = static_cast<uint16_t>(lastHigh) << 8 | row.high;
+            m_backgroundShiftL = static_cast<uint16_t>(lastLow) << 8 | row.low;
+
+            m_attributeShiftH = (lastAttribute & 0x02 ? 0xFF00 : 0x0000) | (attribute & 0x02 ? 0x00FF : 0x0000);
+            m_attributeShiftL = (lastAttribute & 0x01 ? 0xFF00 : 0x0000) | (attribute & 0x01 ? 0x00FF : 0x0000);
+        }
+    }
+
+    // Without output only the sprite zero hit is left to compute
+    if (!m_outputEnabled && !m_spriteZeroScanline) {
+        coarseIncY();
+        return;
+    }
+
+    for (int dot = 1; dot <= 256; dot++) {
+        uint8_t outputPixel = 0x00;
+        uint8_t outputPaletteAddr = 0x00;
+
+        // If left most rendering is disable don't render the left most tile
+        if ((m_ppuMask & MASK_LEFT_BRG || dot > 8) && showBackground) {
+            uint8_t bgPixel = bgPixels[dot - 1 + m_xFineScrolling];
+
+            outputPixel = bgPixel & 0x03;
+            outputPaletteAddr = bgPixel & 0x0C;
+        }
+
+        // Handle sprite priority and sprite zero hit
+        uint8_t sprPixel = sprPixels[dot - 1];
+        if (sprPixel != 0 && (m_ppuMask & MASK_LEFT_SPR || dot > 8)) {
+            uint8_t sprAttribute = sprAttributes[dot - 1];
+
+            if (m_spriteZeroScanline && sprNumbers[dot - 1] == 0 && outputPixel != 0)
+                m_ppuStatus |= STATUS_SPR_HIT;
+
+            if ((sprAttribute & SPRITE_PRIORITY) == 0 || outputPixel == 0) {
+                outputPixel = sprPixel;
+                outputPaletteAddr = 0x10 | ((sprAttribute & SPRITE_PALETTE) << 2);
+            }
+        }
+
+        if (m_outputEnabled) {
+            uint8_t outputColor = palette[outputPixel ? outputPaletteAddr | outputPixel : 0];
+            mp_frameBuffer->setPixel(dot - 1, m_scanLine, outputColor);
+        }
+    }
+
+    coarseIncY();
+}
+#endif
+
 // PPU processing 
 Interrupt6502 PPU::clock(size_t cpuCycle) {
-    uint16_t ppuCycle = cpuCycle * 3;
+    // Idle loop fast forward can clock a whole frame at once
+    size_t ppuCycle = cpuCycle * 3;
     Interrupt6502 outputInterrupt = NOINT;
 
-    for (uint16_t i = 0; i < ppuCycle; i++) {
+    for (size_t i = 0; i < ppuCycle; i++) {
+#if defined(NES_PPU_SCANLINE_RENDERER)
+        // Execute the whole scan line at once if the CPU can't interact with the PPU
+        // before its end, the pre-rendering line is always executed dot by dot
+        if (m_scanCycle == 0 && m_scanLine < 261 && ppuCycle - i >= 341) {
+            if (renderScanline() == NMI)
+                outputInterrupt = NMI;
+
+            i += 340;
+            continue;
+        }
+#endif
+
         // Pre-rendering scan line
         if (m_scanLine == 261) {
             // Clear flags
@@ -538,7 +932,7 @@ Interrupt6502 PPU::clock(size_t cpuCycle) {
         } else {
             // If rendering is disable the background 
             // is used to fill the screen
-            if (m_scanLine < 240 && m_scanCycle > 0 && m_scanCycle < 257) {
+            if (m_scanLine < 240 && m_scanCycle > 0 && m_scanCycle < 257 && m_outputEnabled) {
                 uint8_t bgColor = mp_ppuBus->read(0x3F00);
                 mp_frameBuffer->setPixel(m_scanCycle - 1, m_scanLine, bgColor);
             }
@@ -548,6 +942,10 @@ Interrupt6502 PPU::clock(size_t cpuCycle) {
         if (m_scanLine == 241 && m_scanCycle == 1) {
             m_vblankStart = true;
 
+            // The frame is complete, the hidden frames are not published
+            if (m_outputEnabled)
+                mp_frameBuffer->swapBuffers();
+
             if ((m_ppuCtrl & CTRL_VBLANK_NMI) != 0)
                 outputInterrupt = NMI;
 
@@ -572,6 +970,66 @@ Interrupt6502 PPU::clock(size_t cpuCycle) {
     return outputInterrupt;
 }
 
+// Add the CPU cycles to the pending cycles and run the PPU at the deadline
+Interrupt6502 PPU::run(size_t cpuCycle) {
+    m_pendingCycles += cpuCycle;
+
+    if (m_pendingCycles >= m_vblankDeadline)
+        return this->catchUp();
+
+    return NOINT;
+}
+
+// Execute the pending cycles
+void PPU::sync() {
+    if (m_pendingCycles != 0)
+        this->catchUp();
+}
+
+// Execute the pending cycles and set the next vblank deadline
+Interrupt6502 PPU::catchUp() {
+    Interrupt6502 interrupt = this->clock(m_pendingCycles);
+
+    m_pendingCycles = 0;
+    m_vblankDeadline = this->cpuCyclesToDot(241, 1);
+
+    return interrupt;
+}
+
+// Return the number of CPU cycles the CPU can run before the vblank
+size_t PPU::cpuCyclesToVblank() {
+    return m_vblankDeadline - m_pendingCycles;
+}
+
+// Return the number of CPU cycles the CPU can run before the status register change
+size_t PPU::cpuCyclesToStatusChange() {
+    // Sprite zero hit and sprite overflow can be set at any dot while rendering
+    if (m_ppuMask & (MASK_SHOW_SPR | MASK_SHOW_BRG))
+        return 0;
+
+    // Otherwise the status only change when the vblank start and end
+    size_t cycles = std::min(this->cpuCyclesToDot(241, 1), this->cpuCyclesToDot(261, 1));
+    return cycles > m_pendingCycles ? cycles - m_pendingCycles : 0;
+}
+
+// Return the number of CPU cycles the CPU can run before the given dot is processed
+size_t PPU::cpuCyclesToDot(int scanLine, int scanCycle) {
+    // PPU dots to execute until the target dot is processed
+    int current = m_scanLine * 341 + m_scanCycle;
+    int dots = (scanLine * 341 + scanCycle) - current + 1;
+    if (dots <= 0)
+        dots += 262 * 341;
+
+    // One dot is skipped on odd frames
+    dots -= 1;
+
+    // An instruction can start only if the previous
+    // ones didn't reach the target dot
+    if (dots <= 0)
+        return 0;
+    return (dots - 1) / 3 + 1;
+}
+
 bool PPU::frameReady() {
     bool vblanck = m_vblankStart;
     m_vblankStart = false;
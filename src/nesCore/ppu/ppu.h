@@ -6,6 +6,7 @@
 #include "ppuDebug.h"
 #include "nesCore/frameBuffer.h"
 #include "nesCore/cpu/cpu6502.h"
+#include "nesCore/cartridge/chrTileCache.h"
 
 namespace nesCore {
 class PpuBus;
@@ -61,11 +62,37 @@ public:
     // Get debug info
     debug::PPUDebug getDebugInfo();
 
+    // Save and restore the registers, the OAM and the rendering state,
+    // the pending cycles are saved without running them
+    void saveState(utility::StateWriter& state);
+    void loadState(utility::StateReader& state);
+
     // Run PPU process
     Interrupt6502 clock(size_t cpuCycle);
 
+    // Catch-up synchronisation
+    //
+    // Add the given CPU cycles to the pending cycles, the PPU is only clocked when
+    // the pending cycles reach the vblank, when the CPU access a PPU register
+    // or a mapper register and when sync is called. Return the NMI raised
+    // by the given cycles, at the same step of a PPU clocked after every instruction
+    Interrupt6502 run(size_t cpuCycle);
+    // Execute the pending cycles, the vblank is never reached by a sync
+    void sync();
+
+    // Return the number of CPU cycles the CPU can run before the PPU is clocked
+    // without missing the start of vertical blank. Instructions started within
+    // this window can't observe the vertical blank NMI
+    size_t cpuCyclesToVblank();
+    // Return the number of CPU cycles the CPU can run before the status register
+    // may change, all the reads of $2002 in this window return the same value
+    size_t cpuCyclesToStatusChange();
+
     // Attach a frame buffer to the PPU
     void attachFrameBuffer(FrameBuffer* buffer);
+    // Enable or disable the writes to the frame buffer, the sprite zero
+    // hit and the other side effects of rendering are still emulated
+    void enableOutput(bool enable);
 
     // Register read and write operation
     uint8_t readRegister(uint16_t addr);
@@ -85,10 +112,33 @@ private:
     inline void spriteEvaluation();
     inline void backgroundEvaluation();
 
+    // Fetch the pattern row and the attribute bits of the next background tile
+    inline const ChrTileRow& fetchTileRow(uint8_t& attribute);
+    inline void fetchBackgroundTile();
+    inline void evaluateSprite(uint8_t spriteSize);
+    inline void loadSprites(uint8_t spriteSize);
+
+#if defined(NES_PPU_SCANLINE_RENDERER)
+    // Scan line renderer, used when a whole line is executed at once
+    inline Interrupt6502 renderScanline();
+    inline void renderScanlinePixels();
+#endif
+
+    // Return the number of CPU cycles the CPU can run before the given dot is processed
+    size_t cpuCyclesToDot(int scanLine, int scanCycle);
+
+    // Execute the pending cycles and set the next vblank deadline
+    Interrupt6502 catchUp();
+
 // Private member variable
 private:
     uint64_t m_ppuCycles;
 
+    // CPU cycles executed by the CPU but not yet by the PPU,
+    // always lower than the vblank deadline
+    size_t m_pendingCycles;
+    size_t m_vblankDeadline;
+
     uint16_t m_scanLine;
     uint16_t m_scanCycle;
 
@@ -100,6 +150,7 @@ private:
 
     // Output frame buffer
     FrameBuffer* mp_frameBuffer;
+    bool m_outputEnabled;
 
     // Rendering and address registers
     bool m_oddFrame;
@@ -131,6 +182,14 @@ private:
     uint8_t m_spriteAttribute[8];
     uint8_t m_spriteX[8];
 
+    // Decoded pixels of the loaded sprites with the horizontal flip applied,
+    // only valid until the dot renderer start shifting the sprite registers
+    uint8_t m_spritePixels[8][8];
+    bool m_spritePixelsValid;
+
+    // Pattern row read from the bus when the cached tiles can't be used
+    ChrTileRow m_busTileRow;
+
     // Set to true if sprite zero is on the current rendered scanline
     bool m_spriteZeroScanline;
     // Used during spite evaluation to determine the value of sprite zero scanline
@@ -3,11 +3,13 @@
 #include "cartridge/cartridge.h"
 #include "ppuBus.h"
 #include "ppu/ppu.h"
+#include "utility/stateBuffer.h"
 
 namespace nesCore {
 PpuBus::PpuBus() : m_ppu(this), mp_cartridge(nullptr) {
     // Initializing RAM to zero
     std::fill(mp_vram, mp_vram + sizeof(mp_vram), 0x00);
+    std::fill(mp_palette, mp_palette + sizeof(mp_palette), 0x00);
 
     // Initialize vram mirroring to horizontal
     this->setMirroringMode(HORIZONTAL_MIRRORING);
@@ -73,12 +75,68 @@ uint8_t PpuBus::read(uint16_t inAddr) {
     return 0x00;
 }
 
+// Row of a tile returned when no cartridge is attached
+static const ChrTileRow s_emptyTileRow = {};
+
+// Read a decoded row of a pattern table tile
+const ChrTileRow& PpuBus::readTileRow(uint16_t addr) {
+    if (mp_cartridge == nullptr)
+        return s_emptyTileRow;
+
+    return mp_cartridge->chrTileRow(addr & 0x1FF7);
+}
+
+// Save the VRAM, the palette, the name table offsets and the PPU
+void PpuBus::saveState(utility::StateWriter& state) {
+    state.writeArray(mp_vram, sizeof(mp_vram));
+    state.writeArray(mp_palette, sizeof(mp_palette));
+
+    uint16_t nametables[4] = {
+        static_cast<uint16_t>(mp_nametableOne - mp_vram),
+        static_cast<uint16_t>(mp_nametableTwo - mp_vram),
+        static_cast<uint16_t>(mp_nametableThree - mp_vram),
+        static_cast<uint16_t>(mp_nametableFour - mp_vram),
+    };
+    state.writeArray(nametables, 4);
+
+    m_ppu.saveState(state);
+}
+// Restore the VRAM, the palette, the name table pointers and the PPU
+void PpuBus::loadState(utility::StateReader& state) {
+    state.readArray(mp_vram, sizeof(mp_vram));
+    state.readArray(mp_palette, sizeof(mp_palette));
+
+    // Offsets out of the VRAM are ignored
+    uint16_t nametables[4];
+    if (state.readArray(nametables, 4)) {
+        for (uint16_t& offset : nametables)
+            offset = offset <= sizeof(mp_vram) - 0x0400 ? offset : 0x0000;
+
+        mp_nametableOne = mp_vram + nametables[0];
+        mp_nametableTwo = mp_vram + nametables[1];
+        mp_nametableThree = mp_vram + nametables[2];
+        mp_nametableFour = mp_vram + nametables[3];
+    }
+
+    m_ppu.loadState(state);
+}
+
+// Read the 32 palette entries
+void PpuBus::readPalette(uint8_t* palette) {
+    for (uint16_t i = 0; i < 32; i++)
+        palette[i] = this->read(0x3F00 + i);
+}
+
 // Write byte to the bus
 void PpuBus::write(uint16_t inAddr, uint8_t data) {
     // Mirrors the 0x0000 to 0x3FFF address range
     uint16_t addr = inAddr % 0x4000;
 
-    if (addr >= 0x2000 && addr <= 0x3EFF) {
+    // Cartridge pattern table address range
+    if (addr >= 0x0000 && addr <= 0x1FFF && mp_cartridge != nullptr) 
+        mp_cartridge->ppuWrite(addr, data);
+
+    else if (addr >= 0x2000 && addr <= 0x3EFF) {
         uint16_t addrVram = (addr - 0x2000) % 0x1000;
 
         if (addrVram >= 0x0000 && addrVram <= 0x03FF)
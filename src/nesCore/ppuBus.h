@@ -10,6 +10,10 @@ class PpuBus {
 public:
     PpuBus();
 
+    // The name table pointers point in the bus VRAM
+    PpuBus(const PpuBus&) = delete;
+    PpuBus& operator=(const PpuBus&) = delete;
+
     // Attach a cartridge to the ppu nus
     void attachCartriadge(Cartridge* cartridge);
 
@@ -18,6 +22,16 @@ public:
     // Write a byte to the PPU bus
     void write(uint16_t addr, uint8_t data);
 
+    // Read the 32 palette entries, with the background color mirrors
+    void readPalette(uint8_t* palette);
+    // Read the decoded row of the tile at the given pattern address
+    const ChrTileRow& readTileRow(uint16_t addr);
+
+    // Save and restore the VRAM, the palette and the PPU,
+    // the name table pointers are stored as VRAM offsets
+    void saveState(utility::StateWriter& state);
+    void loadState(utility::StateReader& state);
+
 private:
     // Set mirroring mode
     void setMirroringMode(MirroringMode mode);
@@ -0,0 +1,323 @@
+#include "nesPch.h"
+
+#include "rewindBuffer.h"
+#include "nesEmulator.h"
+
+#include <cstring>
+
+// Longest run of zero or literal bytes of a compressed token
+#define REWIND_MAX_RUN 0xFFFF
+// A literal run end at this many zero bytes, the size of a token header
+#define REWIND_MIN_ZERO_RUN 4
+
+namespace nesCore {
+RewindBuffer::RewindBuffer(size_t memoryBudget, size_t keyframeInterval) :
+    m_budget(memoryBudget), m_used(0), m_keyframeInterval(keyframeInterval), m_frame(0),
+    m_keyframeNumber(0), m_keyframeValid(false),
+    m_pushedFrames(0), m_pushedBytes(0), m_pushedMicroseconds(0.0)
+{
+    mp_memory = new uint8_t[m_budget];
+
+    if (m_keyframeInterval == 0)
+        m_keyframeInterval = 1;
+}
+RewindBuffer::~RewindBuffer() {
+    delete[] mp_memory;
+}
+
+// Store the state of the emulator
+int RewindBuffer::push(NesEmulator& emulator) {
+    auto startTime = std::chrono::steady_clock::now();
+
+    if (emulator.saveState(m_state) != 0)
+        return 1;
+
+    // The keyframe of the newest frame may have been rewound
+    if (!m_keyframeValid)
+        this->loadNewestKeyframe();
+
+    size_t offset;
+    bool keyframe;
+
+    while (true) {
+        // Deltas continue the group of the newest frame
+        keyframe = !m_keyframeValid || m_records.empty() ||
+            m_records.back().keyframe != m_keyframeNumber ||
+            m_frame - m_keyframeNumber >= m_keyframeInterval ||
+            m_keyframe.size() != m_state.size();
+
+        // Unchanged bytes of a delta become zeros
+        const uint8_t* reference = keyframe ? nullptr : m_keyframe.data();
+        this->encode(m_state.data(), reference, m_state.size(), m_compressed);
+
+        if (m_compressed.size() > m_budget)
+            return 2;
+
+        // A small budget can drop the keyframe of the delta
+        offset = this->allocate(m_compressed.size());
+        if (keyframe || m_keyframeValid)
+            break;
+    }
+
+    std::memcpy(mp_memory + offset, m_compressed.data(), m_compressed.size());
+    m_used += m_compressed.size();
+
+    Record record;
+    record.offset = offset;
+    record.size = m_compressed.size();
+    record.frame = m_frame;
+    record.keyframe = keyframe ? m_frame : m_keyframeNumber;
+    m_records.push_back(record);
+
+    if (keyframe) {
+        m_keyframe = m_state;
+        m_keyframeNumber = m_frame;
+        m_keyframeValid = true;
+    }
+
+    m_frame++;
+
+    // Update the statistics
+    m_pushedFrames++;
+    m_pushedBytes += m_compressed.size();
+    m_pushedMicroseconds += std::chrono::duration<double, std::micro>(
+        std::chrono::steady_clock::now() - startTime
+    ).count();
+
+    return 0;
+}
+
+// Restore the newest state and remove it from the buffer
+int RewindBuffer::rewind(NesEmulator& emulator) {
+    if (m_records.empty())
+        return 1;
+
+    Record record = m_records.back();
+    m_records.pop_back();
+    m_used -= record.size;
+
+    const uint8_t* data = mp_memory + record.offset;
+
+    if (record.frame == record.keyframe) {
+        this->decode(data, record.size, nullptr, m_state);
+
+        // The keyframe is not in the buffer anymore
+        if (m_keyframeNumber == record.frame)
+            m_keyframeValid = false;
+    } else {
+        // The newest remaining record belong to the same group
+        this->loadNewestKeyframe();
+        if (!m_keyframeValid || m_keyframeNumber != record.keyframe)
+            return 2;
+
+        this->decode(data, record.size, &m_keyframe, m_state);
+    }
+
+    // The next pushed frame replace the rewound one
+    m_frame = record.frame;
+
+    return emulator.loadState(m_state) == 0 ? 0 : 2;
+}
+
+// Drop all the states
+void RewindBuffer::clear() {
+    m_records.clear();
+    m_used = 0;
+    m_keyframeValid = false;
+}
+
+// Decode the keyframe of the newest frame
+void RewindBuffer::loadNewestKeyframe() {
+    if (m_records.empty()) {
+        m_keyframeValid = false;
+        return;
+    }
+
+    uint64_t keyframe = m_records.back().keyframe;
+    if (m_keyframeValid && m_keyframeNumber == keyframe)
+        return;
+
+    // The keyframe is the first record of the newest group
+    for (auto record = m_records.rbegin(); record != m_records.rend(); record++) {
+        if (record->frame == keyframe) {
+            this->decode(mp_memory + record->offset, record->size, nullptr, m_keyframe);
+            m_keyframeNumber = keyframe;
+            m_keyframeValid = true;
+            return;
+        }
+    }
+
+    m_keyframeValid = false;
+}
+
+// Return the offset where a record of the given size can be written
+size_t RewindBuffer::allocate(size_t size) {
+    while (!m_records.empty()) {
+        const Record& oldest = m_records.front();
+        const Record& newest = m_records.back();
+        size_t end = newest.offset + newest.size;
+
+        if (newest.offset >= oldest.offset) {
+            // After the newest record or at the start of the ring
+            if (m_budget - end >= size)
+                return end;
+            if (oldest.offset >= size)
+                return 0;
+        } else if (oldest.offset - end >= size) {
+            // Between the newest and the oldest record
+            return end;
+        }
+
+        this->dropOldestKeyframe();
+    }
+
+    return 0;
+}
+
+// Drop the oldest keyframe and its deltas
+void RewindBuffer::dropOldestKeyframe() {
+    uint64_t keyframe = m_records.front().keyframe;
+
+    while (!m_records.empty() && m_records.front().keyframe == keyframe) {
+        m_used -= m_records.front().size;
+        m_records.pop_front();
+    }
+
+    if (m_keyframeNumber == keyframe)
+        m_keyframeValid = false;
+}
+
+/*
+ *
+ *  Compression
+ *
+ *  A record is a list of tokens, each one made of the number of zero bytes
+ *  to skip and the number of literal bytes that follow, both on 16 bits.
+ *  Deltas are XORed with their keyframe while being compressed
+ *
+ */
+
+// Compress the data XORed with the reference
+void RewindBuffer::encode(const uint8_t* data, const uint8_t* reference, size_t size, std::vector<uint8_t>& out) {
+    out.clear();
+
+    auto byteAt = [&](size_t i) -> uint8_t {
+        return reference != nullptr ? data[i] ^ reference[i] : data[i];
+    };
+    auto wordAt = [&](size_t i) -> uint64_t {
+        uint64_t word, referenceWord = 0;
+        std::memcpy(&word, data + i, 8);
+        if (reference != nullptr)
+            std::memcpy(&referenceWord, reference + i, 8);
+
+        return word ^ referenceWord;
+    };
+
+    // Return true if a run of zeros worth a new token start at the given byte
+    auto zeroRun = [&](size_t i) -> bool {
+        if (i + REWIND_MIN_ZERO_RUN > size)
+            return false;
+
+        for (size_t j = i; j < i + REWIND_MIN_ZERO_RUN; j++) {
+            if (byteAt(j) != 0)
+                return false;
+        }
+        return true;
+    };
+
+    size_t i = 0;
+    while (i < size) {
+        // Skip the zeros a word at a time, most of a delta is zero
+        size_t zerosStart = i;
+        while (i + 8 <= size && i - zerosStart + 8 <= REWIND_MAX_RUN && wordAt(i) == 0)
+            i += 8;
+        while (i < size && i - zerosStart < REWIND_MAX_RUN && byteAt(i) == 0)
+            i++;
+
+        // Literals continue up to a run of zeros
+        size_t literalStart = i;
+        while (i < size && i - literalStart < REWIND_MAX_RUN && (byteAt(i) != 0 || !zeroRun(i)))
+            i++;
+
+        uint16_t zeros = static_cast<uint16_t>(literalStart - zerosStart);
+        uint16_t literals = static_cast<uint16_t>(i - literalStart);
+
+        size_t position = out.size();
+        out.resize(position + 4 + literals);
+
+        uint8_t* p_out = out.data() + position;
+        std::memcpy(p_out, &zeros, 2);
+        std::memcpy(p_out + 2, &literals, 2);
+
+        for (size_t j = literalStart; j < i; j++)
+            p_out[4 + j - literalStart] = byteAt(j);
+    }
+}
+
+// Decompress a record XORed with the reference
+void RewindBuffer::decode(
+    const uint8_t* record, size_t recordSize,
+    const std::vector<uint8_t>* reference,
+    std::vector<uint8_t>& out
+) {
+    if (reference != nullptr)
+        out = *reference;
+    else
+        out.clear();
+
+    size_t position = 0;
+    size_t i = 0;
+
+    while (i + 4 <= recordSize) {
+        uint16_t zeros, literals;
+        std::memcpy(&zeros, record + i, 2);
+        std::memcpy(&literals, record + i + 2, 2);
+        i += 4;
+
+        position += zeros;
+        if (out.size() < position + literals)
+            out.resize(position + literals, 0x00);
+
+        for (uint16_t j = 0; j < literals && i < recordSize; j++)
+            out[position++] ^= record[i++];
+    }
+
+    // Trailing zero bytes of a keyframe
+    if (out.size() < position)
+        out.resize(position, 0x00);
+}
+
+/*
+ *
+ *  Statistics
+ *
+ */
+
+size_t RewindBuffer::frames() {
+    return m_records.size();
+}
+size_t RewindBuffer::memoryUsed() {
+    return m_used;
+}
+size_t RewindBuffer::memoryBudget() {
+    return m_budget;
+}
+double RewindBuffer::averageFrameBytes() {
+    return m_pushedFrames != 0 ? static_cast<double>(m_pushedBytes) / m_pushedFrames : 0.0;
+}
+double RewindBuffer::averageFrameMicroseconds() {
+    return m_pushedFrames != 0 ? m_pushedMicroseconds / m_pushedFrames : 0.0;
+}
+
+// Return a string with the statistics
+std::string RewindBuffer::formatStats() {
+    std::stringstream s;
+
+    s << "Rewind: " << this->frames() << " frames in ";
+    s << m_used / 1024 << " KB of " << m_budget / 1024 << " KB, ";
+    s << std::fixed << std::setprecision(0) << this->averageFrameBytes() << " bytes and ";
+    s << std::setprecision(1) << this->averageFrameMicroseconds() << " us per frame";
+
+    return s.str();
+}
+}
@@ -0,0 +1,121 @@
+#ifndef REWIND_BUFFER_H_
+#define REWIND_BUFFER_H_
+
+#include "nesPch.h"
+
+#include <deque>
+#include <vector>
+
+// Default number of frames between two keyframes
+#define REWIND_KEYFRAME_INTERVAL 60
+
+namespace nesCore {
+class NesEmulator;
+
+// Ring of per-frame save states in a fixed memory budget
+//
+// Every keyframe interval a whole state is stored, the other frames
+// are stored as the XOR of their state with the last keyframe. Both
+// are compressed with a run-length encoding of the zero bytes, so an
+// unchanged byte of a delta cost almost nothing. When the budget is full
+// the oldest keyframe is dropped with all the deltas depending on it
+class RewindBuffer {
+public:
+    // Take the memory budget in bytes and the frames between keyframes
+    RewindBuffer(size_t memoryBudget, size_t keyframeInterval = REWIND_KEYFRAME_INTERVAL);
+    ~RewindBuffer();
+
+    // The buffer own the record memory
+    RewindBuffer(const RewindBuffer&) = delete;
+    RewindBuffer& operator=(const RewindBuffer&) = delete;
+
+    // Store the state of the emulator, should be called once per frame
+    // Return 0 on success, 1 if the state can't be saved
+    // and 2 if the compressed state doesn't fit in the budget
+    int push(NesEmulator& emulator);
+    // Restore the newest state and remove it from the buffer
+    // Return 0 on success, 1 if the buffer is empty
+    // and 2 if the state can't be loaded
+    int rewind(NesEmulator& emulator);
+
+    // Drop all the states
+    void clear();
+
+    // Statistics
+    //
+    // Number of frames that can be rewound
+    size_t frames();
+    // Memory used by the stored frames and the budget in bytes
+    size_t memoryUsed();
+    size_t memoryBudget();
+    // Average compressed size and compression time of the pushed frames
+    double averageFrameBytes();
+    double averageFrameMicroseconds();
+
+    // Return a string with the statistics
+    std::string formatStats();
+
+// Private methods
+private:
+    // Compress the data XORed with the reference of the same size,
+    // or the data alone if the reference is nullptr
+    static void encode(const uint8_t* data, const uint8_t* reference, size_t size, std::vector<uint8_t>& out);
+    // Decompress a record in out, XORed with the reference if not nullptr
+    static void decode(
+        const uint8_t* record, size_t recordSize,
+        const std::vector<uint8_t>* reference,
+        std::vector<uint8_t>& out
+    );
+
+    // Return the offset where a record of the given size can be written,
+    // dropping the oldest keyframes until it fits
+    size_t allocate(size_t size);
+    // Drop the oldest keyframe and its deltas
+    void dropOldestKeyframe();
+
+    // Decode the keyframe of the newest frame in the keyframe buffer
+    void loadNewestKeyframe();
+
+// Private types
+private:
+    struct Record {
+        // Position and size of the compressed state in the ring
+        size_t offset;
+        size_t size;
+
+        // Frame number and number of the keyframe the record depend on
+        uint64_t frame;
+        uint64_t keyframe;
+    };
+
+// Private member variables
+private:
+    // Compressed records ring, the records are stored contiguously
+    // and the end of the ring is skipped when a record doesn't fit
+    uint8_t* mp_memory;
+    size_t m_budget;
+    size_t m_used;
+
+    std::deque<Record> m_records;
+
+    size_t m_keyframeInterval;
+    uint64_t m_frame;
+
+    // Decoded keyframe used by the deltas, its frame number
+    // and if it's the keyframe of the newest record
+    std::vector<uint8_t> m_keyframe;
+    uint64_t m_keyframeNumber;
+    bool m_keyframeValid;
+
+    // Scratch buffers reused for every frame
+    std::vector<uint8_t> m_state;
+    std::vector<uint8_t> m_compressed;
+
+    // Statistics
+    uint64_t m_pushedFrames;
+    uint64_t m_pushedBytes;
+    double m_pushedMicroseconds;
+};
+}
+
+#endif
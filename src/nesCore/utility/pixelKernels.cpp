@@ -0,0 +1,314 @@
+#include "nesPch.h"
+
+#include <cstring>
+
+#include "pixelKernels.h"
+
+// The SIMD variants are compiled for their instruction set with the target
+// attribute and only called when CPUID report it, the rest of the build
+// keeps the baseline instruction set
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define PIXEL_KERNELS_X86
+#include <immintrin.h>
+#endif
+
+namespace nesCore {
+namespace utility {
+
+// Fill the palette in the byte order of the format, the alpha is opaque
+void buildPixelPalette(const uint8_t* colors, PixelFormat format, uint32_t* palette) {
+    for (int i = 0; i < 64; i++) {
+        uint8_t* pixel = reinterpret_cast<uint8_t*>(&palette[i]);
+
+        pixel[0] = colors[(i*3) + (format == PIXEL_BGRA32 ? 2 : 0)];
+        pixel[1] = colors[(i*3) + 1];
+        pixel[2] = colors[(i*3) + (format == PIXEL_BGRA32 ? 0 : 2)];
+        pixel[3] = 0xFF;
+    }
+}
+
+// Copy the first output row of a scaled input row factor - 1 times
+static void replicateRow(uint32_t* row, size_t outputWidth, int factor) {
+    for (int i = 1; i < factor; i++)
+        std::memcpy(row + outputWidth * i, row, outputWidth * sizeof(uint32_t));
+}
+
+/*
+ *
+ *  Scalar reference
+ *
+ */
+
+static void indexToRgb24Scalar(const uint8_t* indices, size_t count, const uint32_t* palette, uint8_t* output) {
+    for (size_t i = 0; i < count; i++) {
+        const uint8_t* color = reinterpret_cast<const uint8_t*>(&palette[indices[i]]);
+
+        output[i * 3]     = color[0];
+        output[i * 3 + 1] = color[1];
+        output[i * 3 + 2] = color[2];
+    }
+}
+
+static void indexToPixel32Scalar(const uint8_t* indices, size_t count, const uint32_t* palette, uint32_t* output) {
+    for (size_t i = 0; i < count; i++)
+        output[i] = palette[indices[i]];
+}
+
+// Scale the pixels from the given column of a row
+static void scaleRowScalar(const uint32_t* input, size_t from, size_t width, int factor, uint32_t* output) {
+    for (size_t x = from; x < width; x++) {
+        for (int i = 0; i < factor; i++)
+            output[x * factor + i] = input[x];
+    }
+}
+
+static void scale32Scalar(const uint32_t* input, size_t width, size_t height, int factor, uint32_t* output) {
+    size_t outputWidth = width * factor;
+
+    for (size_t y = 0; y < height; y++) {
+        uint32_t* row = output + y * outputWidth * factor;
+
+        scaleRowScalar(input + y * width, 0, width, factor, row);
+        replicateRow(row, outputWidth, factor);
+    }
+}
+
+#ifdef PIXEL_KERNELS_X86
+
+/*
+ *
+ *  SSE2
+ *
+ */
+
+// Look up 4 pixels, SSE2 can't shuffle bytes so the lookup stays scalar
+__attribute__((target("sse2")))
+static inline __m128i lookupPixelsSse2(const uint8_t* indices, const uint32_t* palette) {
+    return _mm_setr_epi32(
+        palette[indices[0]], palette[indices[1]],
+        palette[indices[2]], palette[indices[3]]
+    );
+}
+
+// Pack the RGB bytes of 4 pixels in 12 bytes, each store
+// write 2 bytes past the group that the next group overwrite
+__attribute__((target("sse2")))
+static void indexToRgb24Sse2(const uint8_t* indices, size_t count, const uint32_t* palette, uint8_t* output) {
+    const __m128i lowMask = _mm_set1_epi64x(0x0000000000FFFFFF);
+    const __m128i highMask = _mm_set1_epi64x(0x0000FFFFFF000000);
+
+    size_t i = 0;
+    for (; i + 5 <= count; i += 4) {
+        __m128i pixels = lookupPixelsSse2(indices + i, palette);
+
+        // Each 64 bits lane hold the 6 bytes of its 2 pixels
+        __m128i packed = _mm_or_si128(
+            _mm_and_si128(pixels, lowMask),
+            _mm_and_si128(_mm_srli_epi64(pixels, 8), highMask)
+        );
+
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(output + i * 3), packed);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(output + i * 3 + 6), _mm_srli_si128(packed, 8));
+    }
+
+    indexToRgb24Scalar(indices + i, count - i, palette, output + i * 3);
+}
+
+__attribute__((target("sse2")))
+static void indexToPixel32Sse2(const uint8_t* indices, size_t count, const uint32_t* palette, uint32_t* output) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(output + i), lookupPixelsSse2(indices + i, palette));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(output + i + 4), lookupPixelsSse2(indices + i + 4, palette));
+    }
+
+    indexToPixel32Scalar(indices + i, count - i, palette, output + i);
+}
+
+// Repeat each pixel of a group of 4 with 32 bits shuffles
+__attribute__((target("sse2")))
+static void scale32Sse2(const uint32_t* input, size_t width, size_t height, int factor, uint32_t* output) {
+    if (factor < 2 || factor > 4) {
+        scale32Scalar(input, width, height, factor, output);
+        return;
+    }
+
+    size_t outputWidth = width * factor;
+
+    for (size_t y = 0; y < height; y++) {
+        const uint32_t* inputRow = input + y * width;
+        uint32_t* row = output + y * outputWidth * factor;
+        __m128i* out = reinterpret_cast<__m128i*>(row);
+
+        size_t x = 0;
+        for (; x + 4 <= width; x += 4) {
+            __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(inputRow + x));
+
+            if (factor == 2) {
+                _mm_storeu_si128(out++, _mm_unpacklo_epi32(pixels, pixels));
+                _mm_storeu_si128(out++, _mm_unpackhi_epi32(pixels, pixels));
+            } else if (factor == 3) {
+                _mm_storeu_si128(out++, _mm_shuffle_epi32(pixels, _MM_SHUFFLE(1, 0, 0, 0)));
+                _mm_storeu_si128(out++, _mm_shuffle_epi32(pixels, _MM_SHUFFLE(2, 2, 1, 1)));
+                _mm_storeu_si128(out++, _mm_shuffle_epi32(pixels, _MM_SHUFFLE(3, 3, 3, 2)));
+            } else {
+                _mm_storeu_si128(out++, _mm_shuffle_epi32(pixels, _MM_SHUFFLE(0, 0, 0, 0)));
+                _mm_storeu_si128(out++, _mm_shuffle_epi32(pixels, _MM_SHUFFLE(1, 1, 1, 1)));
+                _mm_storeu_si128(out++, _mm_shuffle_epi32(pixels, _MM_SHUFFLE(2, 2, 2, 2)));
+                _mm_storeu_si128(out++, _mm_shuffle_epi32(pixels, _MM_SHUFFLE(3, 3, 3, 3)));
+            }
+        }
+
+        scaleRowScalar(inputRow, x, width, factor, row);
+        replicateRow(row, outputWidth, factor);
+    }
+}
+
+/*
+ *
+ *  AVX2
+ *
+ */
+
+// Look up 16 indices with two gathers of 8 pixels, the gathers
+// are faster than byte shuffles on the 4 byte planes of the palette
+__attribute__((target("avx2")))
+static inline void lookupPixelsAvx2(const uint8_t* indices, const uint32_t* palette, __m256i* pixels) {
+    __m128i index = _mm_loadu_si128(reinterpret_cast<const __m128i*>(indices));
+    const int* table = reinterpret_cast<const int*>(palette);
+
+    pixels[0] = _mm256_i32gather_epi32(table, _mm256_cvtepu8_epi32(index), 4);
+    pixels[1] = _mm256_i32gather_epi32(table, _mm256_cvtepu8_epi32(_mm_srli_si128(index, 8)), 4);
+}
+
+// Drop the alpha bytes of each lane and store the 12 bytes of its 4 pixels,
+// each store write 4 bytes past its pixels that the next store overwrite
+__attribute__((target("avx2")))
+static void indexToRgb24Avx2(const uint8_t* indices, size_t count, const uint32_t* palette, uint8_t* output) {
+    const __m256i packMask = _mm256_setr_epi8(
+        0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1,
+        0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1
+    );
+
+    size_t i = 0;
+    for (; i + 18 <= count; i += 16) {
+        __m256i pixels[2];
+        lookupPixelsAvx2(indices + i, palette, pixels);
+
+        uint8_t* out = output + i * 3;
+        for (int vector = 0; vector < 2; vector++) {
+            __m256i packed = _mm256_shuffle_epi8(pixels[vector], packMask);
+
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm256_castsi256_si128(packed));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 12), _mm256_extracti128_si256(packed, 1));
+            out += 24;
+        }
+    }
+
+    indexToRgb24Scalar(indices + i, count - i, palette, output + i * 3);
+}
+
+__attribute__((target("avx2")))
+static void indexToPixel32Avx2(const uint8_t* indices, size_t count, const uint32_t* palette, uint32_t* output) {
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m256i pixels[2];
+        lookupPixelsAvx2(indices + i, palette, pixels);
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(output + i), pixels[0]);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(output + i + 8), pixels[1]);
+    }
+
+    indexToPixel32Scalar(indices + i, count - i, palette, output + i);
+}
+
+// Repeat each pixel of a group of 8 with cross lane permutes,
+// the output vector n take the input pixels (n * 8 + lane) / factor
+__attribute__((target("avx2")))
+static void scale32Avx2(const uint32_t* input, size_t width, size_t height, int factor, uint32_t* output) {
+    if (factor < 2 || factor > 4) {
+        scale32Scalar(input, width, height, factor, output);
+        return;
+    }
+
+    __m256i permutes[4];
+    for (int vector = 0; vector < factor; vector++) {
+        alignas(32) int32_t lanes[8];
+        for (int lane = 0; lane < 8; lane++)
+            lanes[lane] = (vector * 8 + lane) / factor;
+
+        permutes[vector] = _mm256_load_si256(reinterpret_cast<const __m256i*>(lanes));
+    }
+
+    size_t outputWidth = width * factor;
+
+    for (size_t y = 0; y < height; y++) {
+        const uint32_t* inputRow = input + y * width;
+        uint32_t* row = output + y * outputWidth * factor;
+        __m256i* out = reinterpret_cast<__m256i*>(row);
+
+        size_t x = 0;
+        for (; x + 8 <= width; x += 8) {
+            __m256i pixels = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(inputRow + x));
+
+            for (int vector = 0; vector < factor; vector++)
+                _mm256_storeu_si256(out++, _mm256_permutevar8x32_epi32(pixels, permutes[vector]));
+        }
+
+        scaleRowScalar(inputRow, x, width, factor, row);
+        replicateRow(row, outputWidth, factor);
+    }
+}
+
+#endif
+
+/*
+ *
+ *  Dispatch
+ *
+ */
+
+static const PixelKernels SCALAR_KERNELS = {
+    SIMD_SCALAR, "scalar", indexToRgb24Scalar, indexToPixel32Scalar, scale32Scalar
+};
+
+#ifdef PIXEL_KERNELS_X86
+static const PixelKernels SSE2_KERNELS = {
+    SIMD_SSE2, "sse2", indexToRgb24Sse2, indexToPixel32Sse2, scale32Sse2
+};
+static const PixelKernels AVX2_KERNELS = {
+    SIMD_AVX2, "avx2", indexToRgb24Avx2, indexToPixel32Avx2, scale32Avx2
+};
+#endif
+
+// Return the kernels if the CPU support their instruction set
+const PixelKernels* pixelKernels(SimdLevel level) {
+#ifdef PIXEL_KERNELS_X86
+    __builtin_cpu_init();
+
+    if (level == SIMD_SSE2 && __builtin_cpu_supports("sse2"))
+        return &SSE2_KERNELS;
+    if (level == SIMD_AVX2 && __builtin_cpu_supports("avx2"))
+        return &AVX2_KERNELS;
+#endif
+
+    return level == SIMD_SCALAR ? &SCALAR_KERNELS : nullptr;
+}
+
+// Select the fastest kernels once, the static initialization is thread safe
+const PixelKernels& pixelKernels() {
+    static const PixelKernels* p_kernels = []() {
+        for (int level = SIMD_AVX2; level > SIMD_SCALAR; level--) {
+            const PixelKernels* p_supported = pixelKernels(static_cast<SimdLevel>(level));
+            if (p_supported != nullptr)
+                return p_supported;
+        }
+
+        return &SCALAR_KERNELS;
+    }();
+
+    return *p_kernels;
+}
+
+} // utility
+} // nesCore
@@ -0,0 +1,53 @@
+#ifndef PIXEL_KERNELS_H_
+#define PIXEL_KERNELS_H_
+
+#include "nesPch.h"
+
+namespace nesCore {
+namespace utility {
+
+// Instruction sets of the pixel kernels, from the slowest to the fastest
+enum SimdLevel {
+    SIMD_SCALAR = 0,
+    SIMD_SSE2 = 1,
+    SIMD_AVX2 = 2,
+};
+
+// Byte order in memory of the 32 bits host pixels
+enum PixelFormat {
+    PIXEL_RGBA32 = 0,
+    PIXEL_BGRA32 = 1,
+};
+
+// Conversion of NES palette indices to host pixels and integer scaling
+//
+// The palettes hold the 64 colors already in the byte order of the output,
+// the RGB24 conversion use a RGBA32 palette and drop the alpha byte. The
+// indices must be lower than 64. Every variant produce exactly the output
+// of the scalar one, the SSE2 32 bits conversion only vectorise the stores
+// as SSE2 has no byte shuffle to do the table lookup
+struct PixelKernels {
+    SimdLevel level;
+    const char* name;
+
+    // Convert count indices to RGB bytes, 3 bytes per pixel
+    void (*indexToRgb24)(const uint8_t* indices, size_t count, const uint32_t* palette, uint8_t* output);
+    // Convert count indices to 32 bits pixels in the byte order of the palette
+    void (*indexToPixel32)(const uint8_t* indices, size_t count, const uint32_t* palette, uint32_t* output);
+    // Scale an image of 32 bits pixels by an integer factor with the nearest pixel,
+    // the output is width * factor by height * factor. The factors 2 to 4 are vectorised
+    void (*scale32)(const uint32_t* input, size_t width, size_t height, int factor, uint32_t* output);
+};
+
+// Fill a palette of 64 pixels in the given format from the 192 bytes of a palette file
+void buildPixelPalette(const uint8_t* colors, PixelFormat format, uint32_t* palette);
+
+// Kernels of the fastest instruction set of the host, selected from CPUID on the first call
+const PixelKernels& pixelKernels();
+// Kernels of the given instruction set, nullptr if the host or the build doesn't support it
+const PixelKernels* pixelKernels(SimdLevel level);
+
+} // utility
+} // nesCore
+
+#endif
@@ -0,0 +1,108 @@
+#ifndef SPSC_RING_BUFFER_H_
+#define SPSC_RING_BUFFER_H_
+
+#include "nesPch.h"
+
+#include <atomic>
+
+namespace nesCore {
+namespace utility {
+
+// Lock-free single producer single consumer ring buffer
+//
+// One thread write and another one read, without locks and without
+// allocations after the construction. The indices only grow and are
+// wrapped by the power of two capacity, each one is written by one side
+// and read by the other with acquire and release ordering
+template <typename T>
+class SpscRingBuffer {
+public:
+    // The capacity is rounded up to a power of two
+    explicit SpscRingBuffer(size_t capacity) :
+        m_writeIndex(0), m_readIndex(0), m_overruns(0), m_underruns(0)
+    {
+        size_t size = 1;
+        while (size < capacity)
+            size <<= 1;
+
+        mp_data = new T[size];
+        m_mask = size - 1;
+    }
+    ~SpscRingBuffer() {
+        delete[] mp_data;
+    }
+
+    // The buffer own the data memory
+    SpscRingBuffer(const SpscRingBuffer&) = delete;
+    SpscRingBuffer& operator=(const SpscRingBuffer&) = delete;
+
+    static_assert(std::atomic<size_t>::is_always_lock_free, "SPSC ring buffer indices must be lock free");
+
+    // Return the number of elements the buffer can hold
+    size_t capacity() { return m_mask + 1; }
+    // Return the number of elements in the buffer, exact only for the two sides
+    size_t size() {
+        return m_writeIndex.load(std::memory_order_acquire) - m_readIndex.load(std::memory_order_acquire);
+    }
+
+    // Producer side, write up to count elements and return the number written,
+    // an overrun is counted if some of them didn't fit
+    size_t write(const T* data, size_t count) {
+        size_t write = m_writeIndex.load(std::memory_order_relaxed);
+        size_t read = m_readIndex.load(std::memory_order_acquire);
+
+        size_t written = std::min(count, this->capacity() - (write - read));
+        // Copy up to the end of the memory and then from the beginning
+        size_t start = write & m_mask;
+        size_t first = std::min(written, this->capacity() - start);
+        std::copy(data, data + first, mp_data + start);
+        std::copy(data + first, data + written, mp_data);
+
+        m_writeIndex.store(write + written, std::memory_order_release);
+
+        if (written < count)
+            m_overruns.fetch_add(1, std::memory_order_relaxed);
+
+        return written;
+    }
+
+    // Consumer side, read up to count elements and return the number read,
+    // an underrun is counted if there weren't enough of them
+    size_t read(T* out, size_t count) {
+        size_t read = m_readIndex.load(std::memory_order_relaxed);
+        size_t write = m_writeIndex.load(std::memory_order_acquire);
+
+        size_t available = std::min(count, write - read);
+        size_t start = read & m_mask;
+        size_t first = std::min(available, this->capacity() - start);
+        std::copy(mp_data + start, mp_data + start + first, out);
+        std::copy(mp_data, mp_data + (available - first), out + first);
+
+        m_readIndex.store(read + available, std::memory_order_release);
+
+        if (available < count)
+            m_underruns.fetch_add(1, std::memory_order_relaxed);
+
+        return available;
+    }
+
+    // Statistics
+    uint64_t overruns() { return m_overruns.load(std::memory_order_relaxed); }
+    uint64_t underruns() { return m_underruns.load(std::memory_order_relaxed); }
+
+private:
+    T* mp_data;
+    size_t m_mask;
+
+    // Each index is on its own cache line to avoid false sharing
+    alignas(64) std::atomic<size_t> m_writeIndex;
+    alignas(64) std::atomic<size_t> m_readIndex;
+
+    alignas(64) std::atomic<uint64_t> m_overruns;
+    std::atomic<uint64_t> m_underruns;
+};
+
+} // utility
+} // nesCore
+
+#endif
@@ -0,0 +1,97 @@
+#ifndef STATE_BUFFER_H_
+#define STATE_BUFFER_H_
+
+#include "nesPch.h"
+
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+namespace nesCore {
+namespace utility {
+
+// Append the raw bytes of the emulator components to a save state
+//
+// The values are copied in bulk with their host layout, a state can only be
+// loaded by the same build of the emulator. The buffer is cleared but keep its
+// capacity, so saving again in the same buffer doesn't allocate
+class StateWriter {
+public:
+    explicit StateWriter(std::vector<uint8_t>& buffer) : m_buffer(buffer) {
+        m_buffer.clear();
+    }
+
+    // Write a plain value or an array of plain values
+    template <typename T>
+    void write(const T& value) {
+        this->writeArray(&value, 1);
+    }
+
+    template <typename T>
+    void writeArray(const T* values, size_t count) {
+        static_assert(std::is_trivially_copyable<T>::value, "Only plain values can be saved");
+
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(values);
+        m_buffer.insert(m_buffer.end(), bytes, bytes + sizeof(T) * count);
+    }
+
+    // Number of bytes written so far
+    size_t size() { return m_buffer.size(); }
+
+    // Overwrite a value already written at the given position
+    template <typename T>
+    void patch(size_t position, const T& value) {
+        std::memcpy(m_buffer.data() + position, &value, sizeof(T));
+    }
+
+private:
+    std::vector<uint8_t>& m_buffer;
+};
+
+// Read back the values written by the state writer, in the same order
+//
+// A read past the end of the state leave the value unchanged and set the
+// failed flag, the following reads also fail
+class StateReader {
+public:
+    StateReader(const uint8_t* data, size_t size) :
+        mp_data(data), m_size(size), m_position(0), m_failed(false) {};
+
+    // Read a plain value or an array of plain values, return false on failure
+    template <typename T>
+    bool read(T& value) {
+        return this->readArray(&value, 1);
+    }
+
+    template <typename T>
+    bool readArray(T* values, size_t count) {
+        static_assert(std::is_trivially_copyable<T>::value, "Only plain values can be loaded");
+
+        size_t bytes = sizeof(T) * count;
+        if (m_failed || bytes > m_size - m_position) {
+            m_failed = true;
+            return false;
+        }
+
+        std::memcpy(values, mp_data + m_position, bytes);
+        m_position += bytes;
+
+        return true;
+    }
+
+    // Return true if a read went past the end of the state
+    bool failed() { return m_failed; }
+    // Number of bytes left to read
+    size_t remaining() { return m_size - m_position; }
+
+private:
+    const uint8_t* mp_data;
+    size_t m_size;
+    size_t m_position;
+
+    bool m_failed;
+};
+}
+}
+
+#endif
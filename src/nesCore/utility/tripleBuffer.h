@@ -0,0 +1,73 @@
+#ifndef TRIPLE_BUFFER_H_
+#define TRIPLE_BUFFER_H_
+
+#include "nesPch.h"
+
+#include <atomic>
+
+namespace nesCore {
+namespace utility {
+
+// Lock-free triple buffer
+//
+// The producer fill the back buffer and publish it, the consumer take the
+// latest published buffer as its front buffer. The third buffer sits between
+// them, publishing and taking are a single atomic exchange of its index, so
+// neither side ever wait and the producer can publish faster than the
+// consumer take, the skipped buffers are overwritten
+template <typename T>
+class TripleBuffer {
+public:
+    TripleBuffer() : m_buffers(), m_back(0), m_published(1), m_middle(1), m_front(2) {}
+
+    // The buffers are shared by the two threads
+    TripleBuffer(const TripleBuffer&) = delete;
+    TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+    static_assert(std::atomic<uint8_t>::is_always_lock_free, "Triple buffer index must be lock free");
+
+    // Producer side, return the buffer being filled
+    T& back() { return m_buffers[m_back]; }
+    // Producer side, return the last published buffer, it is
+    // only read by the consumer until the next publish
+    const T& published() { return m_buffers[m_published]; }
+    // Producer side, make the back buffer the latest one and
+    // continue with the buffer not used by the consumer
+    void publish() {
+        m_published = m_back;
+        uint8_t previous = m_middle.exchange(m_back | FRESH_BIT, std::memory_order_acq_rel);
+        m_back = previous & INDEX_MASK;
+    }
+
+    // Consumer side, take the latest published buffer as the front buffer
+    // Return false if nothing was published since the last update
+    bool update() {
+        if ((m_middle.load(std::memory_order_relaxed) & FRESH_BIT) == 0)
+            return false;
+
+        uint8_t previous = m_middle.exchange(m_front, std::memory_order_acq_rel);
+        m_front = previous & INDEX_MASK;
+
+        return true;
+    }
+    // Consumer side, return the buffer taken by the last update
+    const T& front() { return m_buffers[m_front]; }
+
+private:
+    // The middle index is marked fresh when published and not yet taken
+    static const uint8_t INDEX_MASK = 0x03;
+    static const uint8_t FRESH_BIT = 0x04;
+
+    T m_buffers[3];
+
+    // Each side own an index, the middle one is exchanged
+    uint8_t m_back;
+    uint8_t m_published;
+    alignas(64) std::atomic<uint8_t> m_middle;
+    alignas(64) uint8_t m_front;
+};
+
+} // utility
+} // nesCore
+
+#endif
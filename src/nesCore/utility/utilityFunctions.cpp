@@ -1,5 +1,9 @@
 #include "nesPch.h"
 
+#include "utilityFunctions.h"
+#include "nesCore/nesEmulator.h"
+#include "nesCore/frameBuffer.h"
+
 namespace nesCore {
 namespace utility {
 
@@ -13,5 +17,50 @@ std::string paddedHex(int data, int nPadding) {
     return s.str();
 }
 
+// 64 bits FNV-1a hash of a block of bytes
+uint64_t hashBytes(const uint8_t* data, size_t size, uint64_t hash) {
+    for (size_t i = 0; i < size; i++) {
+        hash ^= data[i];
+        hash *= 0x100000001B3;
+    }
+
+    return hash;
+}
+
+// Read a whole file, return false if it can't be opened
+bool readFile(const std::string& filename, std::vector<uint8_t>& data) {
+    std::ifstream file(filename, std::ios_base::binary);
+    if (!file.good())
+        return false;
+
+    data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return true;
+}
+
+// Write the frame buffer as a binary PPM image
+bool writePpm(const std::string& filename, FrameBuffer* frameBuffer) {
+    std::ofstream file(filename, std::ios_base::binary);
+    if (!file.good())
+        return false;
+
+    file << "P6\n" << SCREEN_WIDTH << " " << SCREEN_HEIGHT << "\n255\n";
+    file.write(reinterpret_cast<const char*>(frameBuffer->data()), SCREEN_WIDTH * SCREEN_HEIGHT * 3);
+
+    return file.good();
+}
+
+// Execute the CPU instructions up to the next frame
+bool runFrameOrHalt(NesEmulator& emulator, size_t maxSteps) {
+    size_t steps = 0;
+    while (!emulator.frameReady()) {
+        emulator.step();
+
+        if (++steps > maxSteps)
+            return false;
+    }
+
+    return true;
+}
+
 }
 }
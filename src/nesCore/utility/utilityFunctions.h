@@ -3,12 +3,33 @@
 
 #include "nesPch.h"
 
+#include <vector>
+
+// Steps without a frame after which the CPU is considered halted
+#define MAX_FRAME_STEPS 200000
+
 namespace nesCore {
+class NesEmulator;
+class FrameBuffer;
+
 namespace utility {
 
 // Convert a number to a zero padded hex string
 std::string paddedHex(int data, int nPadding);
 
+// 64 bits FNV-1a hash of a block of bytes, the hash of
+// a previous block can be given to continue it
+uint64_t hashBytes(const uint8_t* data, size_t size, uint64_t hash = 0xCBF29CE484222325);
+
+// Read a whole file, return false if it can't be opened
+bool readFile(const std::string& filename, std::vector<uint8_t>& data);
+// Write the frame buffer as a binary PPM image, return false on failure
+bool writePpm(const std::string& filename, FrameBuffer* frameBuffer);
+
+// Execute the CPU instructions up to the next frame, return
+// false if the CPU halted before the frame was finished
+bool runFrameOrHalt(NesEmulator& emulator, size_t maxSteps = MAX_FRAME_STEPS);
+
 } // utility
 } // nesCore
 
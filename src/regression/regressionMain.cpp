@@ -0,0 +1,385 @@
+#include "nesPch.h"
+
+#include <argparse/argparse.hpp>
+
+#include <filesystem>
+#include <map>
+#include <thread>
+#include <vector>
+
+#include "nesCore/nesEmulator.h"
+#include "nesCore/movie.h"
+#include "nesCore/inputOutput/dummyIO.h"
+#include "nesCore/utility/utilityFunctions.h"
+
+#include "batch/workStealingPool.h"
+
+// Frame hash regression runner
+//
+// Run the ROM and input movie pairs of a manifest on a pool of threads and
+// compare the hash of the frame buffer at the chosen frames with a golden
+// file. An entry stops at its first mismatch and the differing frame is
+// written as a PPM image. Each line of the manifest hold the ROM path, the
+// movie path or '-' without inputs, and the comma separated frames to check,
+// lines starting with '#' are ignored. Each line of the golden file hold
+// the ROM, the movie, the frame and its hash
+
+struct Entry {
+    std::string romPath;
+    std::string moviePath;
+    // Frames to check in increasing order, the last one end the run
+    std::vector<uint64_t> frames;
+};
+
+enum EntryStatus {
+    ENTRY_PASSED = 0,
+    ENTRY_FAILED = 1,
+    // Checked frames without a golden hash
+    ENTRY_MISSING = 2,
+    ENTRY_ERROR = 3,
+};
+
+struct EntryResult {
+    EntryStatus status;
+    // Error message or first mismatch
+    std::string message;
+
+    // Hashes of the checked frames run before the end or the first mismatch
+    std::vector<std::pair<uint64_t, uint64_t>> hashes;
+
+    double seconds;
+};
+
+// Golden hashes by ROM, movie and frame
+typedef std::map<std::string, std::map<uint64_t, uint64_t>> GoldenHashes;
+
+// Key of an entry in the golden hashes
+static std::string entryKey(const std::string& romPath, const std::string& moviePath) {
+    return romPath + " " + moviePath;
+}
+
+// Read the manifest, return false on a malformed line
+static bool readManifest(const std::string& filename, std::vector<Entry>& entries) {
+    std::ifstream file(filename);
+    if (!file.good())
+        return false;
+
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#')
+            continue;
+
+        std::stringstream s(line);
+        std::string frames;
+        Entry entry;
+        if (!(s >> entry.romPath >> entry.moviePath >> frames))
+            return false;
+
+        std::stringstream f(frames);
+        std::string frame;
+        while (std::getline(f, frame, ',')) {
+            uint64_t value = std::strtoull(frame.c_str(), nullptr, 10);
+            if (value == 0)
+                return false;
+
+            entry.frames.push_back(value);
+        }
+
+        std::sort(entry.frames.begin(), entry.frames.end());
+        entries.push_back(entry);
+    }
+
+    return true;
+}
+
+// Read the golden hashes, a missing file is an empty golden file
+// Return false on a malformed line
+static bool readGolden(const std::string& filename, GoldenHashes& golden) {
+    std::ifstream file(filename);
+    if (!file.good())
+        return true;
+
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#')
+            continue;
+
+        std::stringstream s(line);
+        std::string romPath, moviePath;
+        uint64_t frame, hash;
+        if (!(s >> romPath >> moviePath >> frame >> std::hex >> hash))
+            return false;
+
+        golden[entryKey(romPath, moviePath)][frame] = hash;
+    }
+
+    return true;
+}
+
+// Run an entry on a new emulator instance, compare its frame
+// hashes with the golden ones unless they are updated
+static void runEntry(
+    const Entry& entry,
+    size_t index,
+    const std::vector<uint8_t>& rom,
+    const nesCore::Movie* p_movie,
+    const std::vector<uint8_t>& palette,
+    const std::map<uint64_t, uint64_t>* p_golden,
+    const std::string& diffDirectory,
+    EntryResult& result
+) {
+    auto startTime = std::chrono::steady_clock::now();
+
+    result.status = ENTRY_PASSED;
+
+    // The instance is created by the worker and never leaves it
+    nesCore::NesEmulator* p_emulator = new nesCore::NesEmulator();
+    nesCore::DummyIO dummyIO;
+    nesCore::Movie movie = p_movie != nullptr ? *p_movie : nesCore::Movie();
+
+    p_emulator->getFrameBuffer()->setPalette(palette.data(), palette.size());
+    p_emulator->attachIO(p_movie != nullptr ? static_cast<nesCore::IOInterface*>(&movie) : &dummyIO);
+
+    if (p_emulator->loadCartridgeFromMemory(rom.data(), rom.size()) != 0) {
+        result.status = ENTRY_ERROR;
+        result.message = "failed to load the cartridge";
+    }
+
+    uint64_t frame = 0;
+    size_t check = 0;
+
+    while (result.status != ENTRY_ERROR && check < entry.frames.size()) {
+        movie.beginFrame(*p_emulator, 0x00, 0x00);
+
+        if (!nesCore::utility::runFrameOrHalt(*p_emulator)) {
+            result.status = ENTRY_ERROR;
+            result.message = "the CPU halted at frame " + std::to_string(frame + 1);
+            break;
+        }
+
+        movie.endFrame(*p_emulator);
+        frame++;
+
+        if (frame != entry.frames[check])
+            continue;
+        check++;
+
+        uint64_t hash = nesCore::utility::hashBytes(
+            p_emulator->getFrameBuffer()->data(),
+            nesCore::SCREEN_WIDTH * nesCore::SCREEN_HEIGHT * 3
+        );
+        result.hashes.emplace_back(frame, hash);
+
+        // Golden hashes are being updated
+        if (p_golden == nullptr)
+            continue;
+
+        auto golden = p_golden->find(frame);
+        if (golden == p_golden->end()) {
+            result.status = ENTRY_MISSING;
+            continue;
+        }
+
+        if (golden->second == hash)
+            continue;
+
+        // Stop at the first mismatch and keep the frame for inspection
+        std::stringstream s;
+        s << "frame " << frame << " hash " << std::hex << std::setw(16) << std::setfill('0') << hash;
+        s << " expected " << std::setw(16) << golden->second;
+
+        std::string romName = entry.romPath.substr(entry.romPath.find_last_of("/\\") + 1);
+        std::stringstream filename;
+        filename << diffDirectory << "/" << index << "_" << romName << "_frame";
+        filename << std::setw(6) << std::setfill('0') << frame << ".ppm";
+
+        if (nesCore::utility::writePpm(filename.str(), p_emulator->getFrameBuffer()))
+            s << ", written to " << filename.str();
+
+        result.status = ENTRY_FAILED;
+        result.message = s.str();
+        break;
+    }
+
+    delete p_emulator;
+
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+// Write the hashes of the entries as the new golden file
+static bool writeGolden(const std::string& filename, const std::vector<Entry>& entries, const std::vector<EntryResult>& results) {
+    std::ofstream file(filename);
+    if (!file.good())
+        return false;
+
+    file << "# rom movie frame hash\n";
+    for (size_t i = 0; i < entries.size(); i++) {
+        for (const auto& hash : results[i].hashes) {
+            file << entries[i].romPath << " " << entries[i].moviePath << " " << hash.first << " ";
+            file << std::hex << std::setw(16) << std::setfill('0') << hash.second << std::dec << "\n";
+        }
+    }
+
+    return file.good();
+}
+
+int main(int argc, char *argv[]) {
+    // Parse commands line arguments
+    argparse::ArgumentParser argParser("nes_regression");
+
+    argParser.add_argument("manifest")
+        .help("manifest file, each line hold the ROM path, the movie path or '-' and the frames to check");
+
+    argParser.add_argument("-g", "--golden")
+        .default_value(std::string("regression_golden.txt"))
+        .help("golden frame hashes file");
+
+    argParser.add_argument("-u", "--update")
+        .implicit_value(true)
+        .default_value(false)
+        .help("write the frame hashes to the golden file instead of comparing them");
+
+    argParser.add_argument("-d", "--diff-dir")
+        .default_value(std::string("regression_diff"))
+        .help("directory of the PPM images of the mismatching frames");
+
+    argParser.add_argument("-p", "--palettes")
+        .default_value(std::string("resources/palettes/2C02G.pal"))
+        .help("specify the color palettes file");
+
+    argParser.add_argument("-t", "--threads")
+        .default_value(static_cast<int>(std::thread::hardware_concurrency()))
+        .action([](const std::string& value) { return std::stoi(value); })
+        .help("number of worker threads");
+
+    argParser.add_argument("-v", "--verbose")
+        .implicit_value(true)
+        .default_value(false)
+        .help("keep the emulator messages");
+
+    try {
+        argParser.parse_args(argc, argv);
+    }
+    catch (const std::runtime_error& err) {
+        std::cerr << err.what() << std::endl;
+        std::cerr << argParser;
+        return 1;
+    }
+
+    bool update = argParser.get<bool>("update");
+    std::string goldenPath = argParser.get("golden");
+    std::string diffDirectory = argParser.get("diff-dir");
+
+    std::vector<Entry> entries;
+    if (!readManifest(argParser.get("manifest"), entries)) {
+        std::cerr << "Failed to read the manifest" << std::endl;
+        return 2;
+    }
+
+    GoldenHashes golden;
+    if (!update && !readGolden(goldenPath, golden)) {
+        std::cerr << "Failed to read the golden file" << std::endl;
+        return 2;
+    }
+
+    std::vector<uint8_t> palette;
+    if (!nesCore::utility::readFile(argParser.get("palettes"), palette)) {
+        std::cerr << "Failed to load color palette" << std::endl;
+        return 2;
+    }
+
+    // The ROMs and the movies are loaded once and shared by the entries
+    std::map<std::string, std::vector<uint8_t>> roms;
+    std::map<std::string, nesCore::Movie> movies;
+
+    for (const Entry& entry : entries) {
+        if (roms.count(entry.romPath) == 0 && !nesCore::utility::readFile(entry.romPath, roms[entry.romPath])) {
+            std::cerr << "Failed to read the ROM " << entry.romPath << std::endl;
+            return 2;
+        }
+
+        if (entry.moviePath != "-" && movies.count(entry.moviePath) == 0) {
+            int movieError = movies[entry.moviePath].startPlayback(entry.moviePath);
+            if (movieError != 0) {
+                std::cerr << "Failed to load the movie " << entry.moviePath;
+                std::cerr << ", error code: " << movieError << std::endl;
+                return 2;
+            }
+        }
+    }
+
+    if (!update) {
+        std::error_code error;
+        std::filesystem::create_directories(diffDirectory, error);
+    }
+
+    // The emulator messages of many instances are only noise
+    std::streambuf* p_coutBuffer = std::cout.rdbuf();
+    if (!argParser.get<bool>("verbose"))
+        std::cout.rdbuf(nullptr);
+
+    std::vector<EntryResult> results(entries.size());
+    size_t threads = static_cast<size_t>(std::max(argParser.get<int>("threads"), 1));
+
+    // Without golden hashes every checked frame is missing
+    const std::map<uint64_t, uint64_t> noGolden;
+
+    auto startTime = std::chrono::steady_clock::now();
+    {
+        batch::WorkStealingPool pool(threads);
+
+        for (size_t i = 0; i < entries.size(); i++) {
+            const Entry& entry = entries[i];
+            const nesCore::Movie* p_movie = entry.moviePath == "-" ? nullptr : &movies[entry.moviePath];
+            const std::vector<uint8_t>* p_rom = &roms[entry.romPath];
+
+            const std::map<uint64_t, uint64_t>* p_golden = nullptr;
+            if (!update) {
+                auto entryGolden = golden.find(entryKey(entry.romPath, entry.moviePath));
+                p_golden = entryGolden != golden.end() ? &entryGolden->second : &noGolden;
+            }
+
+            pool.submit([&, i, p_movie, p_rom, p_golden](size_t) {
+                runEntry(entries[i], i, *p_rom, p_movie, palette, p_golden, diffDirectory, results[i]);
+            });
+        }
+
+        pool.wait();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+    std::cout.clear();
+    std::cout.rdbuf(p_coutBuffer);
+
+    // Report the entries
+    size_t counts[4] = {0, 0, 0, 0};
+    const char* statusNames[4] = {update ? "UPDATED" : "PASS", "FAIL", "MISSING", "ERROR"};
+
+    for (size_t i = 0; i < entries.size(); i++) {
+        const EntryResult& result = results[i];
+        counts[result.status]++;
+
+        std::cout << std::left << std::setw(8) << statusNames[result.status] << std::right;
+        std::cout << entries[i].romPath << " " << entries[i].moviePath;
+        if (!result.message.empty())
+            std::cout << ": " << result.message;
+        std::cout << std::endl;
+    }
+
+    std::cout << entries.size() << " entries, " << counts[ENTRY_PASSED] << " passed, ";
+    std::cout << counts[ENTRY_FAILED] << " failed, " << counts[ENTRY_MISSING] << " missing, ";
+    std::cout << counts[ENTRY_ERROR] << " errors on " << threads << " threads in ";
+    std::cout << std::fixed << std::setprecision(3) << seconds << " s" << std::endl;
+
+    if (update) {
+        if (!writeGolden(goldenPath, entries, results)) {
+            std::cerr << "Failed to write the golden file" << std::endl;
+            return 3;
+        }
+
+        std::cout << "Golden hashes written to " << goldenPath << std::endl;
+        return counts[ENTRY_ERROR] != 0 ? 4 : 0;
+    }
+
+    return counts[ENTRY_PASSED] == entries.size() ? 0 : 4;
+}
@@ -4,25 +4,133 @@
 
 namespace audio {
 
-Sdl2Audio::Sdl2Audio() {
-    int sample_nr = 0;
-
+Sdl2Audio::Sdl2Audio(uint32_t targetLatencyMs, uint16_t deviceSamples) :
+    m_sampleRate(0), mp_ringBuffer(nullptr), m_buffering(true), m_lastSample(0),
+    m_fillCount(0), m_fillMean(0.0), m_fillM2(0.0)
+{
     SDL_AudioSpec ds;
+    SDL_zero(ds);
     ds.freq = 44100;
     ds.format = AUDIO_S16SYS;
     ds.channels = 1;
-    ds.samples = 4096;
-    ds.callback = NULL;
-    ds.userdata = &sample_nr;
+    ds.samples = deviceSamples;
+    ds.callback = Sdl2Audio::audioCallback;
+    ds.userdata = this;
 
     SDL_AudioSpec os;
-    m_audioDevice = SDL_OpenAudioDevice(NULL, 0, &ds, &os, 0);
+    m_audioDevice = SDL_OpenAudioDevice(NULL, 0, &ds, &os, SDL_AUDIO_ALLOW_FREQUENCY_CHANGE);
+
+    if (m_audioDevice == 0) {
+        std::cerr << "Failed to open the audio device: " << SDL_GetError() << std::endl;
+        return;
+    }
+
+    m_sampleRate = os.freq;
 
+    // The ring buffer is allocated before the callback can run
+    m_targetSamples = static_cast<size_t>(m_sampleRate) * targetLatencyMs / 1000;
+    m_targetSamples = std::max<size_t>(m_targetSamples, os.samples);
+    mp_ringBuffer = new nesCore::utility::SpscRingBuffer<int16_t>(m_targetSamples * 2);
+
+    SDL_PauseAudioDevice(m_audioDevice, 0);
 }
 
 Sdl2Audio::~Sdl2Audio()
 {
-    SDL_CloseAudioDevice(m_audioDevice);
+    // Stop the callback before releasing the ring buffer
+    if (m_audioDevice != 0)
+        SDL_CloseAudioDevice(m_audioDevice);
+
+    delete mp_ringBuffer;
+}
+
+// Return the sample rate of the audio device
+uint32_t Sdl2Audio::sampleRate() {
+    return m_sampleRate;
+}
+
+// Write the samples to the ring buffer
+void Sdl2Audio::pushSamples(const int16_t* samples, size_t count) {
+    if (mp_ringBuffer == nullptr)
+        return;
+
+    // The samples that don't fit are dropped and counted as an overrun
+    mp_ringBuffer->write(samples, count);
+
+    // Update the fill level statistics
+    double fill = static_cast<double>(mp_ringBuffer->size());
+    m_fillCount++;
+    double delta = fill - m_fillMean;
+    m_fillMean += delta / m_fillCount;
+    m_fillM2 += delta * (fill - m_fillMean);
+}
+
+// Return the ratio to apply to the emulator sample rate
+double Sdl2Audio::rateRatio() {
+    if (mp_ringBuffer == nullptr)
+        return 1.0;
+
+    // Produce more samples when the buffer is under the target
+    // and less when it's over, the error is relative to the target
+    double fill = static_cast<double>(mp_ringBuffer->size());
+    double target = static_cast<double>(m_targetSamples);
+    double error = std::clamp((target - fill) / target, -1.0, 1.0);
+
+    return 1.0 + error * SDL2_AUDIO_MAX_RATE_DEVIATION;
+}
+
+// Wait for the audio device to consume the samples over the target
+void Sdl2Audio::waitForPlayback() {
+    if (mp_ringBuffer == nullptr)
+        return;
+
+    // The device consume a whole buffer at a time, so the wait
+    // is done with the SDL delay instead of spinning
+    while (mp_ringBuffer->size() > m_targetSamples)
+        SDL_Delay(1);
+}
+
+// SDL audio callback
+void Sdl2Audio::audioCallback(void* userdata, Uint8* stream, int len) {
+    Sdl2Audio* audio = static_cast<Sdl2Audio*>(userdata);
+    audio->fillDevice(reinterpret_cast<int16_t*>(stream), len / sizeof(int16_t));
+}
+
+// Fill the device buffer from the ring buffer
+void Sdl2Audio::fillDevice(int16_t* out, size_t count) {
+    // Wait for the target latency to be buffered
+    if (m_buffering && mp_ringBuffer->size() < m_targetSamples) {
+        std::fill(out, out + count, m_lastSample);
+        return;
+    }
+    m_buffering = false;
+
+    size_t read = mp_ringBuffer->read(out, count);
+    if (read != 0)
+        m_lastSample = out[read - 1];
+
+    // Hold the last sample to avoid a click and buffer again
+    if (read < count) {
+        std::fill(out + read, out + count, m_lastSample);
+        m_buffering = true;
+    }
+}
+
+// Statistics
+size_t Sdl2Audio::bufferedSamples() {
+    return mp_ringBuffer != nullptr ? mp_ringBuffer->size() : 0;
+}
+uint64_t Sdl2Audio::underruns() {
+    return mp_ringBuffer != nullptr ? mp_ringBuffer->underruns() : 0;
+}
+uint64_t Sdl2Audio::overruns() {
+    return mp_ringBuffer != nullptr ? mp_ringBuffer->overruns() : 0;
+}
+double Sdl2Audio::fillMean() {
+    return m_fillMean;
+}
+double Sdl2Audio::fillVariance() {
+    return m_fillCount > 1 ? m_fillM2 / (m_fillCount - 1) : 0.0;
 }
 
 }
@@ -5,17 +5,74 @@
 #include "SDL.h"
 #include <SDL_audio.h>
 
+#include "nesCore/apu/audioSink.h"
+#include "nesCore/utility/spscRingBuffer.h"
+
+// Maximum deviation of the sample rate used by the dynamic rate control,
+// small enough to not be heard as a pitch change
+#define SDL2_AUDIO_MAX_RATE_DEVIATION 0.005
+
 namespace audio {
 
-class Sdl2Audio {
+// Play the APU samples on the default audio device
+//
+// The emulation thread write the samples in a lock-free ring buffer
+// and the SDL audio callback drain it, so neither side ever block
+class Sdl2Audio : public nesCore::AudioSink {
 public:
-    Sdl2Audio();
+    // Take the latency targeted by the ring buffer in milliseconds
+    // and the size of the device buffer in samples
+    Sdl2Audio(uint32_t targetLatencyMs = 40, uint16_t deviceSamples = 512);
     ~Sdl2Audio();
 
+    // Return the sample rate of the audio device, 0 if it failed to open
+    uint32_t sampleRate();
+
+    // Write the samples to the ring buffer, called by the emulation thread
+    void pushSamples(const int16_t* samples, size_t count) override;
+
+    // Return the ratio to apply to the emulator sample rate so the ring
+    // buffer converge to the target latency, the ratio is proportional
+    // to the fill error and stay within the maximum rate deviation
+    double rateRatio();
+
+    // Wait for the audio device to consume the samples buffered
+    // over the target, used to pace the emulation with the audio clock
+    void waitForPlayback();
+
+    // Statistics
+    size_t bufferedSamples();
+    uint64_t underruns();
+    uint64_t overruns();
+
+    // Mean and variance of the ring buffer fill level in samples,
+    // measured by the emulation thread after each write
+    double fillMean();
+    double fillVariance();
+
+private:
+    // SDL audio callback, fill the device buffer from the ring buffer
+    static void audioCallback(void* userdata, Uint8* stream, int len);
+    void fillDevice(int16_t* out, size_t count);
+
 private:
     SDL_AudioDeviceID m_audioDevice;
+    uint32_t m_sampleRate;
+
+    // Samples buffered before the playback start or restart after
+    // an underrun, the ring buffer can hold twice as many
+    size_t m_targetSamples;
+    nesCore::utility::SpscRingBuffer<int16_t>* mp_ringBuffer;
+
+    // Audio thread state, the last sample is repeated during an underrun
+    bool m_buffering;
+    int16_t m_lastSample;
+
+    // Running fill level statistics, updated with Welford's algorithm
+    uint64_t m_fillCount;
+    double m_fillMean;
+    double m_fillM2;
 };
 }
 
 #endif
-
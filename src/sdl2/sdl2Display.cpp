@@ -13,7 +13,7 @@
 
 namespace display {
 Sdl2Display::Sdl2Display()
-    : mp_frameBuffer(nullptr), mp_window(nullptr) {}
+    : mp_frameBuffer(nullptr), m_indexed(false), mp_window(nullptr), m_paletteTexture(0) {}
 
 int Sdl2Display::init(
     bool hideDangerZone,
@@ -211,13 +211,6 @@ void Sdl2Display::updateQuad(
     glBufferData(GL_ARRAY_BUFFER, sizeof(m_quadVertices), m_quadVertices, GL_STATIC_DRAW);
 }
 
-void Sdl2Display::attachFrameBuffer(nesCore::FrameBuffer* buffer) {
-    if (m_hideDangerZone)
-        mp_frameBuffer = buffer->data() + (nesCore::SCREEN_WIDTH * 8*3);
-    else
-        mp_frameBuffer = buffer->data();
-}
-
 void Sdl2Display::resize() {
     // Get the window size and clear the screen
     int w, h;
@@ -271,17 +264,59 @@ void Sdl2Display::update() {
     glClearColor(0.0f, 0.0f, 0.0f, 1.0f );
     glClear(GL_COLOR_BUFFER_BIT); 
 
-    // Draw the NES display on the quad
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, mp_frameBuffer);
+    // Draw the NES display on the quad, the indices are a single channel texture
+    if (m_indexed)
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, width, height, 0, GL_RED, GL_UNSIGNED_BYTE, mp_frameBuffer);
+    else
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, mp_frameBuffer);
+
+    glUniform1i(glGetUniformLocation(m_shader, "indexed"), m_indexed);
     glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
 
     SDL_GL_SwapWindow(mp_window);
 }
+void Sdl2Display::update(const uint8_t* frame) {
+    if (m_hideDangerZone)
+        mp_frameBuffer = frame + (nesCore::SCREEN_WIDTH * 8*3);
+    else
+        mp_frameBuffer = frame;
+
+    m_indexed = false;
+    this->update();
+}
+void Sdl2Display::updateIndexed(const uint8_t* indices) {
+    if (m_hideDangerZone)
+        mp_frameBuffer = indices + (nesCore::SCREEN_WIDTH * 8);
+    else
+        mp_frameBuffer = indices;
+
+    m_indexed = true;
+    this->update();
+}
+
+// Upload the palette as a 64x1 texture on the second texture unit
+void Sdl2Display::setPalette(const uint8_t* colors) {
+    if (m_paletteTexture == 0)
+        glGenTextures(1, &m_paletteTexture);
+
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, m_paletteTexture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, 64, 1, 0, GL_RGB, GL_UNSIGNED_BYTE, colors);
+
+    // Go back to the frame texture
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, m_glTexture);
+
+    glUniform1i(glGetUniformLocation(m_shader, "palette"), 1);
+}
 
 void Sdl2Display::quit() {
     glDeleteVertexArrays(1, &m_VAO);
     glDeleteBuffers(1, &m_VBO);
     glDeleteBuffers(1, &m_EBO);
+    glDeleteTextures(1, &m_paletteTexture);
 
     SDL_GL_DeleteContext(m_glContext);
 	SDL_DestroyWindow(mp_window);
@@ -31,12 +31,17 @@ public:
 
     // Draw the frame buffer on the screen
     void update();
+    // Draw the given RGB frame on the screen, the frame
+    // is used by the next updates until another one is given
+    void update(const uint8_t* frame);
+    // Draw a frame of palette indices, the colors are
+    // looked up in the palette by the fragment shader
+    void updateIndexed(const uint8_t* indices);
+    // Set the 64 RGB colors used by the indexed frames
+    void setPalette(const uint8_t* colors);
     // Handle the window resize
     void resize();
 
-    // Attach the frame buffer to the display
-    void attachFrameBuffer(nesCore::FrameBuffer* buffer);
-
     // Toggle window full screen mode
     void toggleFullscreen();
     // Toggle vsync
@@ -59,8 +64,9 @@ private:
 private:
     bool m_hideDangerZone;
 
-    // Raw RGBA frame buffer
-    uint8_t* mp_frameBuffer;
+    // Raw RGB or indexed frame buffer
+    const uint8_t* mp_frameBuffer;
+    bool m_indexed;
 
     // SDL window pointer
     SDL_Window* mp_window;
@@ -69,6 +75,7 @@ private:
     SDL_GLContext m_glContext;
     GLuint m_VAO, m_VBO, m_EBO;
     GLuint m_glTexture;
+    GLuint m_paletteTexture;
     GLuint m_shader;
 
     // Display quad vertices and indices
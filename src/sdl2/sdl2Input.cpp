@@ -164,4 +164,9 @@ uint8_t Sdl2Input::readInputOne() {
 uint8_t Sdl2Input::readInputTwo() {
     return 0x00;
 }
+
+// Return the state of the buttons
+uint8_t Sdl2Input::buttons() {
+    return m_tmpInput;
+}
 }
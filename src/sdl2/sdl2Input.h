@@ -43,6 +43,9 @@ public:
     // Update the input status
     void updateInput(SDL_Event* event);
 
+    // Return the state of the buttons, in the order of the input register
+    uint8_t buttons();
+
 private:
     // IO registers
     uint8_t m_latch;